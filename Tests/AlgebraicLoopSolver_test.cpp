@@ -0,0 +1,38 @@
+// Tests/AlgebraicLoopSolver_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/AlgebraicLoopSolver.h>
+#include <PySysLinkBase/BlockEventsHandler.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SimulationTestBlocks.h"
+
+using namespace PySysLinkBase;
+
+// Test that a loop fed back through a gain is solved to the fixed point of its blocks, cut on a single signal.
+TEST(AlgebraicLoopSolverTest, SolvesLinearFeedbackLoop) {
+    auto handler = std::make_shared<BlockEventsHandler>();
+    auto source = std::make_shared<LinearTestBlock>("source", 1.0, std::vector<double>{}, handler);
+    auto sum = std::make_shared<LinearTestBlock>("sum", 0.0, std::vector<double>{1.0, 0.5}, handler);
+    auto gain = std::make_shared<LinearTestBlock>("gain", 0.0, std::vector<double>{3.0}, handler);
+    std::vector<std::shared_ptr<PortLink>> portLinks = {
+        std::make_shared<PortLink>(source, sum, 0, 0),
+        std::make_shared<PortLink>(sum, gain, 0, 0),
+        std::make_shared<PortLink>(gain, sum, 0, 1)};
+    auto simulationModel = std::make_shared<SimulationModel>(std::vector<std::shared_ptr<ISimulationBlock>>{source, sum, gain}, portLinks, handler);
+
+    auto sampleTime = std::make_shared<SampleTime>(SampleTimeType::discrete, 1.0);
+    source->ComputeOutputsOfBlock(sampleTime, 0.0);
+    source->GetOutputPorts()[0]->TryCopyValueToPort(*sum->GetInputPorts()[0]);
+
+    AlgebraicLoopSolver algebraicLoopSolver({sum, gain}, simulationModel, 1e-12, 10);
+    EXPECT_EQ(algebraicLoopSolver.GetCutSignalCount(), 1);
+    algebraicLoopSolver.Solve(sampleTime, 0.0);
+
+    // sum = 1 + 0.5 * 3 * sum
+    EXPECT_NEAR(sum->GetOutputPorts()[0]->GetValueReference().TryCastToTypedReference<double>().GetPayload(), -2.0, 1e-9);
+    EXPECT_NEAR(gain->GetOutputPorts()[0]->GetValueReference().TryCastToTypedReference<double>().GetPayload(), -6.0, 1e-9);
+}
@@ -0,0 +1,218 @@
+// Tests/BasicOdeSolver_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/ContinuousAndOde/BasicOdeSolver.h>
+#include <PySysLinkBase/ContinuousAndOde/EulerForwardStepSolver.h>
+#include <PySysLinkBase/ContinuousAndOde/EulerBackwardStepSolver.h>
+#include <PySysLinkBase/BlockEventsHandler.h>
+#include <Eigen/Dense>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "SimulationTestBlocks.h"
+
+using namespace PySysLinkBase;
+
+namespace
+{
+    std::shared_ptr<SimulationOptions> MakeOdeSolverOptions(double stopTime)
+    {
+        auto simulationOptions = std::make_shared<SimulationOptions>();
+        simulationOptions->startTime = 0.0;
+        simulationOptions->stopTime = stopTime;
+        return simulationOptions;
+    }
+
+    // x' = -x through the in-place state methods only, the vector ones throw
+    class InPlaceDecayTestBlock : public ISimulationBlockWithContinuousStates
+    {
+        public:
+        InPlaceDecayTestBlock(const std::string& id, double initialState, std::shared_ptr<IBlockEventsHandler> handler)
+            : ISimulationBlockWithContinuousStates(DummySimulationBlock::MakeConfiguration(id, 0, 1), handler), state(initialState),
+              sampleTime(std::make_shared<SampleTime>(SampleTimeType::continuous, 0))
+        {
+            this->outputPorts.push_back(std::make_shared<OutputPort>(std::make_shared<SignalValue<double>>(initialState)));
+        }
+
+        double state;
+
+        const std::shared_ptr<SampleTime> GetSampleTime() const override { return this->sampleTime; }
+        void SetSampleTime(std::shared_ptr<SampleTime> sampleTime) override { this->sampleTime = sampleTime; }
+        std::vector<std::shared_ptr<InputPort>> GetInputPorts() const override { return {}; }
+        const std::vector<std::shared_ptr<OutputPort>> GetOutputPorts() const override { return this->outputPorts; }
+        const std::vector<std::shared_ptr<OutputPort>> _ComputeOutputsOfBlock(std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep=false) override {
+            this->outputPorts[0]->SetValue(std::make_shared<SignalValue<double>>(this->state));
+            return this->outputPorts;
+        }
+        bool _TryUpdateConfigurationValue(std::string keyName, ConfigurationValue value) override { return false; }
+
+        const std::vector<double> GetContinuousStates() const override { throw std::logic_error("Vector state access used"); }
+        void SetContinuousStates(std::vector<double> newStates) override { throw std::logic_error("Vector state access used"); }
+        const std::vector<double> GetContinuousStateDerivatives(const std::shared_ptr<SampleTime> sampleTime, double currentTime) const override {
+            throw std::logic_error("Vector derivative access used");
+        }
+
+        int GetContinuousStateCount() const override { return 1; }
+        void CopyContinuousStatesTo(double* states, int stateCount) const override { states[0] = this->state; }
+        void SetContinuousStatesFrom(const double* newStates, int stateCount) override { this->state = newStates[0]; }
+        void CopyContinuousStateDerivativesTo(const std::shared_ptr<SampleTime> sampleTime, double currentTime, double* derivatives, int stateCount) const override {
+            derivatives[0] = -this->state;
+        }
+
+        private:
+        std::shared_ptr<SampleTime> sampleTime;
+        std::vector<std::shared_ptr<OutputPort>> outputPorts;
+    };
+}
+
+// Test that the Jacobian perturbing groups of columns with no common row equals the one perturbing every column on its own.
+TEST(BasicOdeSolverTest, GroupedJacobianMatchesDenseJacobian) {
+    // x1' = -x1, x2' = x1 - 2 x2, x3' = -3 x3: the columns of x1 and x3 share no row and are perturbed together
+    auto handler = std::make_shared<BlockEventsHandler>();
+    auto first = std::make_shared<ContinuousTestBlock>("first", 0, std::vector<double>{1.0},
+        [](const std::vector<double>& states, const std::vector<double>& inputs, double time) { return std::vector<double>{-states[0]}; }, handler);
+    auto second = std::make_shared<ContinuousTestBlock>("second", 0, std::vector<double>{2.0},
+        [](const std::vector<double>& states, const std::vector<double>& inputs, double time) { return std::vector<double>{inputs[0] - 2.0 * states[0]}; }, handler, 1);
+    auto third = std::make_shared<ContinuousTestBlock>("third", 0, std::vector<double>{3.0},
+        [](const std::vector<double>& states, const std::vector<double>& inputs, double time) { return std::vector<double>{-3.0 * states[0]}; }, handler);
+    std::vector<std::shared_ptr<ISimulationBlock>> blocks = {first, second, third};
+    auto simulationModel = std::make_shared<SimulationModel>(blocks, std::vector<std::shared_ptr<PortLink>>{std::make_shared<PortLink>(first, second, 0, 0)}, handler);
+
+    BasicOdeSolver odeSolver(std::make_shared<EulerForwardStepSolver>(), simulationModel, blocks, first->GetSampleTime(), MakeOdeSolverOptions(1.0));
+    std::vector<double> states = {1.0, 2.0, 3.0};
+    std::vector<double> derivatives = odeSolver.SystemModel(states, 0.0);
+
+    first->derivativeEvaluationCount = 0;
+    Eigen::MatrixXd groupedJacobian = Eigen::MatrixXd(odeSolver.SystemModelSparseJacobian(states, 0.0));
+    // One evaluation at the states and one per group of columns
+    EXPECT_EQ(first->derivativeEvaluationCount, 3);
+
+    Eigen::MatrixXd denseJacobian(3, 3);
+    for (int j = 0; j < 3; j++)
+    {
+        std::vector<double> perturbedStates = states;
+        double perturbation = states[j] * 0.01;
+        perturbedStates[j] += perturbation;
+        std::vector<double> perturbedDerivatives = odeSolver.SystemModel(perturbedStates, 0.0);
+        for (int i = 0; i < 3; i++)
+        {
+            denseJacobian(i, j) = (perturbedDerivatives[i] - derivatives[i]) / perturbation;
+        }
+    }
+
+    Eigen::MatrixXd expectedJacobian(3, 3);
+    expectedJacobian << -1.0, 0.0, 0.0,
+                        1.0, -2.0, 0.0,
+                        0.0, 0.0, -3.0;
+    EXPECT_LT((groupedJacobian - denseJacobian).cwiseAbs().maxCoeff(), 1e-9);
+    EXPECT_LT((groupedJacobian - expectedJacobian).cwiseAbs().maxCoeff(), 1e-9);
+}
+
+// Test that derivatives and Jacobians are written into the same solver-owned buffers on every evaluation.
+TEST(BasicOdeSolverTest, SystemModelReusesSolverBuffers) {
+    auto handler = std::make_shared<BlockEventsHandler>();
+    auto first = std::make_shared<ContinuousTestBlock>("first", 0, std::vector<double>{1.0},
+        [](const std::vector<double>& states, const std::vector<double>& inputs, double time) { return std::vector<double>{-states[0]}; }, handler);
+    auto second = std::make_shared<ContinuousTestBlock>("second", 0, std::vector<double>{2.0},
+        [](const std::vector<double>& states, const std::vector<double>& inputs, double time) { return std::vector<double>{inputs[0] - 2.0 * states[0]}; }, handler, 1);
+    std::vector<std::shared_ptr<ISimulationBlock>> blocks = {first, second};
+    auto simulationModel = std::make_shared<SimulationModel>(blocks, std::vector<std::shared_ptr<PortLink>>{std::make_shared<PortLink>(first, second, 0, 0)}, handler);
+
+    BasicOdeSolver odeSolver(std::make_shared<EulerForwardStepSolver>(), simulationModel, blocks, first->GetSampleTime(), MakeOdeSolverOptions(1.0));
+
+    const std::vector<double>& derivatives = odeSolver.SystemModel({1.0, 2.0}, 0.0);
+    const double* derivativesData = derivatives.data();
+    const std::vector<double>& derivativesAgain = odeSolver.SystemModel({3.0, 4.0}, 0.1);
+    EXPECT_EQ(&derivatives, &derivativesAgain);
+    EXPECT_EQ(derivativesAgain.data(), derivativesData);
+    EXPECT_DOUBLE_EQ(derivativesAgain[0], -3.0);
+    EXPECT_DOUBLE_EQ(derivativesAgain[1], 3.0 - 8.0);
+
+    const Eigen::SparseMatrix<double>& jacobian = odeSolver.SystemModelSparseJacobian({1.0, 2.0}, 0.0);
+    const Eigen::SparseMatrix<double>& jacobianAgain = odeSolver.SystemModelSparseJacobian({3.0, 4.0}, 0.1);
+    EXPECT_EQ(&jacobian, &jacobianAgain);
+    EXPECT_EQ(jacobianAgain.nonZeros(), 3);
+}
+
+// Test that output ports and the ports they feed are resolved at setup, not on every evaluation.
+TEST(BasicOdeSolverTest, OutputPortsResolvedOnceAtSetup) {
+    auto handler = std::make_shared<BlockEventsHandler>();
+    auto first = std::make_shared<ContinuousTestBlock>("first", 0, std::vector<double>{1.0},
+        [](const std::vector<double>& states, const std::vector<double>& inputs, double time) { return std::vector<double>{-states[0]}; }, handler);
+    auto second = std::make_shared<ContinuousTestBlock>("second", 0, std::vector<double>{2.0},
+        [](const std::vector<double>& states, const std::vector<double>& inputs, double time) { return std::vector<double>{inputs[0] - 2.0 * states[0]}; }, handler, 1);
+    std::vector<std::shared_ptr<ISimulationBlock>> blocks = {first, second};
+    auto simulationModel = std::make_shared<SimulationModel>(blocks, std::vector<std::shared_ptr<PortLink>>{std::make_shared<PortLink>(first, second, 0, 0)}, handler);
+
+    BasicOdeSolver odeSolver(std::make_shared<EulerForwardStepSolver>(), simulationModel, blocks, first->GetSampleTime(), MakeOdeSolverOptions(1.0));
+    first->outputPortsQueryCount = 0;
+    second->outputPortsQueryCount = 0;
+
+    std::vector<double> derivatives = odeSolver.SystemModel({1.0, 2.0}, 0.0);
+    EXPECT_DOUBLE_EQ(derivatives[1], 1.0 - 4.0);
+    odeSolver.DoStep(0.0, 0.1);
+    odeSolver.ComputeMajorOutputs(0.1);
+
+    EXPECT_EQ(first->outputPortsQueryCount, 0);
+    EXPECT_EQ(second->outputPortsQueryCount, 0);
+}
+
+// Test that a zero crossing at a known time, x(t) = t - 0.37, ends the step within the event tolerance after it.
+TEST(BasicOdeSolverTest, LocatesEventAtAnalyticTime) {
+    auto handler = std::make_shared<BlockEventsHandler>();
+    auto ramp = std::make_shared<ContinuousTestBlock>("ramp", 0, std::vector<double>{0.0},
+        [](const std::vector<double>& states, const std::vector<double>& inputs, double time) { return std::vector<double>{1.0}; }, handler);
+    ramp->SetEventFunction([](const std::vector<double>& states, double time) { return states[0] - 0.37; });
+    std::vector<std::shared_ptr<ISimulationBlock>> blocks = {ramp};
+    auto simulationModel = std::make_shared<SimulationModel>(blocks, std::vector<std::shared_ptr<PortLink>>{}, handler);
+
+    const double eventTolerance = 1e-6;
+    BasicOdeSolver odeSolver(std::make_shared<EulerForwardStepSolver>(), simulationModel, blocks, ramp->GetSampleTime(), MakeOdeSolverOptions(1.0),
+                             1e-6, true, eventTolerance);
+    odeSolver.DoStep(0.0, 1.0);
+
+    EXPECT_GE(odeSolver.GetNextTimeHit(), 0.37);
+    EXPECT_LE(odeSolver.GetNextTimeHit(), 0.37 + eventTolerance);
+}
+
+// Test that explicit and implicit steps only go through the in-place state methods of a block that provides them.
+TEST(BasicOdeSolverTest, StepsUseInPlaceStateMethods) {
+    auto runSteps = [](std::shared_ptr<IOdeStepSolver> odeStepSolver) {
+        auto handler = std::make_shared<BlockEventsHandler>();
+        auto decay = std::make_shared<InPlaceDecayTestBlock>("decay", 1.0, handler);
+        std::vector<std::shared_ptr<ISimulationBlock>> blocks = {decay};
+        auto simulationModel = std::make_shared<SimulationModel>(blocks, std::vector<std::shared_ptr<PortLink>>{}, handler);
+        BasicOdeSolver odeSolver(odeStepSolver, simulationModel, blocks, decay->GetSampleTime(), MakeOdeSolverOptions(1.0));
+
+        // The states of a step are applied when the next one starts
+        for (int i = 0; i < 5; i++)
+        {
+            odeSolver.DoStep(0.1 * i, 0.1);
+        }
+        return decay->state;
+    };
+
+    EXPECT_NEAR(runSteps(std::make_shared<EulerForwardStepSolver>()), std::pow(0.9, 4), 1e-12);
+    EXPECT_NEAR(runSteps(std::make_shared<EulerBackwardStepSolver>(50, 1e-12)), std::pow(1.0 / 1.1, 4), 1e-9);
+}
+
+// Test that an implicit step leaves the block states as they were, without evaluating the model again at the start of the step.
+TEST(BasicOdeSolverTest, StepRestoresStatesWithoutEvaluatingModel) {
+    auto handler = std::make_shared<BlockEventsHandler>();
+    auto decay = std::make_shared<ContinuousTestBlock>("decay", 0, std::vector<double>{1.0, 2.0},
+        [](const std::vector<double>& states, const std::vector<double>& inputs, double time) { return std::vector<double>{-states[0], -2.0 * states[1]}; }, handler);
+    std::vector<std::shared_ptr<ISimulationBlock>> blocks = {decay};
+    auto simulationModel = std::make_shared<SimulationModel>(blocks, std::vector<std::shared_ptr<PortLink>>{}, handler);
+    BasicOdeSolver odeSolver(std::make_shared<EulerBackwardStepSolver>(50, 1e-12), simulationModel, blocks, decay->GetSampleTime(), MakeOdeSolverOptions(1.0));
+
+    odeSolver.DoStep(0.0, 0.1);
+
+    EXPECT_EQ(decay->GetContinuousStates(), std::vector<double>({1.0, 2.0}));
+    EXPECT_GT(decay->derivativeEvaluationCount, 0);
+    // Every evaluation of the implicit step is at its end
+    EXPECT_EQ(decay->lastDerivativeTime, 0.1);
+    EXPECT_EQ(odeSolver.GetNextTimeHit(), 0.1);
+}
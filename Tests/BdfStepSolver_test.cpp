@@ -0,0 +1,47 @@
+// Tests/BdfStepSolver_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/ContinuousAndOde/BdfStepSolver.h>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace PySysLinkBase;
+
+// Test that a stiff linear system, y' = -lambda (y - cos(t)), is followed with large steps and a raised order.
+TEST(BdfStepSolverTest, IntegratesStiffSystem) {
+    const double lambda = 1000.0;
+    auto systemDerivatives = [&](std::vector<double> states, double time) {
+        return std::vector<double>{-lambda * (states[0] - std::cos(time))};
+    };
+    auto systemSparseJacobian = [&](std::vector<double> states, double time) {
+        Eigen::SparseMatrix<double> jacobian(1, 1);
+        jacobian.insert(0, 0) = -lambda;
+        return jacobian;
+    };
+
+    BdfStepSolver solver(1e-8, 1e-8);
+    std::vector<double> states = {0.0};
+    double time = 0.0;
+    double timeStep = 1e-5;
+    int acceptedSteps = 0;
+    while (time < 2.0)
+    {
+        timeStep = std::min(timeStep, 2.0 - time);
+        auto [isAccepted, newStates, suggestedTimeStep] = solver.SolveStepWithSparseJacobian(systemDerivatives, systemSparseJacobian, states, time, timeStep);
+        if (isAccepted)
+        {
+            time += timeStep;
+            states = newStates;
+            acceptedSteps++;
+        }
+        timeStep = suggestedTimeStep;
+    }
+
+    double c = lambda * lambda / (lambda * lambda + 1.0);
+    double expected = c * std::cos(2.0) + c / lambda * std::sin(2.0) - c * std::exp(-lambda * 2.0);
+    EXPECT_NEAR(states[0], expected, 1e-5);
+    // Explicit methods are bound to steps below 2 / lambda, 1000 steps over this interval
+    EXPECT_LT(acceptedSteps, 400);
+    EXPECT_GT(solver.GetCurrentOrder(), 1);
+}
@@ -0,0 +1,52 @@
+// Tests/DiscreteTimeHitScheduler_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/DiscreteTimeHitScheduler.h>
+#include <memory>
+#include <vector>
+
+using namespace PySysLinkBase;
+
+// Test that hits of different sample times are yielded in order, merged when they coincide and closed on the stop time.
+TEST(DiscreteTimeHitSchedulerTest, YieldsMergedTimeHitsInOrder) {
+    auto slowSampleTime = std::make_shared<SampleTime>(SampleTimeType::discrete, 0.5);
+    auto fastSampleTime = std::make_shared<SampleTime>(SampleTimeType::discrete, 0.25);
+    DiscreteTimeHitScheduler scheduler({slowSampleTime, fastSampleTime}, 0.0, 1.0);
+
+    std::vector<double> times;
+    std::vector<std::size_t> sampleTimeCounts;
+    while (scheduler.HasNextTimeHit())
+    {
+        times.push_back(scheduler.GetNextTimeHit());
+        std::vector<std::shared_ptr<SampleTime>> sampleTimes = scheduler.PopNextTimeHit();
+        sampleTimeCounts.push_back(sampleTimes.size());
+        if (times.back() == 0.5)
+        {
+            EXPECT_EQ(sampleTimes, std::vector<std::shared_ptr<SampleTime>>({slowSampleTime, fastSampleTime}));
+        }
+    }
+
+    EXPECT_EQ(times, std::vector<double>({0.0, 0.25, 0.5, 0.75, 1.0}));
+    EXPECT_EQ(sampleTimeCounts, std::vector<std::size_t>({2, 1, 2, 1, 2}));
+
+    scheduler.SkipTimeHitsUpTo(0.5);
+    EXPECT_EQ(scheduler.GetNextTimeHit(), 0.75);
+}
+
+// Test that periods which are not exact in binary still hit together, the third hit of 0.1 is the first of 0.3.
+TEST(DiscreteTimeHitSchedulerTest, MergesCoincidentHitsOfInexactPeriods) {
+    auto fastSampleTime = std::make_shared<SampleTime>(SampleTimeType::discrete, 0.1);
+    auto slowSampleTime = std::make_shared<SampleTime>(SampleTimeType::discrete, 0.3);
+    DiscreteTimeHitScheduler scheduler({fastSampleTime, slowSampleTime}, 0.0, 0.6);
+
+    std::vector<std::size_t> sampleTimeCounts;
+    while (scheduler.HasNextTimeHit())
+    {
+        sampleTimeCounts.push_back(scheduler.PopNextTimeHit().size());
+    }
+    EXPECT_EQ(sampleTimeCounts, std::vector<std::size_t>({2, 1, 1, 2, 1, 1, 2}));
+
+    auto [nextTimeHit, nextSampleTimes] = scheduler.GetFirstTimeHitAfter(0.25);
+    EXPECT_EQ(nextSampleTimes, std::vector<std::shared_ptr<SampleTime>>({fastSampleTime, slowSampleTime}));
+    EXPECT_DOUBLE_EQ(nextTimeHit, 0.3);
+}
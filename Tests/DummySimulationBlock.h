@@ -37,6 +37,15 @@ public:
         }
     }
 
+    // Same block built from an id, with the configuration keys every block expects
+    DummySimulationBlock(const std::string& id, std::shared_ptr<PySysLinkBase::IBlockEventsHandler> handler, int inputPortAmount = 1, int outputPortAmount = 1)
+        : DummySimulationBlock(MakeConfiguration(id, inputPortAmount, outputPortAmount), handler, inputPortAmount, outputPortAmount) {}
+
+    static std::map<std::string, PySysLinkBase::ConfigurationValue> MakeConfiguration(const std::string& id, int inputPortAmount, int outputPortAmount) {
+        return {{"Name", id}, {"Id", id}, {"InputPortNumber", inputPortAmount}, {"OutputPortNumber", outputPortAmount},
+                {"InputPortTypes", std::vector<std::string>{}}, {"OutputPortTypes", std::vector<std::string>{}}};
+    }
+
     // Provide dummy implementations for the pure virtual functions.
     const std::shared_ptr<PySysLinkBase::SampleTime> GetSampleTime() const override {
         // Return a valid (even if dummy) sample time pointer
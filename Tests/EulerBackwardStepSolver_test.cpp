@@ -0,0 +1,78 @@
+// Tests/EulerBackwardStepSolver_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/ContinuousAndOde/EulerBackwardStepSolver.h>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace PySysLinkBase;
+
+// Test that modified Newton, reusing the Jacobian across steps, converges to the same states as full Newton on a nonlinear system.
+TEST(EulerBackwardStepSolverTest, ModifiedNewtonMatchesFullNewton) {
+    // y1' = -y1^2 + y2, y2' = -10 y2 + sin(t)
+    auto systemDerivatives = [](std::vector<double> states, double time) {
+        return std::vector<double>{-states[0] * states[0] + states[1], -10.0 * states[1] + std::sin(time)};
+    };
+    auto systemSparseJacobian = [](std::vector<double> states, double time) {
+        Eigen::SparseMatrix<double> jacobian(2, 2);
+        jacobian.insert(0, 0) = -2.0 * states[0];
+        jacobian.insert(0, 1) = 1.0;
+        jacobian.insert(1, 1) = -10.0;
+        return jacobian;
+    };
+
+    EulerBackwardStepSolver fullNewtonSolver(50, 1e-12, false);
+    EulerBackwardStepSolver modifiedNewtonSolver(50, 1e-12, true);
+    std::vector<double> fullNewtonStates = {2.0, 1.0};
+    std::vector<double> modifiedNewtonStates = {2.0, 1.0};
+    const double timeStep = 0.05;
+    for (int i = 0; i < 40; i++)
+    {
+        double time = i * timeStep;
+        auto [isFullNewtonAccepted, fullNewtonNewStates, fullNewtonTimeStep] = fullNewtonSolver.SolveStepWithSparseJacobian(systemDerivatives, systemSparseJacobian, fullNewtonStates, time, timeStep);
+        auto [isModifiedNewtonAccepted, modifiedNewtonNewStates, modifiedNewtonTimeStep] = modifiedNewtonSolver.SolveStepWithSparseJacobian(systemDerivatives, systemSparseJacobian, modifiedNewtonStates, time, timeStep);
+        ASSERT_TRUE(isFullNewtonAccepted);
+        ASSERT_TRUE(isModifiedNewtonAccepted);
+        fullNewtonStates = fullNewtonNewStates;
+        modifiedNewtonStates = modifiedNewtonNewStates;
+
+        EXPECT_NEAR(modifiedNewtonStates[0], fullNewtonStates[0], 1e-9);
+        EXPECT_NEAR(modifiedNewtonStates[1], fullNewtonStates[1], 1e-9);
+    }
+}
+
+// Test that modified Newton refreshes its Jacobian when the cached one stops the iterations from converging.
+TEST(EulerBackwardStepSolverTest, ModifiedNewtonRefreshesJacobianOnSlowConvergence) {
+    // y' = lambda(t) y, lambda jumps from -1 to -50 at t = 1
+    auto lambda = [](double time) { return time < 1.0 ? -1.0 : -50.0; };
+    int jacobianEvaluationCount = 0;
+    auto systemDerivatives = [&](std::vector<double> states, double time) {
+        return std::vector<double>{lambda(time) * states[0]};
+    };
+    auto systemSparseJacobian = [&](std::vector<double> states, double time) {
+        jacobianEvaluationCount++;
+        Eigen::SparseMatrix<double> jacobian(1, 1);
+        jacobian.insert(0, 0) = lambda(time);
+        return jacobian;
+    };
+
+    EulerBackwardStepSolver solver(50, 1e-12, true);
+    const double timeStep = 0.1;
+
+    auto [isFirstStepAccepted, firstStepStates, firstStepTimeStep] = solver.SolveStepWithSparseJacobian(systemDerivatives, systemSparseJacobian, {1.0}, 0.0, timeStep);
+    ASSERT_TRUE(isFirstStepAccepted);
+    EXPECT_NEAR(firstStepStates[0], 1.0 / (1.0 + timeStep), 1e-10);
+    EXPECT_EQ(jacobianEvaluationCount, 1);
+
+    // A second step with the same stiffness keeps the cached Jacobian
+    auto [isSecondStepAccepted, secondStepStates, secondStepTimeStep] = solver.SolveStepWithSparseJacobian(systemDerivatives, systemSparseJacobian, {1.0}, 0.5, timeStep);
+    ASSERT_TRUE(isSecondStepAccepted);
+    EXPECT_EQ(jacobianEvaluationCount, 1);
+
+    // With the Jacobian of lambda = -1 the iteration diverges for lambda = -50
+    auto [isStiffStepAccepted, stiffStepStates, stiffStepTimeStep] = solver.SolveStepWithSparseJacobian(systemDerivatives, systemSparseJacobian, {1.0}, 1.0, timeStep);
+    ASSERT_TRUE(isStiffStepAccepted);
+    EXPECT_EQ(jacobianEvaluationCount, 2);
+    EXPECT_NEAR(stiffStepStates[0], 1.0 / (1.0 + 50.0 * timeStep), 1e-10);
+}
@@ -26,19 +26,6 @@ protected:
 
     // This function is called before each test case.
     void SetUp() override {
-        // Configure logging
-        try
-        {
-            PySysLinkBase::SpdlogManager::ConfigureDefaultLogger();
-            PySysLinkBase::SpdlogManager::SetLogLevel(PySysLinkBase::LogLevel::off);
-        }
-        catch(const std::exception& e)
-        {
-            ;
-        }
-        
-        
-
         // Create a block events handler
         blockEventsHandler = std::make_shared<PySysLinkBase::BlockEventsHandler>();
 
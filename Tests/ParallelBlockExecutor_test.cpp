@@ -0,0 +1,42 @@
+// Tests/ParallelBlockExecutor_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/ParallelBlockExecutor.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace PySysLinkBase;
+
+// Test that every task of consecutive batches runs exactly once, whatever the number of tasks per thread.
+TEST(ParallelBlockExecutorTest, RunsEveryTaskOnce) {
+    ParallelBlockExecutor executor(4);
+
+    for (int taskCount : {1, 3, 4, 257})
+    {
+        std::vector<std::atomic<int>> timesRun(taskCount);
+        executor.Run(taskCount, [&](int i) { timesRun[i].fetch_add(1); });
+
+        for (int i = 0; i < taskCount; i++)
+        {
+            EXPECT_EQ(timesRun[i].load(), 1) << "task " << i << " of " << taskCount;
+        }
+    }
+}
+
+// Test that an exception thrown by a task reaches the caller once the batch is done.
+TEST(ParallelBlockExecutorTest, RethrowsTaskException) {
+    ParallelBlockExecutor executor(3);
+    std::atomic<int> tasksRun{0};
+
+    EXPECT_THROW(executor.Run(64, [&](int i) {
+        tasksRun.fetch_add(1);
+        if (i == 10) throw std::runtime_error("task failed");
+    }), std::runtime_error);
+    EXPECT_EQ(tasksRun.load(), 64);
+
+    // The executor stays usable after a failed batch
+    tasksRun = 0;
+    executor.Run(8, [&](int) { tasksRun.fetch_add(1); });
+    EXPECT_EQ(tasksRun.load(), 8);
+}
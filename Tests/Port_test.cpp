@@ -0,0 +1,48 @@
+// Tests/Port_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/PortsAndSignalValues/InputPort.h>
+#include <PySysLinkBase/PortsAndSignalValues/OutputPort.h>
+#include <PySysLinkBase/PortsAndSignalValues/SignalValue.h>
+#include <memory>
+#include <string>
+#include <typeinfo>
+
+using namespace PySysLinkBase;
+
+// Test that signal type ids are computed per type and match between values of the same type.
+TEST(PortTest, SignalTypeIdsDependOnPayloadType) {
+    SignalValue<double> doubleValue(1.0);
+    SignalValue<double> otherDoubleValue(2.0);
+    SignalValue<int> intValue(1);
+
+    EXPECT_EQ(doubleValue.GetSignalTypeId(), otherDoubleValue.GetSignalTypeId());
+    EXPECT_NE(doubleValue.GetSignalTypeId(), intValue.GetSignalTypeId());
+    EXPECT_EQ(doubleValue.GetSignalTypeId(), GetSignalTypeId<double>());
+}
+
+// Test that repeated copies reuse the value owned by the destination port and do not touch the value given to it.
+TEST(PortTest, TryCopyValueToPortWritesIntoOwnedValue) {
+    auto sharedInitialValue = std::make_shared<SignalValue<double>>(0.0);
+    OutputPort outputPort(std::make_shared<SignalValue<double>>(1.0));
+    InputPort inputPort(true, sharedInitialValue);
+
+    outputPort.TryCopyValueToPort(inputPort);
+    const UnknownTypeSignalValue* ownedValue = &inputPort.GetValueReference();
+    EXPECT_NE(ownedValue, sharedInitialValue.get());
+    EXPECT_EQ(inputPort.GetValueReference().TryCastToTypedReference<double>().GetPayload(), 1.0);
+
+    outputPort.SetValue(std::make_shared<SignalValue<double>>(3.0));
+    outputPort.TryCopyValueToPort(inputPort);
+    EXPECT_EQ(&inputPort.GetValueReference(), ownedValue);
+    EXPECT_EQ(inputPort.GetValueReference().TryCastToTypedReference<double>().GetPayload(), 3.0);
+    EXPECT_EQ(sharedInitialValue->GetPayload(), 0.0);
+}
+
+// Test that copying between ports of different types throws.
+TEST(PortTest, TryCopyValueToPortThrowsOnTypeMismatch) {
+    OutputPort outputPort(std::make_shared<SignalValue<int>>(1));
+    InputPort inputPort(true, std::make_shared<SignalValue<double>>(0.0));
+
+    EXPECT_THROW(outputPort.TryCopyValueToPort(inputPort), std::bad_cast);
+}
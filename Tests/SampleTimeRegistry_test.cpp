@@ -0,0 +1,27 @@
+// Tests/SampleTimeRegistry_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/SampleTimeRegistry.h>
+#include <memory>
+
+using namespace PySysLinkBase;
+
+// Test that equal sample times share the id and canonical instance of the first one interned, in first seen order.
+TEST(SampleTimeRegistryTest, InternsEqualSampleTimesOnce) {
+    auto firstDiscrete = std::make_shared<SampleTime>(SampleTimeType::discrete, 0.1);
+    auto continuous = std::make_shared<SampleTime>(SampleTimeType::continuous, 0);
+    auto secondDiscrete = std::make_shared<SampleTime>(SampleTimeType::discrete, 0.1);
+    SampleTimeRegistry registry;
+
+    EXPECT_EQ(registry.Intern(firstDiscrete), 0);
+    EXPECT_EQ(registry.Intern(continuous), 1);
+    EXPECT_EQ(registry.Intern(secondDiscrete), 0);
+    EXPECT_EQ(registry.GetCount(), 2);
+    EXPECT_EQ(registry.GetSampleTime(0), firstDiscrete);
+
+    EXPECT_EQ(registry.FindId(std::make_shared<SampleTime>(SampleTimeType::continuous, 0)), 1);
+    EXPECT_EQ(registry.FindDiscreteId(0.1), 0);
+    EXPECT_EQ(registry.FindDiscreteId(0.2), -1);
+    EXPECT_EQ(registry.FindContinuousId(1), -1);
+    EXPECT_THROW(registry.Intern(std::make_shared<SampleTime>(SampleTimeType::constant)), std::invalid_argument);
+}
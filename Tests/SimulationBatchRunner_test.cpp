@@ -0,0 +1,127 @@
+// Tests/SimulationBatchRunner_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/SimulationBatchRunner.h>
+#include <PySysLinkBase/IBlockFactory.h>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "SimulationTestBlocks.h"
+
+using namespace PySysLinkBase;
+
+namespace
+{
+    // Accumulating linear blocks with their bias, their gain on every input and their sample time taken from the configuration
+    class LinearTestBlockFactory : public IBlockFactory
+    {
+        public:
+        std::shared_ptr<ISimulationBlock> CreateBlock(std::map<std::string, ConfigurationValue> blockConfiguration, std::shared_ptr<IBlockEventsHandler> blockEventsHandler) override
+        {
+            int inputPortNumber = ConfigurationValueManager::TryGetConfigurationValue<int>("InputPortNumber", blockConfiguration);
+            return std::make_shared<LinearTestBlock>(ConfigurationValueManager::TryGetConfigurationValue<std::string>("Id", blockConfiguration),
+                ConfigurationValueManager::TryGetConfigurationValue<double>("Bias", blockConfiguration),
+                std::vector<double>(inputPortNumber, ConfigurationValueManager::TryGetConfigurationValue<double>("Gain", blockConfiguration)), blockEventsHandler,
+                std::make_shared<SampleTime>(SampleTimeType::discrete, ConfigurationValueManager::TryGetConfigurationValue<double>("SampleTime", blockConfiguration)),
+                ConfigurationValueManager::TryGetConfigurationValue<bool>("IsAccumulating", blockConfiguration));
+        }
+    };
+
+    std::map<std::string, ConfigurationValue> MakeLinearBlockConfiguration(const std::string& id, int inputPortNumber, double bias, double gain, bool isAccumulating)
+    {
+        std::map<std::string, ConfigurationValue> configuration = DummySimulationBlock::MakeConfiguration(id, inputPortNumber, 1);
+        configuration.insert({{"BlockType", std::string("linear")}, {"Bias", bias}, {"Gain", gain}, {"SampleTime", 0.1}, {"IsAccumulating", isAccumulating}});
+        return configuration;
+    }
+}
+
+// Test that each run of a batch sees only its own overrides, the same with runs simulated at the same time as one after the other.
+TEST(SimulationBatchRunnerTest, RunsAreIndependent) {
+    ModelConfiguration modelConfiguration;
+    modelConfiguration.blocksConfigurations = {
+        MakeLinearBlockConfiguration("source", 0, 1.0, 0.0, true),
+        MakeLinearBlockConfiguration("gain", 1, 0.0, 2.0, false)};
+    modelConfiguration.linksConfigurations = {
+        {{"SourceBlockId", std::string("source")}, {"SourcePortIdx", 0}, {"DestinationBlockId", std::string("gain")}, {"DestinationPortIdx", 0}}};
+    std::map<std::string, std::shared_ptr<IBlockFactory>> blockFactories = {{"linear", std::make_shared<LinearTestBlockFactory>()}};
+
+    auto simulationOptions = std::make_shared<SimulationOptions>();
+    simulationOptions->startTime = 0.0;
+    simulationOptions->stopTime = 1.0;
+    simulationOptions->blockIdsInputOrOutputAndIndexesToLog = {{"gain", "output", 0}};
+    simulationOptions->numberOfThreads = 4;
+
+    SimulationBatchRun nominalRun = {"nominal", {}};
+    SimulationBatchRun gainRun = {"gain_3", {{"gain", {{"Gain", 3.0}}}}};
+    SimulationBatchRun biasRun = {"bias_0.5", {{"source", {{"Bias", 0.5}}}}};
+    std::vector<SimulationBatchRun> runs = {gainRun, nominalRun, biasRun, gainRun};
+    std::vector<double> expectedSlopes = {3.0, 2.0, 1.0, 3.0};
+
+    for (int numberOfThreads : {1, 3})
+    {
+        SimulationBatchRunner batchRunner(modelConfiguration, blockFactories, simulationOptions, numberOfThreads);
+        std::vector<std::shared_ptr<SimulationOutput>> outputs = batchRunner.RunBatch(runs);
+        ASSERT_EQ(outputs.size(), runs.size());
+        for (int i = 0; i < runs.size(); i++)
+        {
+            // The source adds its bias on every hit, the gain scales it
+            auto signal = outputs[i]->signals["LoggedSignals"]["gain/output/0"]->TryCastToTyped<double>();
+            ASSERT_EQ(signal->values.size(), 11) << runs[i].runName;
+            for (int k = 0; k < signal->values.size(); k++)
+            {
+                EXPECT_NEAR(signal->values[k], expectedSlopes[i] * (k + 1), 1e-12) << runs[i].runName << " with " << numberOfThreads << " threads";
+            }
+        }
+    }
+    EXPECT_EQ(simulationOptions->numberOfThreads, 4);
+}
+
+// Test that runs streamed to a JSON file as they end give the same objects as the outputs kept in memory.
+TEST(SimulationBatchRunnerTest, RunBatchToJsonWritesEveryRun) {
+    ModelConfiguration modelConfiguration;
+    modelConfiguration.blocksConfigurations = {
+        MakeLinearBlockConfiguration("source", 0, 1.0, 0.0, true),
+        MakeLinearBlockConfiguration("gain", 1, 0.0, 2.0, false)};
+    modelConfiguration.linksConfigurations = {
+        {{"SourceBlockId", std::string("source")}, {"SourcePortIdx", 0}, {"DestinationBlockId", std::string("gain")}, {"DestinationPortIdx", 0}}};
+    std::map<std::string, std::shared_ptr<IBlockFactory>> blockFactories = {{"linear", std::make_shared<LinearTestBlockFactory>()}};
+
+    auto simulationOptions = std::make_shared<SimulationOptions>();
+    simulationOptions->startTime = 0.0;
+    simulationOptions->stopTime = 1.0;
+    simulationOptions->blockIdsInputOrOutputAndIndexesToLog = {{"gain", "output", 0}};
+    simulationOptions->activateProfiling = true;
+
+    std::vector<SimulationBatchRun> runs = {
+        {"nominal", {}},
+        {"gain_3", {{"gain", {{"Gain", 3.0}}}}},
+        {"bias_0.5", {{"source", {{"Bias", 0.5}}}}}};
+
+    SimulationBatchRunner batchRunner(modelConfiguration, blockFactories, simulationOptions, 3);
+    const std::string fileName = "SimulationBatchRunner_test_batch.json";
+    batchRunner.RunBatchToJson(fileName, runs);
+    std::vector<std::shared_ptr<SimulationOutput>> outputs = batchRunner.RunBatch(runs);
+
+    std::ifstream in(fileName);
+    std::stringstream written;
+    written << in.rdbuf();
+    in.close();
+    std::remove(fileName.c_str());
+
+    std::string json = written.str();
+    ASSERT_GE(json.size(), 4);
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.substr(json.size() - 3), "\n}\n");
+    for (int i = 0; i < runs.size(); i++)
+    {
+        std::ostringstream expectedRun;
+        expectedRun << "\n  \"" << runs[i].runName << "\": ";
+        outputs[i]->WriteJson(expectedRun, "  ");
+        EXPECT_NE(json.find(expectedRun.str()), std::string::npos) << runs[i].runName;
+    }
+}
@@ -0,0 +1,118 @@
+// Tests/SimulationCheckpoint_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/SimulationCheckpoint.h>
+#include <PySysLinkBase/FullySupportedSignalValue.h>
+#include <PySysLinkBase/PortsAndSignalValues/SignalValue.h>
+#include <PySysLinkBase/SimulationManager.h>
+#include <PySysLinkBase/BlockEventsHandler.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "SimulationTestBlocks.h"
+
+using namespace PySysLinkBase;
+
+// Test that numbers, strings and fully supported signal values, written or not, are read back as they were written.
+TEST(SimulationCheckpointTest, ValuesRoundTrip) {
+    DoubleMatrix matrix(2, 3);
+    matrix << 1.0, 2.0, 3.0, 4.0, 5.0, 6.0;
+
+    CheckpointWriter writer;
+    writer.Write(1.5);
+    writer.WriteString("block");
+    writer.WriteDoubles({0.25, -3.0});
+    EXPECT_TRUE(writer.WriteSignalValue(std::make_shared<SignalValue<DoubleMatrix>>(matrix)));
+    EXPECT_TRUE(writer.WriteSignalValue(std::make_shared<SignalValue<std::string>>("on")));
+    EXPECT_TRUE(writer.WriteSignalValue(std::make_shared<SignalValue<double>>()));
+    EXPECT_FALSE(writer.WriteSignalValue(std::make_shared<SignalValue<float>>(1.0f)));
+
+    std::vector<unsigned char> blob = writer.GetBlob();
+    CheckpointReader reader(blob);
+    EXPECT_EQ(reader.Read<double>(), 1.5);
+    EXPECT_EQ(reader.ReadString(), "block");
+    EXPECT_EQ(reader.ReadDoubles(), std::vector<double>({0.25, -3.0}));
+    EXPECT_EQ(reader.ReadSignalValue()->TryCastToTyped<DoubleMatrix>()->GetPayload(), matrix);
+    EXPECT_EQ(reader.ReadSignalValue()->TryCastToTyped<std::string>()->GetPayload(), "on");
+    std::shared_ptr<UnknownTypeSignalValue> neverWrittenValue = reader.ReadSignalValue();
+    ASSERT_NE(neverWrittenValue, nullptr);
+    EXPECT_FALSE(neverWrittenValue->TryCastToTyped<double>()->IsInitialized());
+    EXPECT_EQ(reader.ReadSignalValue(), nullptr);
+    EXPECT_TRUE(reader.IsAtEnd());
+
+    EXPECT_THROW(reader.Read<double>(), std::runtime_error);
+}
+
+namespace
+{
+    // Accumulating discrete source driving a continuous group, sampled by an accumulating block whose second output is never written
+    std::shared_ptr<SimulationModel> MakeResumableModel(std::shared_ptr<IBlockEventsHandler> handler)
+    {
+        auto source = std::make_shared<LinearTestBlock>("source", 1.0, std::vector<double>{}, handler, std::make_shared<SampleTime>(SampleTimeType::discrete, 0.1), true);
+        auto integrator = std::make_shared<ContinuousTestBlock>("integrator", 0, std::vector<double>{0.0},
+            [](const std::vector<double>& states, const std::vector<double>& inputs, double time) { return std::vector<double>{inputs[0] - states[0]}; }, handler, 1);
+        auto sampler = std::make_shared<LinearTestBlock>("sampler", 0.0, std::vector<double>{2.0}, handler, std::make_shared<SampleTime>(SampleTimeType::discrete, 0.25), true, 2);
+        std::vector<std::shared_ptr<PortLink>> portLinks = {
+            std::make_shared<PortLink>(source, integrator, 0, 0),
+            std::make_shared<PortLink>(integrator, sampler, 0, 0)};
+        return std::make_shared<SimulationModel>(std::vector<std::shared_ptr<ISimulationBlock>>{source, integrator, sampler}, portLinks, handler);
+    }
+
+    std::shared_ptr<SimulationOptions> MakeResumableOptions()
+    {
+        auto simulationOptions = std::make_shared<SimulationOptions>();
+        simulationOptions->startTime = 0.0;
+        simulationOptions->stopTime = 1.0;
+        simulationOptions->solversConfiguration = {{"default", {{"Type", std::string("odeint")}, {"ControlledSolver", std::string("runge_kutta_dopri5")}}}};
+        simulationOptions->blockIdsInputOrOutputAndIndexesToLog = {{"source", "output", 0}, {"integrator", "output", 0}, {"sampler", "output", 0}};
+        return simulationOptions;
+    }
+}
+
+// Test that a run stopped step by step, saved and restored into a new manager ends as the uninterrupted run, never written ports included.
+TEST(SimulationCheckpointTest, RestoredRunMatchesUninterruptedRun) {
+    // Step by step runs leave the last returned time hit pending, the one at the stop time is processed by one more step
+    SimulationManager uninterruptedManager(MakeResumableModel(std::make_shared<BlockEventsHandler>()), MakeResumableOptions());
+    while (uninterruptedManager.RunSimulationStep() < 1.0)
+    {
+        ;
+    }
+    uninterruptedManager.RunSimulationStep();
+    std::shared_ptr<SimulationOutput> uninterruptedOutput = uninterruptedManager.GetSimulationOutput();
+
+    SimulationManager interruptedManager(MakeResumableModel(std::make_shared<BlockEventsHandler>()), MakeResumableOptions());
+    while (interruptedManager.RunSimulationStep() < 0.45)
+    {
+        ;
+    }
+    std::vector<unsigned char> checkpoint = interruptedManager.SaveCheckpoint();
+
+    std::shared_ptr<SimulationModel> resumedModel = MakeResumableModel(std::make_shared<BlockEventsHandler>());
+    SimulationManager resumedManager(resumedModel, MakeResumableOptions());
+    resumedManager.RestoreCheckpoint(checkpoint);
+    EXPECT_FALSE(resumedModel->simulationBlocks[2]->GetOutputPorts()[1]->GetValueReference().TryCastToTypedReference<double>().IsInitialized());
+    std::shared_ptr<SimulationOutput> resumedOutput = resumedManager.RunSimulation();
+
+    for (const std::string signalId : {"source/output/0", "integrator/output/0", "sampler/output/0"})
+    {
+        auto expectedSignal = uninterruptedOutput->signals["LoggedSignals"][signalId]->TryCastToTyped<double>();
+        auto firstSignal = interruptedManager.GetSimulationOutput()->signals["LoggedSignals"][signalId]->TryCastToTyped<double>();
+        auto secondSignal = resumedOutput->signals["LoggedSignals"][signalId]->TryCastToTyped<double>();
+
+        std::vector<double> times = firstSignal->times;
+        times.insert(times.end(), secondSignal->times.begin(), secondSignal->times.end());
+        std::vector<double> values = firstSignal->values;
+        values.insert(values.end(), secondSignal->values.begin(), secondSignal->values.end());
+
+        ASSERT_EQ(times.size(), expectedSignal->times.size()) << signalId;
+        EXPECT_FALSE(firstSignal->times.empty()) << signalId;
+        EXPECT_FALSE(secondSignal->times.empty()) << signalId;
+        for (int i = 0; i < times.size(); i++)
+        {
+            EXPECT_DOUBLE_EQ(times[i], expectedSignal->times[i]) << signalId;
+            EXPECT_DOUBLE_EQ(values[i], expectedSignal->values[i]) << signalId;
+        }
+    }
+}
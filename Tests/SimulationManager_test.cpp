@@ -0,0 +1,219 @@
+// Tests/SimulationManager_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/SimulationManager.h>
+#include <PySysLinkBase/BlockEventsHandler.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "SimulationTestBlocks.h"
+
+using namespace PySysLinkBase;
+
+namespace
+{
+    void ExpectSameLoggedSignals(const std::shared_ptr<SimulationOutput>& expectedOutput, const std::shared_ptr<SimulationOutput>& output)
+    {
+        ASSERT_EQ(output->signals["LoggedSignals"].size(), expectedOutput->signals["LoggedSignals"].size());
+        for (const auto& [signalId, expectedUnknownSignal] : expectedOutput->signals["LoggedSignals"])
+        {
+            auto expectedSignal = expectedUnknownSignal->TryCastToTyped<double>();
+            auto signal = output->signals["LoggedSignals"][signalId]->TryCastToTyped<double>();
+            ASSERT_EQ(signal->times.size(), expectedSignal->times.size()) << signalId;
+            for (int i = 0; i < signal->times.size(); i++)
+            {
+                EXPECT_DOUBLE_EQ(signal->times[i], expectedSignal->times[i]) << signalId;
+                EXPECT_DOUBLE_EQ(signal->values[i], expectedSignal->values[i]) << signalId;
+            }
+        }
+    }
+}
+
+// Test that continuous groups sharing a multirate block are stepped in one cluster, so a concurrent run logs the same as a sequential one.
+TEST(SimulationManagerTest, ConcurrentContinuousGroupsMatchSequentialRun) {
+    auto runSimulation = [](bool runContinuousGroupsConcurrently) {
+        auto handler = std::make_shared<BlockEventsHandler>();
+        std::vector<std::shared_ptr<ISimulationBlock>> blocks = {};
+        for (int group = 0; group < 3; group++)
+        {
+            double rate = group + 1.0;
+            blocks.push_back(std::make_shared<ContinuousTestBlock>("integrator" + std::to_string(group), group, std::vector<double>{0.0},
+                [rate](const std::vector<double>& states, const std::vector<double>& inputs, double time) { return std::vector<double>{1.0 - rate * states[0]}; }, handler));
+        }
+        // Reads only from group 0 but is also evaluated by group 1
+        auto sharedSampleTime = std::make_shared<SampleTime>(SampleTimeType::multirate, std::vector<std::shared_ptr<SampleTime>>{
+            std::make_shared<SampleTime>(SampleTimeType::continuous, 0), std::make_shared<SampleTime>(SampleTimeType::continuous, 1)});
+        auto shared = std::make_shared<LinearTestBlock>("shared", 0.0, std::vector<double>{1.0}, handler, sharedSampleTime);
+        blocks.push_back(shared);
+        std::vector<std::shared_ptr<PortLink>> portLinks = {std::make_shared<PortLink>(blocks[0], shared, 0, 0)};
+
+        auto simulationOptions = std::make_shared<SimulationOptions>();
+        simulationOptions->startTime = 0.0;
+        simulationOptions->stopTime = 1.0;
+        simulationOptions->solversConfiguration = {{"default", {{"Type", std::string("odeint")}, {"ControlledSolver", std::string("runge_kutta_dopri5")}}}};
+        simulationOptions->blockIdsInputOrOutputAndIndexesToLog = {{"integrator0", "output", 0}, {"integrator1", "output", 0}, {"integrator2", "output", 0}, {"shared", "output", 0}};
+        simulationOptions->runContinuousGroupsConcurrently = runContinuousGroupsConcurrently;
+        simulationOptions->numberOfThreads = runContinuousGroupsConcurrently ? 2 : 1;
+
+        SimulationManager simulationManager(std::make_shared<SimulationModel>(blocks, portLinks, handler), simulationOptions);
+        return simulationManager.RunSimulation();
+    };
+
+    std::shared_ptr<SimulationOutput> sequentialOutput = runSimulation(false);
+    EXPECT_FALSE(sequentialOutput->signals["LoggedSignals"]["shared/output/0"]->times.empty());
+    for (int run = 0; run < 20; run++)
+    {
+        ExpectSameLoggedSignals(sequentialOutput, runSimulation(true));
+    }
+}
+
+// Test that two unlinked continuous groups with different step sizes are stepped on different threads at the same time, between discrete time hits.
+TEST(SimulationManagerTest, ConcurrentContinuousGroupsStepOnDifferentThreads) {
+    // Each group waits past t = 0.5 until the other one gets there too, which only happens if they are stepped concurrently
+    std::mutex rendezvousMutex;
+    std::condition_variable rendezvousCondition;
+    int groupsAtRendezvous = 0;
+    bool isRendezvousMet = true;
+    std::set<std::thread::id> threadsOfEachGroup[2];
+
+    auto handler = std::make_shared<BlockEventsHandler>();
+    std::vector<std::shared_ptr<ISimulationBlock>> blocks = {};
+    for (int group = 0; group < 2; group++)
+    {
+        double rate = group == 0 ? 1.0 : 20.0;
+        auto hasReachedRendezvous = std::make_shared<bool>(false);
+        blocks.push_back(std::make_shared<ContinuousTestBlock>("integrator" + std::to_string(group), group, std::vector<double>{1.0},
+            [&, group, rate, hasReachedRendezvous](const std::vector<double>& states, const std::vector<double>& inputs, double time) {
+                std::unique_lock<std::mutex> lock(rendezvousMutex);
+                // The step at the stop time is synchronized with the discrete hit, on the main thread
+                if (time > 0.5 && time < 1.0)
+                {
+                    threadsOfEachGroup[group].insert(std::this_thread::get_id());
+                    if (!*hasReachedRendezvous)
+                    {
+                        *hasReachedRendezvous = true;
+                        groupsAtRendezvous++;
+                        rendezvousCondition.notify_all();
+                        isRendezvousMet &= rendezvousCondition.wait_for(lock, std::chrono::seconds(5), [&]{ return groupsAtRendezvous == 2; });
+                    }
+                }
+                return std::vector<double>{-rate * states[0]};
+            }, handler));
+    }
+    // Only a discrete time hit at the end, so both groups run on their own for the whole simulation
+    blocks.push_back(std::make_shared<LinearTestBlock>("sampler", 0.0, std::vector<double>{}, handler, std::make_shared<SampleTime>(SampleTimeType::discrete, 1.0)));
+
+    auto simulationOptions = std::make_shared<SimulationOptions>();
+    simulationOptions->startTime = 0.0;
+    simulationOptions->stopTime = 1.0;
+    simulationOptions->solversConfiguration = {{"default", {{"Type", std::string("odeint")}, {"ControlledSolver", std::string("runge_kutta_dopri5")}}}};
+    simulationOptions->blockIdsInputOrOutputAndIndexesToLog = {{"integrator0", "output", 0}, {"integrator1", "output", 0}};
+    simulationOptions->runContinuousGroupsConcurrently = true;
+    simulationOptions->numberOfThreads = 2;
+
+    SimulationManager simulationManager(std::make_shared<SimulationModel>(blocks, std::vector<std::shared_ptr<PortLink>>{}, handler), simulationOptions);
+    std::shared_ptr<SimulationOutput> output = simulationManager.RunSimulation();
+
+    EXPECT_TRUE(isRendezvousMet);
+    ASSERT_EQ(threadsOfEachGroup[0].size(), 1);
+    ASSERT_EQ(threadsOfEachGroup[1].size(), 1);
+    EXPECT_NE(*threadsOfEachGroup[0].begin(), *threadsOfEachGroup[1].begin());
+    // The stiffer group takes more steps
+    EXPECT_LT(output->signals["LoggedSignals"]["integrator0/output/0"]->times.size(), output->signals["LoggedSignals"]["integrator1/output/0"]->times.size());
+}
+
+// Test that continuous groups feeding the same block outside them are stepped by one worker, so its inputs are not written from two threads.
+TEST(SimulationManagerTest, ContinuousGroupsFeedingOneBlockShareCluster) {
+    // Each group pauses once mid-run; an evaluation of the other group during that pause means they were stepped concurrently
+    std::atomic<int> evaluationsInProgress{0};
+    std::atomic<bool> isOverlapSeen{false};
+
+    auto handler = std::make_shared<BlockEventsHandler>();
+    std::vector<std::shared_ptr<ISimulationBlock>> blocks = {};
+    for (int group = 0; group < 2; group++)
+    {
+        double rate = group == 0 ? 1.0 : 20.0;
+        auto hasPaused = std::make_shared<bool>(false);
+        blocks.push_back(std::make_shared<ContinuousTestBlock>("integrator" + std::to_string(group), group, std::vector<double>{1.0},
+            [&, rate, hasPaused](const std::vector<double>& states, const std::vector<double>& inputs, double time) {
+                if (++evaluationsInProgress > 1)
+                {
+                    isOverlapSeen = true;
+                }
+                if (time > 0.5 && !*hasPaused)
+                {
+                    *hasPaused = true;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                }
+                evaluationsInProgress--;
+                return std::vector<double>{-rate * states[0]};
+            }, handler));
+    }
+    auto sum = std::make_shared<LinearTestBlock>("sum", 0.0, std::vector<double>{1.0, 1.0}, handler, std::make_shared<SampleTime>(SampleTimeType::discrete, 0.25));
+    blocks.push_back(sum);
+    std::vector<std::shared_ptr<PortLink>> portLinks = {std::make_shared<PortLink>(blocks[0], sum, 0, 0), std::make_shared<PortLink>(blocks[1], sum, 0, 1)};
+
+    auto simulationOptions = std::make_shared<SimulationOptions>();
+    simulationOptions->startTime = 0.0;
+    simulationOptions->stopTime = 1.0;
+    simulationOptions->solversConfiguration = {{"default", {{"Type", std::string("odeint")}, {"ControlledSolver", std::string("runge_kutta_dopri5")}}}};
+    simulationOptions->runContinuousGroupsConcurrently = true;
+    simulationOptions->numberOfThreads = 2;
+
+    SimulationManager simulationManager(std::make_shared<SimulationModel>(blocks, portLinks, handler), simulationOptions);
+    simulationManager.RunSimulation();
+
+    EXPECT_FALSE(isOverlapSeen);
+}
+
+// Test that blocks evaluated on several threads give the same logged signals as a sequential run.
+TEST(SimulationManagerTest, ParallelBlockEvaluationMatchesSequentialRun) {
+    auto runSimulation = [](int numberOfThreads) {
+        auto handler = std::make_shared<BlockEventsHandler>();
+        auto discrete = [](double sampleTime) { return std::make_shared<SampleTime>(SampleTimeType::discrete, sampleTime); };
+        auto fastSource = std::make_shared<LinearTestBlock>("fastSource", 1.0, std::vector<double>{}, handler, discrete(0.1), true);
+        auto slowSource = std::make_shared<LinearTestBlock>("slowSource", -2.0, std::vector<double>{}, handler, discrete(0.25), true);
+        auto sum = std::make_shared<LinearTestBlock>("sum", 0.5, std::vector<double>{1.0, 0.5}, handler, discrete(0.05));
+        auto otherSum = std::make_shared<LinearTestBlock>("otherSum", 0.0, std::vector<double>{-1.0, 2.0}, handler, discrete(0.05), true);
+        auto integrator = std::make_shared<ContinuousTestBlock>("integrator", 0, std::vector<double>{0.0},
+            [](const std::vector<double>& states, const std::vector<double>& inputs, double time) { return std::vector<double>{inputs[0] - states[0]}; }, handler, 1);
+        auto sampler = std::make_shared<LinearTestBlock>("sampler", 0.0, std::vector<double>{3.0, 1.0}, handler, discrete(0.1));
+        std::vector<std::shared_ptr<PortLink>> portLinks = {
+            std::make_shared<PortLink>(fastSource, sum, 0, 0),
+            std::make_shared<PortLink>(slowSource, sum, 0, 1),
+            std::make_shared<PortLink>(fastSource, otherSum, 0, 0),
+            std::make_shared<PortLink>(slowSource, otherSum, 0, 1),
+            std::make_shared<PortLink>(sum, integrator, 0, 0),
+            std::make_shared<PortLink>(integrator, sampler, 0, 0),
+            std::make_shared<PortLink>(otherSum, sampler, 0, 1)};
+        std::vector<std::shared_ptr<ISimulationBlock>> blocks = {sampler, integrator, otherSum, sum, slowSource, fastSource};
+
+        auto simulationOptions = std::make_shared<SimulationOptions>();
+        simulationOptions->startTime = 0.0;
+        simulationOptions->stopTime = 2.0;
+        simulationOptions->solversConfiguration = {{"default", {{"Type", std::string("odeint")}, {"ControlledSolver", std::string("runge_kutta_dopri5")}}}};
+        for (const auto& block : blocks)
+        {
+            simulationOptions->blockIdsInputOrOutputAndIndexesToLog.push_back({block->GetId(), "output", 0});
+        }
+        simulationOptions->numberOfThreads = numberOfThreads;
+
+        SimulationManager simulationManager(std::make_shared<SimulationModel>(blocks, portLinks, handler), simulationOptions);
+        return simulationManager.RunSimulation();
+    };
+
+    std::shared_ptr<SimulationOutput> sequentialOutput = runSimulation(1);
+    EXPECT_FALSE(sequentialOutput->signals["LoggedSignals"]["sampler/output/0"]->times.empty());
+    for (int numberOfThreads : {2, 4})
+    {
+        ExpectSameLoggedSignals(sequentialOutput, runSimulation(numberOfThreads));
+    }
+}
@@ -7,7 +7,10 @@
 #include <PySysLinkBase/SpdlogManager.h>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <stdexcept>
+#include <vector>
 
 #include "DummySimulationBlock.h"
 #include "DummyBlockFactory.h"
@@ -57,10 +60,184 @@ TEST_F(ModelParserTestFixture, OrderBlockChainsOntoFreeOrderTest) {
         << "Ordered blocks should match the number of simulation blocks.";
 }
 
+// Test that GetBlocksInExecutionOrder orders the same blocks as OrderBlockChainsOntoFreeOrder, each after the origin of its direct feedthrough inputs.
+TEST_F(ModelParserTestFixture, GetBlocksInExecutionOrderTest) {
+    auto chainOrderedBlocks = simulationModel->OrderBlockChainsOntoFreeOrder(simulationModel->GetDirectBlockChains());
+    auto executionOrderedBlocks = simulationModel->GetBlocksInExecutionOrder();
+
+    std::set<std::string> chainOrderedIds = {};
+    for (const auto& block : chainOrderedBlocks) {
+        chainOrderedIds.insert(block->GetId());
+    }
+    std::map<std::string, int> executionIndexOfEachId = {};
+    for (int i = 0; i < executionOrderedBlocks.size(); i++) {
+        executionIndexOfEachId.insert({executionOrderedBlocks[i]->GetId(), i});
+    }
+    EXPECT_EQ(executionOrderedBlocks.size(), chainOrderedBlocks.size());
+    EXPECT_EQ(executionIndexOfEachId.size(), executionOrderedBlocks.size()) << "No block should be ordered twice.";
+    for (const auto& id : chainOrderedIds) {
+        EXPECT_EQ(executionIndexOfEachId.count(id), 1) << "Block " << id << " missing from the execution order.";
+    }
+
+    for (const auto& sinkBlock : executionOrderedBlocks) {
+        auto inputPorts = sinkBlock->GetInputPorts();
+        for (int i = 0; i < inputPorts.size(); i++) {
+            auto originBlock = simulationModel->GetOriginBlock(sinkBlock, i);
+            if (originBlock && inputPorts[i]->HasDirectFeedthrough()) {
+                EXPECT_LT(executionIndexOfEachId.at(originBlock->GetId()), executionIndexOfEachId.at(sinkBlock->GetId()))
+                    << "Block " << originBlock->GetId() << " feeds " << sinkBlock->GetId() << " through and should come before it.";
+            }
+        }
+    }
+}
+
 // Test that PropagateSampleTimes sets a non-null sample time for each block.
 TEST_F(ModelParserTestFixture, PropagateSampleTimesTest) {
     simulationModel->PropagateSampleTimes();
     for (const auto& block : simulationModel->simulationBlocks) {
         EXPECT_NE(block->GetSampleTime(), nullptr) << "Each block should have a non-null sample time after propagation.";
     }
-}
\ No newline at end of file
+}
+
+namespace
+{
+    std::shared_ptr<DummySimulationBlock> MakeDummyBlock(const std::string& id, int inputPortAmount, int outputPortAmount, std::shared_ptr<PySysLinkBase::IBlockEventsHandler> handler)
+    {
+        return std::make_shared<DummySimulationBlock>(id, handler, inputPortAmount, outputPortAmount);
+    }
+
+    // Dummy block that keeps the sample time it is given
+    class SampleTimeTestBlock : public DummySimulationBlock
+    {
+        public:
+        SampleTimeTestBlock(const std::string& id, int inputPortAmount, int outputPortAmount, std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, std::shared_ptr<PySysLinkBase::IBlockEventsHandler> handler)
+            : DummySimulationBlock(id, handler, inputPortAmount, outputPortAmount),
+              sampleTime(sampleTime) {}
+
+        const std::shared_ptr<PySysLinkBase::SampleTime> GetSampleTime() const override { return this->sampleTime; }
+        void SetSampleTime(std::shared_ptr<PySysLinkBase::SampleTime> sampleTime) override { this->sampleTime = sampleTime; }
+
+        private:
+        std::shared_ptr<PySysLinkBase::SampleTime> sampleTime;
+    };
+}
+
+// Test that a cycle of direct feedthrough links is found as an algebraic loop and ordered as one unit after its inputs.
+TEST(SimulationModelTest, GetBlocksInExecutionOrderKeepsAlgebraicLoopTogether) {
+    auto handler = std::make_shared<PySysLinkBase::BlockEventsHandler>();
+    auto source = MakeDummyBlock("source", 0, 1, handler);
+    auto sum = MakeDummyBlock("sum", 2, 1, handler);
+    auto gain = MakeDummyBlock("gain", 1, 1, handler);
+    auto sink = MakeDummyBlock("sink", 1, 0, handler);
+    std::vector<std::shared_ptr<PySysLinkBase::PortLink>> portLinks = {
+        std::make_shared<PySysLinkBase::PortLink>(source, sum, 0, 0),
+        std::make_shared<PySysLinkBase::PortLink>(sum, gain, 0, 0),
+        std::make_shared<PySysLinkBase::PortLink>(gain, sum, 0, 1),
+        std::make_shared<PySysLinkBase::PortLink>(gain, sink, 0, 0)};
+    PySysLinkBase::SimulationModel simulationModel({sink, gain, sum, source}, portLinks, handler);
+
+    auto algebraicLoops = simulationModel.GetAlgebraicLoops();
+    ASSERT_EQ(algebraicLoops.size(), 1);
+    EXPECT_EQ(algebraicLoops[0], std::vector<std::shared_ptr<PySysLinkBase::ISimulationBlock>>({gain, sum}));
+
+    auto orderedBlocks = simulationModel.GetBlocksInExecutionOrder();
+    EXPECT_EQ(orderedBlocks, std::vector<std::shared_ptr<PySysLinkBase::ISimulationBlock>>({source, gain, sum, sink}));
+}
+
+// Test that after a local edit only the sample times inherited around the edited block are propagated again.
+TEST(SimulationModelTest, PropagateSampleTimesAgainAfterLocalEdit) {
+    auto inherited = []() {
+        return std::make_shared<PySysLinkBase::SampleTime>(PySysLinkBase::SampleTimeType::inherited,
+            std::vector<PySysLinkBase::SampleTimeType>{PySysLinkBase::SampleTimeType::discrete, PySysLinkBase::SampleTimeType::continuous});
+    };
+    auto handler = std::make_shared<PySysLinkBase::BlockEventsHandler>();
+    auto source = std::make_shared<SampleTimeTestBlock>("source", 0, 1, std::make_shared<PySysLinkBase::SampleTime>(PySysLinkBase::SampleTimeType::discrete, 0.1), handler);
+    auto gain = std::make_shared<SampleTimeTestBlock>("gain", 1, 1, inherited(), handler);
+    auto sink = std::make_shared<SampleTimeTestBlock>("sink", 1, 0, inherited(), handler);
+    auto otherSource = std::make_shared<SampleTimeTestBlock>("otherSource", 0, 1, std::make_shared<PySysLinkBase::SampleTime>(PySysLinkBase::SampleTimeType::discrete, 0.3), handler);
+    auto otherSink = std::make_shared<SampleTimeTestBlock>("otherSink", 1, 0, inherited(), handler);
+    std::vector<std::shared_ptr<PySysLinkBase::PortLink>> portLinks = {
+        std::make_shared<PySysLinkBase::PortLink>(source, gain, 0, 0),
+        std::make_shared<PySysLinkBase::PortLink>(gain, sink, 0, 0),
+        std::make_shared<PySysLinkBase::PortLink>(otherSource, otherSink, 0, 0)};
+    PySysLinkBase::SimulationModel simulationModel({sink, gain, source, otherSink, otherSource}, portLinks, handler);
+
+    simulationModel.PropagateSampleTimes();
+    EXPECT_DOUBLE_EQ(sink->GetSampleTime()->GetDiscreteSampleTime(), 0.1);
+    auto otherSinkSampleTime = otherSink->GetSampleTime();
+    EXPECT_DOUBLE_EQ(otherSinkSampleTime->GetDiscreteSampleTime(), 0.3);
+
+    source->SetSampleTime(std::make_shared<PySysLinkBase::SampleTime>(PySysLinkBase::SampleTimeType::discrete, 0.5));
+    simulationModel.PropagateSampleTimes({source});
+    EXPECT_DOUBLE_EQ(gain->GetSampleTime()->GetDiscreteSampleTime(), 0.5);
+    EXPECT_DOUBLE_EQ(sink->GetSampleTime()->GetDiscreteSampleTime(), 0.5);
+    EXPECT_EQ(otherSink->GetSampleTime(), otherSinkSampleTime);
+}
+
+// Test that a source given its sample time by the backward pass passes it on forward to the other blocks it feeds.
+TEST(SimulationModelTest, PropagateSampleTimesForwardAfterBackwardUpdate) {
+    auto inherited = []() {
+        return std::make_shared<PySysLinkBase::SampleTime>(PySysLinkBase::SampleTimeType::inherited,
+            std::vector<PySysLinkBase::SampleTimeType>{PySysLinkBase::SampleTimeType::discrete, PySysLinkBase::SampleTimeType::continuous});
+    };
+    auto handler = std::make_shared<PySysLinkBase::BlockEventsHandler>();
+    auto gain = std::make_shared<SampleTimeTestBlock>("gain", 1, 1, inherited(), handler);
+    auto discreteSink = std::make_shared<SampleTimeTestBlock>("discreteSink", 1, 0, std::make_shared<PySysLinkBase::SampleTime>(PySysLinkBase::SampleTimeType::discrete, 0.2), handler);
+    auto source = std::make_shared<SampleTimeTestBlock>("source", 0, 1, inherited(), handler);
+    auto otherGain = std::make_shared<SampleTimeTestBlock>("otherGain", 1, 1, inherited(), handler);
+    auto otherSink = std::make_shared<SampleTimeTestBlock>("otherSink", 1, 0, inherited(), handler);
+    std::vector<std::shared_ptr<PySysLinkBase::PortLink>> portLinks = {
+        std::make_shared<PySysLinkBase::PortLink>(source, gain, 0, 0),
+        std::make_shared<PySysLinkBase::PortLink>(source, otherGain, 0, 0),
+        std::make_shared<PySysLinkBase::PortLink>(gain, discreteSink, 0, 0),
+        std::make_shared<PySysLinkBase::PortLink>(otherGain, otherSink, 0, 0)};
+    PySysLinkBase::SimulationModel simulationModel({gain, discreteSink, source, otherGain, otherSink}, portLinks, handler);
+
+    simulationModel.PropagateSampleTimes();
+    for (const auto& block : simulationModel.simulationBlocks)
+    {
+        ASSERT_EQ(block->GetSampleTime()->GetSampleTimeType(), PySysLinkBase::SampleTimeType::discrete) << block->GetId();
+        EXPECT_DOUBLE_EQ(block->GetSampleTime()->GetDiscreteSampleTime(), 0.2) << block->GetId();
+    }
+}
+
+// Test that the port link index answers connected port and origin block queries, and follows links added or edited afterwards.
+TEST(SimulationModelTest, PortLinksIndexFollowsLinkEdits) {
+    auto handler = std::make_shared<PySysLinkBase::BlockEventsHandler>();
+    auto source = MakeDummyBlock("source", 0, 2, handler);
+    auto sink = MakeDummyBlock("sink", 2, 0, handler);
+    auto otherSink = MakeDummyBlock("otherSink", 1, 0, handler);
+    PySysLinkBase::SimulationModel simulationModel({source, sink, otherSink}, {std::make_shared<PySysLinkBase::PortLink>(source, sink, 0, 1)}, handler);
+
+    EXPECT_EQ(simulationModel.GetConnectedPorts(source, 0), std::vector<std::shared_ptr<PySysLinkBase::InputPort>>({sink->GetInputPorts()[1]}));
+    EXPECT_TRUE(simulationModel.GetConnectedPorts(source, 1).empty());
+    EXPECT_EQ(simulationModel.GetOriginBlock(sink, 1), source);
+    EXPECT_EQ(simulationModel.GetOriginBlock(sink, 0), nullptr);
+
+    simulationModel.AddPortLink(std::make_shared<PySysLinkBase::PortLink>(source, otherSink, 0, 0));
+    auto [connectedBlocks, connectedPortIndexes] = simulationModel.GetConnectedBlocks(source, 0);
+    EXPECT_EQ(connectedBlocks, std::vector<std::shared_ptr<PySysLinkBase::ISimulationBlock>>({sink, otherSink}));
+    EXPECT_EQ(connectedPortIndexes, std::vector<int>({1, 0}));
+
+    // A link replaced in place keeps the link count, so it is only seen after the index is rebuilt
+    simulationModel.portLinks[0] = std::make_shared<PySysLinkBase::PortLink>(source, sink, 1, 0);
+    simulationModel.RebuildPortLinksIndex();
+    EXPECT_EQ(simulationModel.GetConnectedPorts(source, 0), std::vector<std::shared_ptr<PySysLinkBase::InputPort>>({otherSink->GetInputPorts()[0]}));
+    EXPECT_EQ(simulationModel.GetConnectedPorts(source, 1), std::vector<std::shared_ptr<PySysLinkBase::InputPort>>({sink->GetInputPorts()[0]}));
+    EXPECT_EQ(simulationModel.GetOriginBlock(sink, 0), source);
+    EXPECT_EQ(simulationModel.GetOriginBlock(sink, 1), nullptr);
+}
+
+// Test that a link from or to a port the block does not have is rejected when it is indexed.
+TEST(SimulationModelTest, PortLinksIndexRejectsMissingPorts) {
+    auto handler = std::make_shared<PySysLinkBase::BlockEventsHandler>();
+    auto source = MakeDummyBlock("source", 0, 1, handler);
+    auto sink = MakeDummyBlock("sink", 1, 0, handler);
+
+    EXPECT_THROW(PySysLinkBase::SimulationModel({source, sink}, {std::make_shared<PySysLinkBase::PortLink>(source, sink, 1, 0)}, handler), std::out_of_range);
+    EXPECT_THROW(PySysLinkBase::SimulationModel({source, sink}, {std::make_shared<PySysLinkBase::PortLink>(source, sink, 0, 1)}, handler), std::out_of_range);
+
+    PySysLinkBase::SimulationModel simulationModel({source, sink}, {}, handler);
+    EXPECT_THROW(simulationModel.AddPortLink(std::make_shared<PySysLinkBase::PortLink>(source, sink, -1, 0)), std::out_of_range);
+    EXPECT_TRUE(simulationModel.portLinks.empty());
+}
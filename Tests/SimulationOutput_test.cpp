@@ -0,0 +1,169 @@
+// Tests/SimulationOutput_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/SimulationOutput.h>
+#include <PySysLinkBase/PortsAndSignalValues/SignalValue.h>
+#include <highfive/H5File.hpp>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace PySysLinkBase;
+
+namespace
+{
+    template <typename T>
+    std::vector<T> ReadDataset(const std::string& fileName, const std::string& path)
+    {
+        HighFive::File file(fileName, HighFive::File::ReadOnly);
+        std::vector<T> values;
+        file.getDataSet(path).read(values);
+        return values;
+    }
+}
+
+// Test that values appended through a registered signal handle are stored as the ones inserted by signal name.
+TEST(SimulationOutputTest, RegisteredHandleMatchesNamedInsert) {
+    SimulationOutput namedOutput;
+    SimulationOutput registeredOutput;
+    int doubleHandle = registeredOutput.RegisterSignal("LoggedSignals", "double");
+    int integerHandle = registeredOutput.RegisterSignal("LoggedSignals", "integer");
+    for (int i = 0; i < 10; i++)
+    {
+        double time = 0.1 * i;
+        SignalValue<double> doubleValue(1.5 * i);
+        SignalValue<int> integerValue(-i);
+        namedOutput.InsertUnknownValue("LoggedSignals", "double", std::make_shared<SignalValue<double>>(doubleValue), time);
+        namedOutput.InsertUnknownValue("LoggedSignals", "integer", std::make_shared<SignalValue<int>>(integerValue), time);
+        registeredOutput.InsertUnknownValue(doubleHandle, doubleValue, time);
+        registeredOutput.InsertUnknownValue(integerHandle, integerValue, time);
+    }
+
+    auto namedDoubles = namedOutput.signals["LoggedSignals"]["double"]->TryCastToTyped<double>();
+    auto registeredDoubles = registeredOutput.signals["LoggedSignals"]["double"]->TryCastToTyped<double>();
+    EXPECT_EQ(registeredDoubles->times, namedDoubles->times);
+    EXPECT_EQ(registeredDoubles->values, namedDoubles->values);
+
+    auto namedIntegers = namedOutput.signals["LoggedSignals"]["integer"]->TryCastToTyped<int>();
+    auto registeredIntegers = registeredOutput.signals["LoggedSignals"]["integer"]->TryCastToTyped<int>();
+    EXPECT_EQ(registeredIntegers->times, namedIntegers->times);
+    EXPECT_EQ(registeredIntegers->values, namedIntegers->values);
+
+    // The handle keeps the type of its first value
+    EXPECT_THROW(registeredOutput.InsertUnknownValue(doubleHandle, SignalValue<int>(1), 1.0), std::invalid_argument);
+}
+
+// Test that the task ring refuses pushes when every slot is full and hands back recycled buffers.
+TEST(SimulationOutputTest, TaskRingRefusesPushWhenFull) {
+    TaskRing<WriteTask> taskRing(2, WriteTask(4));
+    WriteTask writeTask(4);
+
+    for (int i = 0; i < 2; i++)
+    {
+        writeTask.datasetPath = "task" + std::to_string(i);
+        writeTask.currentIndex = 1;
+        ASSERT_TRUE(taskRing.TryPush(writeTask));
+        EXPECT_EQ(writeTask.currentIndex, 0);
+        EXPECT_EQ(writeTask.times.size(), 4);
+    }
+    writeTask.datasetPath = "task2";
+    writeTask.currentIndex = 1;
+    EXPECT_FALSE(taskRing.TryPush(writeTask));
+    // A refused task keeps its samples
+    EXPECT_EQ(writeTask.currentIndex, 1);
+
+    ASSERT_NE(taskRing.Front(), nullptr);
+    EXPECT_EQ(taskRing.Front()->datasetPath, "task0");
+    taskRing.Pop();
+    EXPECT_TRUE(taskRing.TryPush(writeTask));
+
+    EXPECT_EQ(taskRing.Front()->datasetPath, "task1");
+    taskRing.Pop();
+    EXPECT_EQ(taskRing.Front()->datasetPath, "task2");
+    taskRing.Pop();
+    EXPECT_EQ(taskRing.Front(), nullptr);
+}
+
+// Test that a full write queue makes the block policy wait for every sample to be written.
+TEST(SimulationOutputTest, BlockPolicyWritesEverySample) {
+    const std::string fileName = "SimulationOutput_test_block.h5";
+    const int sampleCount = 2000;
+    {
+        SimulationOutput output(false, true, fileName, 1, 1, 0, false, 1, WriteQueueFullPolicy::block);
+        for (int i = 0; i < sampleCount; i++)
+        {
+            output.InsertValueTyped<double>("LoggedSignals", "signal", 2.0 * i, 0.01 * i);
+        }
+        EXPECT_EQ(output.GetDroppedSampleCount(), 0);
+    }
+
+    std::vector<double> values = ReadDataset<double>(fileName, "LoggedSignals/signal/values");
+    ASSERT_EQ(values.size(), sampleCount);
+    for (int i = 0; i < sampleCount; i++)
+    {
+        EXPECT_EQ(values[i], 2.0 * i);
+    }
+    std::remove(fileName.c_str());
+}
+
+// Test that under the drop policy every sample is either written or counted as dropped.
+TEST(SimulationOutputTest, DropPolicyCountsEverySampleNotWritten) {
+    const std::string fileName = "SimulationOutput_test_drop.h5";
+    const int sampleCount = 2000;
+    std::size_t droppedSamples;
+    {
+        SimulationOutput output(false, true, fileName, 1, 1, 0, false, 1, WriteQueueFullPolicy::drop);
+        for (int i = 0; i < sampleCount; i++)
+        {
+            output.InsertValueTyped<double>("LoggedSignals", "signal", 2.0 * i, 0.01 * i);
+        }
+        droppedSamples = output.GetDroppedSampleCount();
+    }
+
+    std::vector<double> times = ReadDataset<double>(fileName, "LoggedSignals/signal/times");
+    EXPECT_EQ(times.size() + droppedSamples, sampleCount);
+    // Written samples keep their order
+    for (int i = 1; i < times.size(); i++)
+    {
+        EXPECT_LT(times[i - 1], times[i]);
+    }
+    std::remove(fileName.c_str());
+}
+
+// Test that writing in chunks stores the same dataset contents as writing every sample on its own.
+TEST(SimulationOutputTest, ChunkedWriteMatchesUnchunkedWrite) {
+    // 25 samples leave a partial chunk, written when the output closes
+    const int sampleCount = 25;
+    auto writeFile = [&](const std::string& fileName, int chunkSize)
+    {
+        SimulationOutput output(false, true, fileName, chunkSize);
+        for (int i = 0; i < sampleCount; i++)
+        {
+            output.InsertValueTyped<double>("LoggedSignals", "double", 0.5 * i * i, 0.1 * i);
+            output.InsertValueTyped<int>("LoggedSignals", "integer", 3 - i, 0.1 * i);
+        }
+    };
+    writeFile("SimulationOutput_test_unchunked.h5", 1);
+    writeFile("SimulationOutput_test_chunked.h5", 8);
+
+    for (const std::string& signalId : {"double", "integer"})
+    {
+        std::vector<double> unchunkedTimes = ReadDataset<double>("SimulationOutput_test_unchunked.h5", "LoggedSignals/" + signalId + "/times");
+        std::vector<double> chunkedTimes = ReadDataset<double>("SimulationOutput_test_chunked.h5", "LoggedSignals/" + signalId + "/times");
+        ASSERT_EQ(unchunkedTimes.size(), sampleCount);
+        EXPECT_EQ(chunkedTimes, unchunkedTimes);
+    }
+    std::vector<double> unchunkedDoubles = ReadDataset<double>("SimulationOutput_test_unchunked.h5", "LoggedSignals/double/values");
+    std::vector<double> chunkedDoubles = ReadDataset<double>("SimulationOutput_test_chunked.h5", "LoggedSignals/double/values");
+    ASSERT_EQ(unchunkedDoubles.size(), sampleCount);
+    EXPECT_EQ(chunkedDoubles, unchunkedDoubles);
+    std::vector<int> unchunkedIntegers = ReadDataset<int>("SimulationOutput_test_unchunked.h5", "LoggedSignals/integer/values");
+    std::vector<int> chunkedIntegers = ReadDataset<int>("SimulationOutput_test_chunked.h5", "LoggedSignals/integer/values");
+    ASSERT_EQ(unchunkedIntegers.size(), sampleCount);
+    EXPECT_EQ(chunkedIntegers, unchunkedIntegers);
+
+    std::remove("SimulationOutput_test_unchunked.h5");
+    std::remove("SimulationOutput_test_chunked.h5");
+}
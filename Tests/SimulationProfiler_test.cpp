@@ -0,0 +1,98 @@
+// Tests/SimulationProfiler_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/SimulationProfiler.h>
+#include <PySysLinkBase/BlockEventsHandler.h>
+#include <PySysLinkBase/JsonUtilities.h>
+#include "DummySimulationBlock.h"
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace PySysLinkBase;
+
+namespace
+{
+    std::shared_ptr<DummySimulationBlock> MakeProfiledBlock(const std::string& id, std::shared_ptr<IBlockEventsHandler> handler)
+    {
+        return std::make_shared<DummySimulationBlock>(id, handler, 0, 0);
+    }
+}
+
+// Test that block times are summed per block and sorted slowest first, and that the trace keeps only the allowed spans.
+TEST(SimulationProfilerTest, ReportsBlocksSlowestFirstAndCapsTrace) {
+    auto handler = std::make_shared<BlockEventsHandler>();
+    auto fastBlock = MakeProfiledBlock("fast", handler);
+    auto slowBlock = MakeProfiledBlock("slow", handler);
+    SimulationProfiler profiler(3);
+
+    SimulationProfiler::Clock::time_point start = SimulationProfiler::Clock::now();
+    profiler.RecordBlockOutputs(*fastBlock, start, start + std::chrono::milliseconds(1));
+    profiler.RecordBlockOutputs(*slowBlock, start, start + std::chrono::milliseconds(5));
+    profiler.RecordBlockOutputs(*fastBlock, start, start + std::chrono::milliseconds(1));
+    profiler.RecordPhase(ProfiledPhase::linkPropagation, start, start + std::chrono::milliseconds(2));
+    profiler.CountRejectedStep();
+    profiler.CountEventBisectionIterations(4);
+
+    SimulationProfileReport report = profiler.GetReport();
+    ASSERT_EQ(report.blocks.size(), 2);
+    EXPECT_EQ(report.blocks[0].blockId, "slow");
+    EXPECT_EQ(report.blocks[1].blockId, "fast");
+    EXPECT_EQ(report.blocks[1].callCount, 2);
+    EXPECT_NEAR(report.blocks[1].totalSeconds, 0.002, 1e-9);
+    EXPECT_EQ(report.phases.at("LinkPropagation").callCount, 1);
+    EXPECT_EQ(report.rejectedStepCount, 1);
+    EXPECT_EQ(report.eventBisectionIterationCount, 4);
+    EXPECT_EQ(report.droppedTraceEventCount, 1);
+
+    std::ostringstream trace;
+    profiler.WriteChromeTrace(trace);
+    EXPECT_NE(trace.str().find("{\"name\": \"slow\", \"cat\": \"block\", \"ph\": \"X\""), std::string::npos);
+    EXPECT_EQ(trace.str().find("LinkPropagation"), std::string::npos);
+}
+
+// Test that spans recorded by several threads are merged per block in the report and kept apart per thread in the trace.
+TEST(SimulationProfilerTest, MergesSpansRecordedByEachThread) {
+    auto handler = std::make_shared<BlockEventsHandler>();
+    auto sharedBlock = MakeProfiledBlock("shared \"block\"", handler);
+    SimulationProfiler profiler(600);
+
+    const int threadCount = 4;
+    const int callsPerThread = 100;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([&]() {
+            SimulationProfiler::Clock::time_point start = SimulationProfiler::Clock::now();
+            for (int j = 0; j < callsPerThread; j++)
+            {
+                profiler.RecordBlockOutputs(*sharedBlock, start, start + std::chrono::microseconds(10));
+                profiler.RecordPhase(ProfiledPhase::odeRightHandSide, start, start + std::chrono::microseconds(20));
+            }
+            profiler.CountRejectedStep();
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    SimulationProfileReport report = profiler.GetReport();
+    ASSERT_EQ(report.blocks.size(), 1);
+    EXPECT_EQ(report.blocks[0].callCount, threadCount * callsPerThread);
+    EXPECT_NEAR(report.blocks[0].totalSeconds, threadCount * callsPerThread * 10e-6, 1e-9);
+    EXPECT_EQ(report.phases.at("OdeRightHandSide").callCount, threadCount * callsPerThread);
+    EXPECT_EQ(report.rejectedStepCount, threadCount);
+    EXPECT_EQ(report.droppedTraceEventCount, 2 * threadCount * callsPerThread - 600);
+
+    std::ostringstream trace;
+    profiler.WriteChromeTrace(trace);
+    EXPECT_NE(trace.str().find("\"name\": \"" + escapeJson(sharedBlock->GetId()) + "\""), std::string::npos);
+    for (int i = 0; i < threadCount; i++)
+    {
+        EXPECT_NE(trace.str().find("\"args\": {\"name\": \"thread " + std::to_string(i) + "\"}"), std::string::npos);
+    }
+}
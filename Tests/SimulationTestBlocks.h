@@ -0,0 +1,145 @@
+// SimulationTestBlocks.h
+#ifndef SIMULATION_TEST_BLOCKS_H
+#define SIMULATION_TEST_BLOCKS_H
+
+#include "PySysLinkBase/ContinuousAndOde/ISimulationBlockWithContinuousStates.h"
+#include "PySysLinkBase/SampleTime.h"
+#include "PySysLinkBase/PortsAndSignalValues/InputPort.h"
+#include "PySysLinkBase/PortsAndSignalValues/OutputPort.h"
+#include "PySysLinkBase/PortsAndSignalValues/SignalValue.h"
+#include "DummySimulationBlock.h"
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Output is bias plus the weighted sum of the inputs; an accumulating block also adds its output of the last major step.
+// Output ports after the first are never written.
+class LinearTestBlock : public DummySimulationBlock {
+public:
+    LinearTestBlock(const std::string& id, double bias, std::vector<double> weights, std::shared_ptr<PySysLinkBase::IBlockEventsHandler> handler,
+                    std::shared_ptr<PySysLinkBase::SampleTime> sampleTime = std::make_shared<PySysLinkBase::SampleTime>(PySysLinkBase::SampleTimeType::discrete, 1.0),
+                    bool isAccumulating = false, int outputPortAmount = 1)
+        : DummySimulationBlock(id, handler, weights.size(), outputPortAmount),
+          bias(bias), weights(weights), sampleTime(sampleTime), isAccumulating(isAccumulating)
+    {
+        for (int i = 1; i < outputPortAmount; i++)
+        {
+            this->GetOutputPorts()[i]->SetValue(std::make_shared<PySysLinkBase::SignalValue<double>>());
+        }
+    }
+
+    const std::shared_ptr<PySysLinkBase::SampleTime> GetSampleTime() const override { return this->sampleTime; }
+    void SetSampleTime(std::shared_ptr<PySysLinkBase::SampleTime> sampleTime) override { this->sampleTime = sampleTime; }
+
+    const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>> _ComputeOutputsOfBlock(
+            std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime, bool isMinorStep=false) override {
+        double output = this->bias + (this->isAccumulating ? this->lastMajorOutput : 0.0);
+        for (int i = 0; i < this->weights.size(); i++)
+        {
+            output += this->weights[i] * this->GetInputPorts()[i]->GetValueReference().TryCastToTypedReference<double>().GetPayload();
+        }
+        if (!isMinorStep)
+        {
+            this->lastMajorOutput = output;
+        }
+        this->GetOutputPorts()[0]->SetValue(std::make_shared<PySysLinkBase::SignalValue<double>>(output));
+        return this->GetOutputPorts();
+    }
+
+    std::vector<unsigned char> GetCheckpointState() const override {
+        std::vector<unsigned char> checkpointState(sizeof(double));
+        std::memcpy(checkpointState.data(), &this->lastMajorOutput, sizeof(double));
+        return checkpointState;
+    }
+    void RestoreCheckpointState(const std::vector<unsigned char>& checkpointState) override {
+        std::memcpy(&this->lastMajorOutput, checkpointState.data(), sizeof(double));
+    }
+
+private:
+    double bias;
+    std::vector<double> weights;
+    std::shared_ptr<PySysLinkBase::SampleTime> sampleTime;
+    bool isAccumulating;
+    double lastMajorOutput = 0.0;
+};
+
+// Continuous states driven by a given derivative function of the states, the inputs and the time.
+// Inputs have no direct feedthrough, the only output is the first state.
+class ContinuousTestBlock : public PySysLinkBase::ISimulationBlockWithContinuousStates {
+public:
+    using DerivativeFunction = std::function<std::vector<double> (const std::vector<double>& states, const std::vector<double>& inputs, double time)>;
+    // Zero crossings of its value are events
+    using EventFunction = std::function<double (const std::vector<double>& states, double time)>;
+
+    ContinuousTestBlock(const std::string& id, int continuousSampleTimeGroup, std::vector<double> initialStates, DerivativeFunction derivativeFunction,
+                        std::shared_ptr<PySysLinkBase::IBlockEventsHandler> handler, int inputPortAmount = 0)
+        : ISimulationBlockWithContinuousStates(DummySimulationBlock::MakeConfiguration(id, inputPortAmount, 1), handler),
+          states(std::move(initialStates)), derivativeFunction(std::move(derivativeFunction)),
+          sampleTime(std::make_shared<PySysLinkBase::SampleTime>(PySysLinkBase::SampleTimeType::continuous, continuousSampleTimeGroup))
+    {
+        for (int i = 0; i < inputPortAmount; i++)
+        {
+            this->inputPorts.push_back(std::make_shared<PySysLinkBase::InputPort>(false, std::make_shared<PySysLinkBase::SignalValue<double>>(0.0)));
+        }
+        this->outputPorts.push_back(std::make_shared<PySysLinkBase::OutputPort>(std::make_shared<PySysLinkBase::SignalValue<double>>(this->states[0])));
+    }
+
+    void SetEventFunction(EventFunction eventFunction) { this->eventFunction = std::move(eventFunction); }
+
+    // Calls of the derivative function, and the time of the last one
+    mutable int derivativeEvaluationCount = 0;
+    mutable double lastDerivativeTime = 0.0;
+    mutable int outputPortsQueryCount = 0;
+
+    const std::shared_ptr<PySysLinkBase::SampleTime> GetSampleTime() const override { return this->sampleTime; }
+    void SetSampleTime(std::shared_ptr<PySysLinkBase::SampleTime> sampleTime) override { this->sampleTime = sampleTime; }
+    std::vector<std::shared_ptr<PySysLinkBase::InputPort>> GetInputPorts() const override { return this->inputPorts; }
+    const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>> GetOutputPorts() const override {
+        this->outputPortsQueryCount++;
+        return this->outputPorts;
+    }
+
+    const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>> _ComputeOutputsOfBlock(
+            std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime, bool isMinorStep=false) override {
+        this->outputPorts[0]->SetValue(std::make_shared<PySysLinkBase::SignalValue<double>>(this->states[0]));
+        return this->outputPorts;
+    }
+    bool _TryUpdateConfigurationValue(std::string keyName, PySysLinkBase::ConfigurationValue value) override {
+        return false;
+    }
+
+    const std::vector<double> GetContinuousStates() const override { return this->states; }
+    void SetContinuousStates(std::vector<double> newStates) override { this->states = newStates; }
+    const std::vector<double> GetContinuousStateDerivatives(const std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime) const override {
+        std::vector<double> inputs = {};
+        for (const auto& inputPort : this->inputPorts)
+        {
+            inputs.push_back(inputPort->GetValueReference().TryCastToTypedReference<double>().GetPayload());
+        }
+        this->derivativeEvaluationCount++;
+        this->lastDerivativeTime = currentTime;
+        return this->derivativeFunction(this->states, inputs, currentTime);
+    }
+
+    const std::vector<std::pair<double, double>> GetEvents(const std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double eventTime,
+                                                           std::vector<double> eventTimeStates, bool includeKnownEvents=false) const override {
+        if (!this->eventFunction)
+        {
+            return {};
+        }
+        return {{this->eventFunction(eventTimeStates, eventTime), 0.0}};
+    }
+
+private:
+    std::vector<double> states;
+    DerivativeFunction derivativeFunction;
+    EventFunction eventFunction;
+    std::shared_ptr<PySysLinkBase::SampleTime> sampleTime;
+    std::vector<std::shared_ptr<PySysLinkBase::InputPort>> inputPorts;
+    std::vector<std::shared_ptr<PySysLinkBase::OutputPort>> outputPorts;
+};
+
+#endif /* SIMULATION_TEST_BLOCKS_H */
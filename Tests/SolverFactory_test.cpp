@@ -0,0 +1,102 @@
+// Tests/SolverFactory_test.cpp
+
+#include <gtest/gtest.h>
+#include <PySysLinkBase/ContinuousAndOde/SolverFactory.h>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace PySysLinkBase;
+
+namespace
+{
+    // x' = -x
+    class DecayOdeSystem : public IOdeSystem
+    {
+        public:
+            int GetStateCount() const override { return 1; }
+            void EvaluateDerivatives(const double* states, double* derivatives, double time) override { derivatives[0] = -states[0]; }
+    };
+}
+
+// Test that odeint solvers over Eigen and over std::vector states follow the same trajectory, step sizes included.
+TEST(SolverFactoryTest, EigenAndStdVectorStatesGiveSameTrajectory) {
+    std::map<std::string, ConfigurationValue> solverConfiguration = {
+        {"Type", std::string("odeint")},
+        {"ControlledSolver", std::string("runge_kutta_dopri5")},
+        {"AbsoluteTolerance", 1e-6},
+        {"RelativeTolerance", 1e-6}
+    };
+    solverConfiguration["StateType"] = std::string("Eigen");
+    std::shared_ptr<IOdeStepSolver> eigenSolver = SolverFactory::CreateOdeStepSolver(solverConfiguration);
+    solverConfiguration["StateType"] = std::string("StdVector");
+    std::shared_ptr<IOdeStepSolver> stdVectorSolver = SolverFactory::CreateOdeStepSolver(solverConfiguration);
+
+    // Damped oscillator with forcing
+    std::function<std::vector<double>(std::vector<double>, double)> system = [](std::vector<double> states, double time) {
+        return std::vector<double>{states[1], -4.0 * states[0] - 0.3 * states[1] + std::sin(time)};
+    };
+
+    std::vector<double> eigenStates = {1.0, 0.0};
+    std::vector<double> stdVectorStates = {1.0, 0.0};
+    double time = 0.0;
+    double timeStep = 0.5;
+    int steps = 0;
+    while (time < 5.0)
+    {
+        timeStep = std::min(timeStep, 5.0 - time);
+        auto [isEigenAccepted, eigenNewStates, eigenTimeStep] = eigenSolver->SolveStep(system, eigenStates, time, timeStep);
+        auto [isStdVectorAccepted, stdVectorNewStates, stdVectorTimeStep] = stdVectorSolver->SolveStep(system, stdVectorStates, time, timeStep);
+
+        ASSERT_EQ(isEigenAccepted, isStdVectorAccepted);
+        ASSERT_NEAR(eigenTimeStep, stdVectorTimeStep, 1e-12);
+        ASSERT_EQ(eigenNewStates.size(), 2);
+        EXPECT_NEAR(eigenNewStates[0], stdVectorNewStates[0], 1e-12);
+        EXPECT_NEAR(eigenNewStates[1], stdVectorNewStates[1], 1e-12);
+        if (isEigenAccepted)
+        {
+            time += timeStep;
+            eigenStates = eigenNewStates;
+            stdVectorStates = stdVectorNewStates;
+            steps++;
+        }
+        timeStep = eigenTimeStep;
+    }
+    EXPECT_GT(steps, 5);
+}
+
+// Test that in-place steps write the stepped states into the given vector without reallocating it.
+TEST(SolverFactoryTest, InPlaceStepWritesIntoGivenStates) {
+    std::map<std::string, ConfigurationValue> solverConfiguration = {
+        {"Type", std::string("odeint")},
+        {"ControlledSolver", std::string("runge_kutta_dopri5")},
+        {"StateType", std::string("Eigen")},
+        {"AbsoluteTolerance", 1e-8},
+        {"RelativeTolerance", 1e-8}
+    };
+    std::shared_ptr<IOdeStepSolver> solver = SolverFactory::CreateOdeStepSolver(solverConfiguration);
+    ASSERT_TRUE(solver->IsInPlaceSystemSupported());
+
+    DecayOdeSystem system;
+    std::vector<double> states = {1.0};
+    std::vector<double> newStates = {0.0};
+    const double* newStatesData = newStates.data();
+    double time = 0.0;
+    double timeStep = 0.01;
+    for (int i = 0; i < 20; i++)
+    {
+        auto [isAccepted, suggestedTimeStep] = solver->SolveStepInPlace(system, states, time, timeStep, newStates);
+        EXPECT_EQ(newStates.data(), newStatesData);
+        if (isAccepted)
+        {
+            time += timeStep;
+            std::swap(states, newStates);
+            newStatesData = newStates.data();
+        }
+        timeStep = suggestedTimeStep;
+    }
+    EXPECT_NEAR(states[0], std::exp(-time), 1e-6);
+}
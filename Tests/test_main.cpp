@@ -1,8 +1,19 @@
 // Tests/test_main.cpp
 
 #include <gtest/gtest.h>
+#include <PySysLinkBase/SpdlogManager.h>
+
+// The library logs through the default logger, it is configured once for every test and kept silent
+class TestLoggerEnvironment : public ::testing::Environment {
+public:
+    void SetUp() override {
+        PySysLinkBase::SpdlogManager::ConfigureDefaultLogger();
+        PySysLinkBase::SpdlogManager::SetLogLevel(PySysLinkBase::LogLevel::off);
+    }
+};
 
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
+    ::testing::AddGlobalTestEnvironment(new TestLoggerEnvironment());
     return RUN_ALL_TESTS();
 }
@@ -0,0 +1,215 @@
+#include "AlgebraicLoopSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include "spdlog/spdlog.h"
+
+namespace PySysLinkBase
+{
+    namespace
+    {
+        std::string DescribeLoop(const std::vector<std::shared_ptr<ISimulationBlock>>& blocks)
+        {
+            std::string description = "";
+            for (const auto& block : blocks)
+            {
+                description += (description.empty() ? "" : ", ") + block->GetId();
+            }
+            return description;
+        }
+    }
+
+    AlgebraicLoopSolver::AlgebraicLoopSolver(std::vector<std::shared_ptr<ISimulationBlock>> loopBlocks, std::shared_ptr<SimulationModel> simulationModel, double tolerance, int maximumIterations)
+                                            : blocks(std::move(loopBlocks)), tolerance(tolerance), maximumIterations(maximumIterations)
+    {
+        if (this->blocks.empty())
+        {
+            throw std::invalid_argument("Algebraic loop without blocks");
+        }
+        if (maximumIterations < 1)
+        {
+            throw std::invalid_argument("Algebraic loops need at least one iteration, got " + std::to_string(maximumIterations));
+        }
+
+        std::unordered_map<const ISimulationBlock*, int> positionOfBlock = {};
+        for (int i = 0; i < this->blocks.size(); i++)
+        {
+            positionOfBlock.insert({this->blocks[i].get(), i});
+
+            LoopBlock loopBlock;
+            loopBlock.block = this->blocks[i];
+            loopBlock.outputPorts = this->blocks[i]->GetOutputPorts();
+            for (int j = 0; j < loopBlock.outputPorts.size(); j++)
+            {
+                loopBlock.connectedPortsOfEachOutput.push_back(simulationModel->GetConnectedPorts(this->blocks[i], j));
+            }
+            this->loopBlocks.push_back(loopBlock);
+        }
+
+        // An input is cut when its origin block is evaluated after its own block, itself included
+        std::unordered_map<const OutputPort*, int> cutSignalOfOriginPort = {};
+        for (int i = 0; i < this->blocks.size(); i++)
+        {
+            std::vector<std::shared_ptr<InputPort>> inputPorts = this->blocks[i]->GetInputPorts();
+            for (int j = 0; j < inputPorts.size(); j++)
+            {
+                std::shared_ptr<ISimulationBlock> originBlock = simulationModel->GetOriginBlock(this->blocks[i], j);
+                if (!inputPorts[j]->HasDirectFeedthrough() || !originBlock)
+                {
+                    continue;
+                }
+                auto originPosition = positionOfBlock.find(originBlock.get());
+                if (originPosition == positionOfBlock.end() || originPosition->second < i)
+                {
+                    continue;
+                }
+
+                const LoopBlock& originLoopBlock = this->loopBlocks[originPosition->second];
+                for (int k = 0; k < originLoopBlock.outputPorts.size(); k++)
+                {
+                    const std::vector<std::shared_ptr<InputPort>>& connectedPorts = originLoopBlock.connectedPortsOfEachOutput[k];
+                    if (std::find(connectedPorts.begin(), connectedPorts.end(), inputPorts[j]) == connectedPorts.end())
+                    {
+                        continue;
+                    }
+
+                    const std::shared_ptr<OutputPort>& originPort = originLoopBlock.outputPorts[k];
+                    if (originPort->GetValueReference().GetSignalTypeId() != GetSignalTypeId<double>())
+                    {
+                        throw std::invalid_argument("Algebraic loop through blocks " + DescribeLoop(this->blocks) + " is cut at output " + std::to_string(k) + " of block " +
+                                                    originBlock->GetId() + ", of type " + originPort->GetValueReference().GetTypeId() + ". Only double signals can be solved.");
+                    }
+
+                    auto cutSignal = cutSignalOfOriginPort.find(originPort.get());
+                    if (cutSignal == cutSignalOfOriginPort.end())
+                    {
+                        CutSignal newCutSignal;
+                        newCutSignal.originPort = originPort;
+                        newCutSignal.guessValue = std::make_shared<SignalValue<double>>(0.0);
+                        newCutSignal.guessPort = std::make_shared<OutputPort>(newCutSignal.guessValue);
+                        cutSignal = cutSignalOfOriginPort.insert({originPort.get(), this->cutSignals.size()}).first;
+                        this->cutSignals.push_back(newCutSignal);
+                    }
+                    this->cutSignals[cutSignal->second].cutInputPorts.push_back(inputPorts[j]);
+                    break;
+                }
+            }
+        }
+
+        int cutSignalCount = this->cutSignals.size();
+        this->cutValues = Eigen::VectorXd::Zero(cutSignalCount);
+        this->residual = Eigen::VectorXd::Zero(cutSignalCount);
+        this->perturbedResidual = Eigen::VectorXd::Zero(cutSignalCount);
+        this->jacobian = Eigen::MatrixXd::Zero(cutSignalCount, cutSignalCount);
+
+        spdlog::get("default_pysyslink")->debug("Algebraic loop through blocks {} solved on {} cut signals", DescribeLoop(this->blocks), cutSignalCount);
+    }
+
+    const std::vector<std::shared_ptr<ISimulationBlock>>& AlgebraicLoopSolver::GetBlocks() const
+    {
+        return this->blocks;
+    }
+
+    void AlgebraicLoopSolver::SetProfiler(std::shared_ptr<SimulationProfiler> profiler)
+    {
+        this->profiler = profiler;
+    }
+
+    int AlgebraicLoopSolver::GetCutSignalCount() const
+    {
+        return this->cutSignals.size();
+    }
+
+    void AlgebraicLoopSolver::ReadCutSignals(Eigen::VectorXd& values) const
+    {
+        for (int i = 0; i < this->cutSignals.size(); i++)
+        {
+            const SignalValue<double>& value = this->cutSignals[i].originPort->GetValueReference().TryCastToTypedReference<double>();
+            values[i] = value.IsInitialized() ? value.GetPayload() : 0.0;
+        }
+    }
+
+    void AlgebraicLoopSolver::EvaluateBlocks(const Eigen::VectorXd& guess, std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep)
+    {
+        for (int i = 0; i < this->cutSignals.size(); i++)
+        {
+            this->cutSignals[i].guessValue->SetPayload(guess[i]);
+            for (const auto& cutInputPort : this->cutSignals[i].cutInputPorts)
+            {
+                this->cutSignals[i].guessPort->TryCopyValueToPort(*cutInputPort);
+            }
+        }
+
+        for (const auto& loopBlock : this->loopBlocks)
+        {
+            {
+                ProfiledScope profiledScope(this->profiler.get(), *loopBlock.block);
+                loopBlock.block->ComputeOutputsOfBlock(sampleTime, currentTime, isMinorStep);
+            }
+            ProfiledScope profiledScope(this->profiler.get(), ProfiledPhase::linkPropagation);
+            for (int i = 0; i < loopBlock.outputPorts.size(); i++)
+            {
+                for (const auto& connectedPort : loopBlock.connectedPortsOfEachOutput[i])
+                {
+                    loopBlock.outputPorts[i]->TryCopyValueToPort(*connectedPort);
+                }
+            }
+        }
+    }
+
+    void AlgebraicLoopSolver::EvaluateResidual(const Eigen::VectorXd& guess, std::shared_ptr<SampleTime> sampleTime, double currentTime, Eigen::VectorXd& result)
+    {
+        this->EvaluateBlocks(guess, sampleTime, currentTime, true);
+        this->ReadCutSignals(result);
+        result -= guess;
+    }
+
+    void AlgebraicLoopSolver::Solve(std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep)
+    {
+        // The outputs of the last time hit are the first guess
+        this->ReadCutSignals(this->cutValues);
+
+        bool isConverged = false;
+        for (int iteration = 0; iteration < this->maximumIterations; iteration++)
+        {
+            this->EvaluateResidual(this->cutValues, sampleTime, currentTime, this->residual);
+            if (this->residual.lpNorm<Eigen::Infinity>() <= this->tolerance * (1.0 + this->cutValues.lpNorm<Eigen::Infinity>()))
+            {
+                isConverged = true;
+                break;
+            }
+
+            for (int j = 0; j < this->cutValues.size(); j++)
+            {
+                double unperturbedValue = this->cutValues[j];
+                double perturbation = std::sqrt(std::numeric_limits<double>::epsilon()) * std::max(1.0, std::abs(unperturbedValue));
+                this->cutValues[j] = unperturbedValue + perturbation;
+                this->EvaluateResidual(this->cutValues, sampleTime, currentTime, this->perturbedResidual);
+                this->cutValues[j] = unperturbedValue;
+                this->jacobian.col(j) = (this->perturbedResidual - this->residual) / perturbation;
+            }
+
+            Eigen::FullPivLU<Eigen::MatrixXd> jacobianDecomposition(this->jacobian);
+            if (!jacobianDecomposition.isInvertible())
+            {
+                throw std::runtime_error("Algebraic loop through blocks " + DescribeLoop(this->blocks) + " has a singular Jacobian at time " + std::to_string(currentTime));
+            }
+            this->cutValues -= jacobianDecomposition.solve(this->residual);
+        }
+
+        if (!isConverged)
+        {
+            throw std::runtime_error("Algebraic loop through blocks " + DescribeLoop(this->blocks) + " did not converge in " + std::to_string(this->maximumIterations) +
+                                     " iterations at time " + std::to_string(currentTime));
+        }
+
+        // The last residual was evaluated on the solution as a minor step, only major steps are evaluated again
+        if (!isMinorStep)
+        {
+            this->EvaluateBlocks(this->cutValues, sampleTime, currentTime, false);
+        }
+    }
+} // namespace PySysLinkBase
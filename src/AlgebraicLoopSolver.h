@@ -0,0 +1,67 @@
+#ifndef SRC_ALGEBRAIC_LOOP_SOLVER
+#define SRC_ALGEBRAIC_LOOP_SOLVER
+
+#include "SimulationModel.h"
+#include "SampleTime.h"
+#include "PortsAndSignalValues/SignalValue.h"
+#include "SimulationProfiler.h"
+
+#include <memory>
+#include <vector>
+#include <Eigen/Dense>
+
+namespace PySysLinkBase
+{
+    // Evaluates the blocks of an algebraic loop so that their outputs agree with each other at a time hit.
+    // The direct feedthrough links that reach a block before their origin block is evaluated are cut; Newton iterations
+    // on the values of the cut signals, with a finite difference Jacobian, run the blocks as minor steps until the
+    // outputs reproduce the values fed in. The blocks are then evaluated once more, as asked, on the solution.
+    class AlgebraicLoopSolver
+    {
+        public:
+        // loopBlocks in evaluation order, as they come in the execution order of the model
+        AlgebraicLoopSolver(std::vector<std::shared_ptr<ISimulationBlock>> loopBlocks, std::shared_ptr<SimulationModel> simulationModel, double tolerance, int maximumIterations);
+
+        const std::vector<std::shared_ptr<ISimulationBlock>>& GetBlocks() const;
+        int GetCutSignalCount() const;
+        void SetProfiler(std::shared_ptr<SimulationProfiler> profiler);
+
+        void Solve(std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep=false);
+
+        private:
+        struct LoopBlock
+        {
+            std::shared_ptr<ISimulationBlock> block;
+            std::vector<std::shared_ptr<OutputPort>> outputPorts;
+            std::vector<std::vector<std::shared_ptr<InputPort>>> connectedPortsOfEachOutput;
+        };
+
+        // One unknown per cut output port, shared by all the loop inputs it reaches before it is evaluated
+        struct CutSignal
+        {
+            std::shared_ptr<OutputPort> originPort;
+            std::vector<std::shared_ptr<InputPort>> cutInputPorts;
+            std::shared_ptr<SignalValue<double>> guessValue;
+            std::shared_ptr<OutputPort> guessPort;
+        };
+
+        std::vector<std::shared_ptr<ISimulationBlock>> blocks;
+        std::vector<LoopBlock> loopBlocks;
+        std::vector<CutSignal> cutSignals;
+        double tolerance;
+        int maximumIterations;
+        std::shared_ptr<SimulationProfiler> profiler;
+
+        Eigen::VectorXd cutValues;
+        Eigen::VectorXd residual;
+        Eigen::VectorXd perturbedResidual;
+        Eigen::MatrixXd jacobian;
+
+        void ReadCutSignals(Eigen::VectorXd& values) const;
+        void EvaluateBlocks(const Eigen::VectorXd& guess, std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep);
+        // Outputs of the cut signals minus the values fed in
+        void EvaluateResidual(const Eigen::VectorXd& guess, std::shared_ptr<SampleTime> sampleTime, double currentTime, Eigen::VectorXd& result);
+    };
+} // namespace PySysLinkBase
+
+#endif /* SRC_ALGEBRAIC_LOOP_SOLVER */
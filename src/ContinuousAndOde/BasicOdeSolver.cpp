@@ -1,7 +1,11 @@
 #include "BasicOdeSolver.h"
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace PySysLinkBase
 {
@@ -20,16 +24,27 @@ namespace PySysLinkBase
         for (auto& block : this->simulationBlocks)
         {
             std::shared_ptr<ISimulationBlockWithContinuousStates> blockWithContinuousStates = std::dynamic_pointer_cast<ISimulationBlockWithContinuousStates>(block);
-            if (std::dynamic_pointer_cast<ISimulationBlockWithContinuousStates>(block))
+            if (blockWithContinuousStates)
             {
-                this->continuousStatesInEachBlock.push_back(blockWithContinuousStates->GetContinuousStates().size());
-                this->totalStates += blockWithContinuousStates->GetContinuousStates().size();
+                int stateCount = blockWithContinuousStates->GetContinuousStateCount();
+                this->continuousStatesOfBlocks.push_back({blockWithContinuousStates, this->totalStates, stateCount});
+                this->continuousStatesInEachBlock.push_back(stateCount);
+                this->totalStates += stateCount;
             }
             else
             {
                 this->continuousStatesInEachBlock.push_back(0);
             }
 
+            OutputsOfBlock outputsOfBlock;
+            outputsOfBlock.block = block;
+            outputsOfBlock.outputPorts = block->GetOutputPorts();
+            for (int j = 0; j < outputsOfBlock.outputPorts.size(); j++)
+            {
+                outputsOfBlock.connectedPortsOfEachOutput.push_back(this->simulationModel->GetConnectedPorts(block, j));
+            }
+            this->outputsOfBlocks.push_back(std::move(outputsOfBlock));
+
             std::vector<double> knownEvents_i = block->GetKnownEvents(block->GetSampleTime(), simulationOptions->startTime, simulationOptions->stopTime);
             for (const auto& event : knownEvents_i)
             {
@@ -45,113 +60,296 @@ namespace PySysLinkBase
         std::sort(std::begin(this->knownTimeHits), std::end(this->knownTimeHits));
 
         this->nextTimeHitStates = {};
-    }
 
-    void BasicOdeSolver::ComputeMinorOutputs(std::shared_ptr<SampleTime> sampleTime, double currentTime)
-    {
-        for (auto& block : this->simulationBlocks)
+        int largestBlockStateCount = 0;
+        for (const auto& continuousStatesOfBlock : this->continuousStatesOfBlocks)
         {
-            this->ComputeBlockOutputs(block, sampleTime, currentTime, true);
+            largestBlockStateCount = std::max(largestBlockStateCount, continuousStatesOfBlock.stateCount);
         }
+        this->stateBuffer = std::vector<double>(this->totalStates, 0.0);
+        this->derivativeBuffer = std::vector<double>(this->totalStates, 0.0);
+        this->stepInitialStates = std::vector<double>(this->totalStates, 0.0);
+        this->eventResolutionStates = std::vector<double>(this->totalStates, 0.0);
+        this->jacobianOriginalStates = std::vector<double>(this->totalStates, 0.0);
+        this->jacobianOriginalDerivatives = std::vector<double>(this->totalStates, 0.0);
+        this->jacobianPerturbedStates = std::vector<double>(this->totalStates, 0.0);
+        this->jacobianPerturbations = std::vector<double>(this->totalStates, 0.0);
+        this->blockJacobianBuffer = std::vector<double>(largestBlockStateCount * largestBlockStateCount, 0.0);
+        this->sparseJacobian = Eigen::SparseMatrix<double>(this->totalStates, this->totalStates);
+
+        this->BuildJacobianSparsity();
     }
 
-    void BasicOdeSolver::ComputeMajorOutputs(double currentTime)
+    void BasicOdeSolver::BuildJacobianSparsity()
     {
-        for (auto& block : this->simulationBlocks)
+        std::unordered_map<const ISimulationBlock*, int> indexOfBlock;
+        for (int i = 0; i < this->simulationBlocks.size(); i++)
         {
-            this->ComputeBlockOutputs(block, this->sampleTime, currentTime, false);
+            indexOfBlock.insert({this->simulationBlocks[i].get(), i});
+        }
+        std::unordered_map<const ISimulationBlock*, int> continuousStatesOfBlockIndex;
+        for (int i = 0; i < this->continuousStatesOfBlocks.size(); i++)
+        {
+            continuousStatesOfBlockIndex.insert({this->continuousStatesOfBlocks[i].block.get(), i});
         }
-    }
 
-    std::vector<double> BasicOdeSolver::GetStates()
-    {
-        std::vector<double> states(this->totalStates, 0.0);
+        // Every row a column changes, and those not given analytically
+        std::vector<std::vector<int>> rowsOfEachColumn(this->totalStates);
+        this->finiteDifferenceRowsOfEachColumn = std::vector<std::vector<int>>(this->totalStates);
+        for (auto& continuousStatesOfBlock : this->continuousStatesOfBlocks)
+        {
+            // Blocks reached by the outputs of this block within the group, going on through direct feedthrough inputs only
+            std::vector<char> isBlockReached(this->simulationBlocks.size(), 0);
+            std::vector<char> isBlockExpanded(this->simulationBlocks.size(), 0);
+            std::vector<std::shared_ptr<ISimulationBlock>> blocksToExpand = {continuousStatesOfBlock.block};
+            while (!blocksToExpand.empty())
+            {
+                std::shared_ptr<ISimulationBlock> block = blocksToExpand.back();
+                blocksToExpand.pop_back();
+                for (int j = 0; j < block->GetOutputPorts().size(); j++)
+                {
+                    auto [connectedBlocks, connectedPortIndexes] = this->simulationModel->GetConnectedBlocks(block, j);
+                    for (int k = 0; k < connectedBlocks.size(); k++)
+                    {
+                        auto it = indexOfBlock.find(connectedBlocks[k].get());
+                        if (it == indexOfBlock.end())
+                        {
+                            continue;
+                        }
+                        isBlockReached[it->second] = 1;
+                        if (!isBlockExpanded[it->second] && connectedBlocks[k]->GetInputPorts()[connectedPortIndexes[k]]->HasDirectFeedthrough())
+                        {
+                            isBlockExpanded[it->second] = 1;
+                            blocksToExpand.push_back(connectedBlocks[k]);
+                        }
+                    }
+                }
+            }
 
-        int i = 0;
-        int currentIndex = 0;
-        for (auto& block : this->simulationBlocks)
+            bool isOwnInputReached = isBlockReached[indexOfBlock.at(continuousStatesOfBlock.block.get())];
+            continuousStatesOfBlock.useAnalyticalJacobian = continuousStatesOfBlock.block->HasContinuousStateJacobian() && !isOwnInputReached;
+
+            std::vector<int> rows = {};
+            std::vector<int> finiteDifferenceRows = {};
+            for (const auto& otherContinuousStatesOfBlock : this->continuousStatesOfBlocks)
+            {
+                bool isOwnBlock = otherContinuousStatesOfBlock.block == continuousStatesOfBlock.block;
+                if (isBlockReached[indexOfBlock.at(otherContinuousStatesOfBlock.block.get())] || isOwnBlock)
+                {
+                    for (int r = 0; r < otherContinuousStatesOfBlock.stateCount; r++)
+                    {
+                        rows.push_back(otherContinuousStatesOfBlock.offset + r);
+                        if (!(isOwnBlock && continuousStatesOfBlock.useAnalyticalJacobian))
+                        {
+                            finiteDifferenceRows.push_back(otherContinuousStatesOfBlock.offset + r);
+                        }
+                    }
+                }
+            }
+            for (int c = 0; c < continuousStatesOfBlock.stateCount; c++)
+            {
+                rowsOfEachColumn[continuousStatesOfBlock.offset + c] = rows;
+                this->finiteDifferenceRowsOfEachColumn[continuousStatesOfBlock.offset + c] = finiteDifferenceRows;
+            }
+        }
+
+        // Greedy column grouping: a column joins the first group whose rows it does not overlap.
+        // Rows given analytically count too, perturbing a column still changes them.
+        this->jacobianColumnGroups = {};
+        std::vector<std::vector<char>> isRowUsedByGroup = {};
+        for (int c = 0; c < this->totalStates; c++)
         {
-            std::shared_ptr<ISimulationBlockWithContinuousStates> blockWithContinuousStates = std::dynamic_pointer_cast<ISimulationBlockWithContinuousStates>(block);
-            if (blockWithContinuousStates)
+            if (this->finiteDifferenceRowsOfEachColumn[c].empty())
             {
-                std::vector<double> states_i = blockWithContinuousStates->GetContinuousStates();
-                for (int j = 0; j < states_i.size(); j++)
+                continue;
+            }
+            const std::vector<int>& rows = rowsOfEachColumn[c];
+            int selectedGroup = -1;
+            for (int g = 0; g < this->jacobianColumnGroups.size() && selectedGroup == -1; g++)
+            {
+                bool isOverlapping = false;
+                for (int r : rows)
                 {
-                    states[currentIndex] = states_i[j];
-                    currentIndex++;
+                    if (isRowUsedByGroup[g][r])
+                    {
+                        isOverlapping = true;
+                        break;
+                    }
                 }
+                if (!isOverlapping)
+                {
+                    selectedGroup = g;
+                }
+            }
+            if (selectedGroup == -1)
+            {
+                selectedGroup = this->jacobianColumnGroups.size();
+                this->jacobianColumnGroups.push_back({});
+                isRowUsedByGroup.push_back(std::vector<char>(this->totalStates, 0));
+            }
+            this->jacobianColumnGroups[selectedGroup].push_back(c);
+            for (int r : rows)
+            {
+                isRowUsedByGroup[selectedGroup][r] = 1;
             }
+        }
 
-            i += 1;
+        spdlog::get("default_pysyslink")->debug("Jacobian of {} states evaluated with {} finite difference groups", this->totalStates, this->jacobianColumnGroups.size());
+    }
+
+    void BasicOdeSolver::ComputeMinorOutputs(std::shared_ptr<SampleTime> sampleTime, double currentTime)
+    {
+        for (const auto& outputsOfBlock : this->outputsOfBlocks)
+        {
+            this->ComputeBlockOutputs(outputsOfBlock, sampleTime, currentTime, true);
         }
-        
-        return states;
     }
 
-    std::vector<double> BasicOdeSolver::GetDerivatives(std::shared_ptr<SampleTime> sampleTime, double currentTime)
+    void BasicOdeSolver::SetAlgebraicLoopSolvers(const std::vector<std::shared_ptr<AlgebraicLoopSolver>>& algebraicLoopSolvers)
     {
-        std::vector<double> derivatives(this->totalStates, 0.0);
+        std::unordered_set<const ISimulationBlock*> blocksOfGroup = {};
+        for (const auto& block : this->simulationBlocks)
+        {
+            blocksOfGroup.insert(block.get());
+        }
 
-        int i = 0;
-        int currentIndex = 0;
-        for (auto& block : this->simulationBlocks)
+        std::unordered_map<const ISimulationBlock*, std::shared_ptr<AlgebraicLoopSolver>> algebraicLoopSolverOfEachBlock = {};
+        for (const auto& algebraicLoopSolver : algebraicLoopSolvers)
         {
-            std::shared_ptr<ISimulationBlockWithContinuousStates> blockWithContinuousStates = std::dynamic_pointer_cast<ISimulationBlockWithContinuousStates>(block);
-            if (blockWithContinuousStates)
+            for (const auto& block : algebraicLoopSolver->GetBlocks())
             {
-                std::vector<double> derivatives_i = blockWithContinuousStates->GetContinuousStateDerivatives(sampleTime, currentTime);
-                for (int j = 0; j < derivatives_i.size(); j++)
+                if (blocksOfGroup.count(block.get()))
                 {
-                    derivatives[currentIndex] = derivatives_i[j];
-                    currentIndex++;
+                    algebraicLoopSolverOfEachBlock.insert({block.get(), algebraicLoopSolver});
                 }
             }
+        }
 
-            i += 1;
+        for (auto& outputsOfBlock : this->outputsOfBlocks)
+        {
+            auto algebraicLoopSolver = algebraicLoopSolverOfEachBlock.find(outputsOfBlock.block.get());
+            if (algebraicLoopSolver == algebraicLoopSolverOfEachBlock.end())
+            {
+                outputsOfBlock.algebraicLoopSolver = nullptr;
+                outputsOfBlock.isAlgebraicLoopSolvedHere = false;
+                continue;
+            }
+            outputsOfBlock.algebraicLoopSolver = algebraicLoopSolver->second;
+            outputsOfBlock.isAlgebraicLoopSolvedHere = algebraicLoopSolver->second->GetBlocks().front() == outputsOfBlock.block;
         }
+    }
 
-        return derivatives;
+    void BasicOdeSolver::SetProfiler(std::shared_ptr<SimulationProfiler> profiler)
+    {
+        this->profiler = profiler;
     }
 
+    void BasicOdeSolver::ComputeMajorOutputs(double currentTime)
+    {
+        for (const auto& outputsOfBlock : this->outputsOfBlocks)
+        {
+            this->ComputeBlockOutputs(outputsOfBlock, this->sampleTime, currentTime, false);
+        }
+    }
 
+    const std::vector<double>& BasicOdeSolver::GetStates()
+    {
+        for (const auto& continuousStatesOfBlock : this->continuousStatesOfBlocks)
+        {
+            continuousStatesOfBlock.block->CopyContinuousStatesTo(this->stateBuffer.data() + continuousStatesOfBlock.offset, continuousStatesOfBlock.stateCount);
+        }
+        return this->stateBuffer;
+    }
 
-    std::vector<std::vector<double>> BasicOdeSolver::GetJacobian(std::shared_ptr<SampleTime> sampleTime, double currentTime)
+    const std::vector<double>& BasicOdeSolver::GetDerivatives(std::shared_ptr<SampleTime> sampleTime, double currentTime)
     {
-        std::vector<std::vector<double>> jacobian(this->totalStates, std::vector<double>(this->totalStates, 0.0));
+        for (const auto& continuousStatesOfBlock : this->continuousStatesOfBlocks)
+        {
+            continuousStatesOfBlock.block->CopyContinuousStateDerivativesTo(sampleTime, currentTime, this->derivativeBuffer.data() + continuousStatesOfBlock.offset, continuousStatesOfBlock.stateCount);
+        }
+        return this->derivativeBuffer;
+    }
 
-        std::vector<double> originalDerivatives = this->GetDerivatives(sampleTime, currentTime);
-        std::vector<double> originalStates = this->GetStates();
 
 
+    std::vector<std::vector<double>> BasicOdeSolver::GetJacobian(std::shared_ptr<SampleTime> sampleTime, double currentTime)
+    {
+        Eigen::MatrixXd denseJacobian = Eigen::MatrixXd(this->GetSparseJacobian(sampleTime, currentTime));
+
+        std::vector<std::vector<double>> jacobian(this->totalStates, std::vector<double>(this->totalStates, 0.0));
         for (int i = 0; i < this->totalStates; i++)
         {
-            std::vector<double> states = originalStates;
-            double insertedPerturbation;
-            if (states[i] == 0.0)
+            for (int j = 0; j < this->totalStates; j++)
             {
-                insertedPerturbation = 1e-6;
-                states[i] = insertedPerturbation;
+                jacobian[i][j] = denseJacobian(i, j);
             }
-            else
+        }
+        return jacobian;
+    }
+
+    const Eigen::SparseMatrix<double>& BasicOdeSolver::GetSparseJacobian(std::shared_ptr<SampleTime> sampleTime, double currentTime)
+    {
+        this->jacobianEntries.clear();
+
+        for (const auto& continuousStatesOfBlock : this->continuousStatesOfBlocks)
+        {
+            if (continuousStatesOfBlock.useAnalyticalJacobian)
             {
-                insertedPerturbation = states[i] * 0.01;
-                states[i] += insertedPerturbation;
+                const int stateCount = continuousStatesOfBlock.stateCount;
+                std::fill(this->blockJacobianBuffer.begin(), this->blockJacobianBuffer.begin() + stateCount * stateCount, 0.0);
+                continuousStatesOfBlock.block->CopyContinuousStateJacobianTo(sampleTime, currentTime, this->blockJacobianBuffer.data(), stateCount);
+                for (int i = 0; i < stateCount; i++)
+                {
+                    for (int j = 0; j < stateCount; j++)
+                    {
+                        this->jacobianEntries.emplace_back(continuousStatesOfBlock.offset + i, continuousStatesOfBlock.offset + j, this->blockJacobianBuffer[i * stateCount + j]);
+                    }
+                }
             }
+        }
 
-            this->SetStates(states);
-            this->ComputeMinorOutputs(sampleTime, currentTime);
-            std::vector<double> derivativesPerturbed = this->GetDerivatives(sampleTime, currentTime);
+        if (!this->jacobianColumnGroups.empty())
+        {
+            this->jacobianOriginalDerivatives = this->GetDerivatives(sampleTime, currentTime);
+            this->jacobianOriginalStates = this->GetStates();
 
-            for (int j = 0; j < this->totalStates; j++)
+            for (const std::vector<int>& columnGroup : this->jacobianColumnGroups)
             {
-                jacobian[j][i] = (derivativesPerturbed[j] - originalDerivatives[j]) / insertedPerturbation;
+                this->jacobianPerturbedStates = this->jacobianOriginalStates;
+                for (int i : columnGroup)
+                {
+                    if (this->jacobianPerturbedStates[i] == 0.0)
+                    {
+                        this->jacobianPerturbations[i] = 1e-6;
+                        this->jacobianPerturbedStates[i] = this->jacobianPerturbations[i];
+                    }
+                    else
+                    {
+                        this->jacobianPerturbations[i] = this->jacobianPerturbedStates[i] * 0.01;
+                        this->jacobianPerturbedStates[i] += this->jacobianPerturbations[i];
+                    }
+                }
+
+                this->SetStates(this->jacobianPerturbedStates);
+                this->ComputeMinorOutputs(sampleTime, currentTime);
+                const std::vector<double>& derivativesPerturbed = this->GetDerivatives(sampleTime, currentTime);
+
+                for (int i : columnGroup)
+                {
+                    for (int j : this->finiteDifferenceRowsOfEachColumn[i])
+                    {
+                        this->jacobianEntries.emplace_back(j, i, (derivativesPerturbed[j] - this->jacobianOriginalDerivatives[j]) / this->jacobianPerturbations[i]);
+                    }
+                }
             }
+            this->SetStates(this->jacobianOriginalStates);
         }
-        this->SetStates(originalStates);
-        return jacobian;
+
+        this->sparseJacobian.setFromTriplets(this->jacobianEntries.begin(), this->jacobianEntries.end());
+        return this->sparseJacobian;
     }
 
-    const std::vector<std::pair<double, double>> BasicOdeSolver::GetEvents(const std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double eventTime, std::vector<double> eventTimeStates) const
+    const std::vector<std::pair<double, double>> BasicOdeSolver::GetEvents(const std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double eventTime, const std::vector<double>& eventTimeStates) const
     {
         spdlog::get("default_pysyslink")->debug("Looking for events...");
         std::vector<std::pair<double, double>> events = {};
@@ -175,52 +373,81 @@ namespace PySysLinkBase
         return events;
     }
 
-    void BasicOdeSolver::SetStates(std::vector<double> newStates)
+    void BasicOdeSolver::SetStates(const std::vector<double>& newStates)
     {
-        int currentIndex = 0;
-        int i = 0;
-        for (auto& block : this->simulationBlocks)
+        if (newStates.size() != this->totalStates)
         {
-            std::shared_ptr<ISimulationBlockWithContinuousStates> blockWithContinuousStates = std::dynamic_pointer_cast<ISimulationBlockWithContinuousStates>(block);
-            if (blockWithContinuousStates)
-            {
-                std::vector<double>::const_iterator first = newStates.begin() + currentIndex;
-                std::vector<double>::const_iterator last = newStates.begin() + currentIndex + this->continuousStatesInEachBlock[i];
-                std::vector<double> newStates_i(first, last);
-                blockWithContinuousStates->SetContinuousStates(newStates_i);
-
-                currentIndex += this->continuousStatesInEachBlock[i];
-            }
-
-            i += 1;
+            throw std::length_error("Continuous sample time group has " + std::to_string(this->totalStates) + " states, " + std::to_string(newStates.size()) + " were given");
+        }
+        for (const auto& continuousStatesOfBlock : this->continuousStatesOfBlocks)
+        {
+            continuousStatesOfBlock.block->SetContinuousStatesFrom(newStates.data() + continuousStatesOfBlock.offset, continuousStatesOfBlock.stateCount);
         }
     }
 
 
-    void BasicOdeSolver::ComputeBlockOutputs(std::shared_ptr<ISimulationBlock> block, std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep)
+    void BasicOdeSolver::ComputeBlockOutputs(const OutputsOfBlock& outputsOfBlock, std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep)
     {
-        block->ComputeOutputsOfBlock(sampleTime, currentTime, isMinorStep);
-        for (int i = 0; i < block->GetOutputPorts().size(); i++)
+        if (outputsOfBlock.algebraicLoopSolver)
+        {
+            if (outputsOfBlock.isAlgebraicLoopSolvedHere)
+            {
+                outputsOfBlock.algebraicLoopSolver->Solve(sampleTime, currentTime, isMinorStep);
+            }
+            return;
+        }
+
+        {
+            ProfiledScope profiledScope(this->profiler.get(), *outputsOfBlock.block);
+            outputsOfBlock.block->ComputeOutputsOfBlock(sampleTime, currentTime, isMinorStep);
+        }
+        ProfiledScope profiledScope(this->profiler.get(), ProfiledPhase::linkPropagation);
+        for (int i = 0; i < outputsOfBlock.outputPorts.size(); i++)
         {
-            for (auto& connectedPort : simulationModel->GetConnectedPorts(block, i))
+            for (const auto& connectedPort : outputsOfBlock.connectedPortsOfEachOutput[i])
             {
-                block->GetOutputPorts()[i]->TryCopyValueToPort(*connectedPort);
+                outputsOfBlock.outputPorts[i]->TryCopyValueToPort(*connectedPort);
             }
         }
     }
 
-    std::vector<double> BasicOdeSolver::SystemModel(std::vector<double> states, double time)
+    const std::vector<double>& BasicOdeSolver::SystemModel(const std::vector<double>& states, double time)
     {
+        ProfiledScope profiledScope(this->profiler.get(), ProfiledPhase::odeRightHandSide);
         this->SetStates(states);
         this->ComputeMinorOutputs(this->sampleTime, time);
         return this->GetDerivatives(this->sampleTime, time);
     }
     
-    std::vector<std::vector<double>> BasicOdeSolver::SystemModelJacobian(std::vector<double> states, double time)
+    int BasicOdeSolver::GetStateCount() const
+    {
+        return this->totalStates;
+    }
+
+    void BasicOdeSolver::EvaluateDerivatives(const double* states, double* derivatives, double time)
+    {
+        ProfiledScope profiledScope(this->profiler.get(), ProfiledPhase::odeRightHandSide);
+        for (const auto& continuousStatesOfBlock : this->continuousStatesOfBlocks)
+        {
+            continuousStatesOfBlock.block->SetContinuousStatesFrom(states + continuousStatesOfBlock.offset, continuousStatesOfBlock.stateCount);
+        }
+        this->ComputeMinorOutputs(this->sampleTime, time);
+        for (const auto& continuousStatesOfBlock : this->continuousStatesOfBlocks)
+        {
+            continuousStatesOfBlock.block->CopyContinuousStateDerivativesTo(this->sampleTime, time, derivatives + continuousStatesOfBlock.offset, continuousStatesOfBlock.stateCount);
+        }
+    }
+
+    std::vector<std::vector<double>> BasicOdeSolver::SystemModelJacobian(const std::vector<double>& states, double time)
     {
         return this->GetJacobian(this->sampleTime, time);
     }
 
+    const Eigen::SparseMatrix<double>& BasicOdeSolver::SystemModelSparseJacobian(const std::vector<double>& states, double time)
+    {
+        return this->GetSparseJacobian(this->sampleTime, time);
+    }
+
     void BasicOdeSolver::UpdateStatesToNextTimeHits()
     {
         if (this->nextTimeHitStates.size() != 0)
@@ -229,35 +456,59 @@ namespace PySysLinkBase
         }
     }
 
-    std::tuple<bool, std::vector<double>, double> BasicOdeSolver::OdeStepSolverStep(std::function<std::vector<double>(std::vector<double>, double)> systemLambda, 
-                                            std::function<std::vector<std::vector<double>>(std::vector<double>, double)> systemJacobianLambda,
-                                            std::vector<double> states_0, double currentTime, double timeStep)
+    std::pair<bool, double> BasicOdeSolver::OdeStepSolverStep(const std::function<std::vector<double>(std::vector<double>, double)>& systemLambda, 
+                                            const std::function<std::vector<std::vector<double>>(std::vector<double>, double)>& systemJacobianLambda,
+                                            const std::function<Eigen::SparseMatrix<double>(std::vector<double>, double)>& systemSparseJacobianLambda,
+                                            const std::vector<double>& states_0, double currentTime, double timeStep, std::vector<double>& newStates)
     {
-        std::tuple<bool, std::vector<double>, double> result;
-        if (this->odeStepSolver->IsJacobianNeeded())
+        std::pair<bool, double> result;
+        if (this->odeStepSolver->IsInPlaceSystemSupported())
         {
-            spdlog::get("default_pysyslink")->debug("Jacobian needed");
-            result = this->odeStepSolver->SolveStep(systemLambda, systemJacobianLambda, this->GetStates(), currentTime, timeStep);
+            result = this->odeStepSolver->SolveStepInPlace(*this, states_0, currentTime, timeStep, newStates);
         }
         else
         {
-            spdlog::get("default_pysyslink")->debug("Jacobian not needed");
-            result = this->odeStepSolver->SolveStep(systemLambda, this->GetStates(), currentTime, timeStep);
+            std::tuple<bool, std::vector<double>, double> stepResult;
+            if (this->odeStepSolver->IsJacobianNeeded() && this->odeStepSolver->IsSparseJacobianSupported())
+            {
+                spdlog::get("default_pysyslink")->debug("Sparse Jacobian needed");
+                stepResult = this->odeStepSolver->SolveStepWithSparseJacobian(systemLambda, systemSparseJacobianLambda, states_0, currentTime, timeStep);
+            }
+            else if (this->odeStepSolver->IsJacobianNeeded())
+            {
+                spdlog::get("default_pysyslink")->debug("Jacobian needed");
+                stepResult = this->odeStepSolver->SolveStep(systemLambda, systemJacobianLambda, states_0, currentTime, timeStep);
+            }
+            else
+            {
+                spdlog::get("default_pysyslink")->debug("Jacobian not needed");
+                stepResult = this->odeStepSolver->SolveStep(systemLambda, states_0, currentTime, timeStep);
+            }
+            newStates = std::move(std::get<1>(stepResult));
+            result = {std::get<0>(stepResult), std::get<2>(stepResult)};
         }
+
+        // Step solvers leave the blocks at their last evaluated states; only the states are put back here,
+        // block outputs are computed again by the next major pass
+        this->SetStates(states_0);
         return result;
     }
 
 
     void BasicOdeSolver::DoStep(double currentTime, double timeStep)
     {
-        auto systemLambda = [this](std::vector<double> states, double time) {
+        std::function<std::vector<double>(std::vector<double>, double)> systemLambda = [this](const std::vector<double>& states, double time) {
             return this->SystemModel(states, time);
         };
 
-        auto systemJacobianLambda = [this](std::vector<double> states, double time) {
+        std::function<std::vector<std::vector<double>>(std::vector<double>, double)> systemJacobianLambda = [this](const std::vector<double>& states, double time) {
             return this->SystemModelJacobian(states, time);
         };
 
+        std::function<Eigen::SparseMatrix<double>(std::vector<double>, double)> systemSparseJacobianLambda = [this](const std::vector<double>& states, double time) {
+            return this->SystemModelSparseJacobian(states, time);
+        };
+
         this->UpdateStatesToNextTimeHits();
 
         spdlog::get("default_pysyslink")->debug("Requested step size in time {}: {}", currentTime, timeStep);
@@ -282,84 +533,159 @@ namespace PySysLinkBase
             spdlog::get("default_pysyslink")->debug("Looks like last iteration");
         }
 
-        std::vector<std::pair<double, double>> initialEvents = this->GetEvents(this->sampleTime, currentTime, this->GetStates());
+        // States at the start of the step are gathered once, every retry and event resolution starts from them
+        this->stepInitialStates = this->GetStates();
+        std::vector<std::pair<double, double>> initialEvents = this->GetEvents(this->sampleTime, currentTime, this->stepInitialStates);
         
         double appliedTimeStep = timeStep;
 
-        std::tuple<bool, std::vector<double>, double> result = this->OdeStepSolverStep(systemLambda, systemJacobianLambda, this->GetStates(), currentTime, appliedTimeStep);
+        // Stepped states are written straight into the states of the next time hit
+        std::pair<bool, double> result = this->OdeStepSolverStep(systemLambda, systemJacobianLambda, systemSparseJacobianLambda, this->stepInitialStates, currentTime, appliedTimeStep, this->nextTimeHitStates);
 
         spdlog::get("default_pysyslink")->debug("Step solver result done");
 
-        double newSuggestedTimeStep = std::get<2>(result);
-        while (!std::get<0>(result))
+        double newSuggestedTimeStep = result.second;
+        while (!result.first)
         {
             spdlog::get("default_pysyslink")->debug("Step with size: {} rejected, trying new suggested step size; {}", appliedTimeStep, newSuggestedTimeStep);
+            if (this->profiler)
+            {
+                this->profiler->CountRejectedStep();
+            }
             appliedTimeStep = newSuggestedTimeStep;
-            result = this->OdeStepSolverStep(systemLambda, systemJacobianLambda, this->GetStates(), currentTime, newSuggestedTimeStep);
-            newSuggestedTimeStep = std::get<2>(result);
+            result = this->OdeStepSolverStep(systemLambda, systemJacobianLambda, systemSparseJacobianLambda, this->stepInitialStates, currentTime, newSuggestedTimeStep, this->nextTimeHitStates);
+            newSuggestedTimeStep = result.second;
         }
 
-        this->nextTimeHitStates = std::get<1>(result);
-
         if (this->activateEvents)
         {
-            std::vector<std::pair<double, double>> currentEvents = this->GetEvents(this->sampleTime, currentTime + appliedTimeStep, nextTimeHitStates);
-            bool isThereEvent = false;
-            for (int i = 0; i < currentEvents.size(); i++)
+            if (this->IsThereEvent(initialEvents, currentTime + appliedTimeStep, this->nextTimeHitStates))
             {
-                spdlog::get("default_pysyslink")->debug("Current event {}: {}", i, currentEvents[i].first);
-                spdlog::get("default_pysyslink")->debug("Initial event {}: {}", i, initialEvents[i].first);
-                if ((initialEvents[i].first < 0) != (currentEvents[i].first < 0))
+                spdlog::get("default_pysyslink")->debug("Event happened on interval {} - {}", currentTime, currentTime + appliedTimeStep);
+
+                double eventTime = this->LocateEvent(initialEvents, currentTime, this->stepInitialStates, currentTime + appliedTimeStep, this->nextTimeHitStates);
+                auto eventResolutionTimeResult = this->OdeStepSolverStep(systemLambda, systemJacobianLambda, systemSparseJacobianLambda, this->stepInitialStates, currentTime, eventTime - currentTime, this->eventResolutionStates);
+
+                // The interpolant and the integrated states may disagree slightly, the located time is moved forward until both have crossed
+                double eventTimeIncrement = this->eventTolerance;
+                while (eventTime < currentTime + appliedTimeStep && !this->IsThereEvent(initialEvents, eventTime, this->eventResolutionStates))
                 {
-                    isThereEvent = true;
+                    eventTime = std::min(currentTime + appliedTimeStep, eventTime + eventTimeIncrement);
+                    eventTimeIncrement *= 2;
+                    eventResolutionTimeResult = this->OdeStepSolverStep(systemLambda, systemJacobianLambda, systemSparseJacobianLambda, this->stepInitialStates, currentTime, eventTime - currentTime, this->eventResolutionStates);
                 }
+
+                appliedTimeStep = eventTime - currentTime;
+                std::swap(this->nextTimeHitStates, this->eventResolutionStates);
+                newSuggestedTimeStep = eventResolutionTimeResult.second;
+
+                spdlog::get("default_pysyslink")->debug("Event resolved, new time hit: {}", eventTime);
             }
+        }
+        spdlog::get("default_pysyslink")->debug("Applied step size in time {}: {}", currentTime, appliedTimeStep);
 
-            if (isThereEvent)
+        this->nextSuggestedTimeStep = newSuggestedTimeStep;
+        this->nextUnknownTimeHit = currentTime + appliedTimeStep;
+    }
+
+    bool BasicOdeSolver::IsThereEvent(const std::vector<std::pair<double, double>>& initialEvents, double eventTime, const std::vector<double>& eventTimeStates) const
+    {
+        std::vector<std::pair<double, double>> currentEvents = this->GetEvents(this->sampleTime, eventTime, eventTimeStates);
+        bool isThereEvent = false;
+        for (int i = 0; i < currentEvents.size(); i++)
+        {
+            spdlog::get("default_pysyslink")->debug("Current event {}: {}", i, currentEvents[i].first);
+            spdlog::get("default_pysyslink")->debug("Initial event {}: {}", i, initialEvents[i].first);
+            if ((initialEvents[i].first < 0) != (currentEvents[i].first < 0))
             {
-                double t_1 = currentTime;
-                double t_2 = currentTime + appliedTimeStep;
-                spdlog::get("default_pysyslink")->debug("Event happened on interval {} - {}", t_1, t_2);
+                isThereEvent = true;
+            }
+        }
+        return isThereEvent;
+    }
 
-                while ((t_2 - t_1) > this->eventTolerance)
-                {
-                    auto currentIntervalCenterResult = this->OdeStepSolverStep(systemLambda, systemJacobianLambda, this->GetStates(), currentTime, (t_2+t_1)/2 - currentTime);
+    double BasicOdeSolver::LocateEvent(const std::vector<std::pair<double, double>>& initialEvents, double time_0, const std::vector<double>& states_0,
+                                        double time_1, const std::vector<double>& states_1)
+    {
+        // Cubic Hermite interpolant of the step, the event functions are root-found on it instead of integrating again
+        std::vector<double> derivatives_1 = this->SystemModel(states_1, time_1);
+        std::vector<double> derivatives_0 = this->SystemModel(states_0, time_0);
+        double timeStep = time_1 - time_0;
+        auto interpolatedStates = [&](double time)
+        {
+            double theta = (time - time_0) / timeStep;
+            double theta2 = theta * theta;
+            double theta3 = theta2 * theta;
+            double h00 = 2 * theta3 - 3 * theta2 + 1;
+            double h10 = theta3 - 2 * theta2 + theta;
+            double h01 = -2 * theta3 + 3 * theta2;
+            double h11 = theta3 - theta2;
+            std::vector<double> states(states_0.size());
+            for (int i = 0; i < states.size(); i++)
+            {
+                states[i] = h00 * states_0[i] + h10 * timeStep * derivatives_0[i] + h01 * states_1[i] + h11 * timeStep * derivatives_1[i];
+            }
+            return states;
+        };
 
-                    std::vector<std::pair<double, double>> currentIntervalCenterEvents = this->GetEvents(this->sampleTime, (t_2+t_1)/2, std::get<1>(currentIntervalCenterResult));
-                    bool isThereEventInCurrentIntervalHalf = false;
-                    for (int i = 0; i < currentIntervalCenterEvents.size(); i++)
-                    {
-                        spdlog::get("default_pysyslink")->debug("Initial event i: {}. Current event i: {}", initialEvents[i].first, currentIntervalCenterEvents[i].first);
-                        if ((initialEvents[i].first < 0) != (currentIntervalCenterEvents[i].first < 0))
-                        {
-                            isThereEventInCurrentIntervalHalf = true;
-                        }
-                    }
-                    if (isThereEventInCurrentIntervalHalf)
+        std::vector<std::pair<double, double>> finalEvents = this->GetEvents(this->sampleTime, time_1, states_1);
+        double eventTime = time_1;
+        for (int i = 0; i < finalEvents.size(); i++)
+        {
+            if ((initialEvents[i].first < 0) == (finalEvents[i].first < 0))
+            {
+                continue;
+            }
+
+            // Illinois variant of regula falsi; the right end of the bracket always has the event already crossed
+            double t_1 = time_0;
+            double g_1 = initialEvents[i].first;
+            double t_2 = std::min(time_1, eventTime);
+            double g_2 = t_2 == time_1 ? finalEvents[i].first : this->GetEvents(this->sampleTime, t_2, interpolatedStates(t_2))[i].first;
+            if ((g_1 < 0) == (g_2 < 0))
+            {
+                // Crosses only after an earlier event already located
+                continue;
+            }
+            int retainedSide = 0;
+            int iteration = 0;
+            for (; iteration < 100 && (t_2 - t_1) > this->eventTolerance; iteration++)
+            {
+                double t_c = (g_2 != g_1) ? (t_1 * g_2 - t_2 * g_1) / (g_2 - g_1) : (t_1 + t_2) / 2;
+                if (!(t_c > t_1 && t_c < t_2))
+                {
+                    t_c = (t_1 + t_2) / 2;
+                }
+                double g_c = this->GetEvents(this->sampleTime, t_c, interpolatedStates(t_c))[i].first;
+                if ((g_c < 0) == (initialEvents[i].first < 0))
+                {
+                    t_1 = t_c;
+                    g_1 = g_c;
+                    if (retainedSide == 1)
                     {
-                        spdlog::get("default_pysyslink")->debug("Event happened on interval {} - {}, reduce t_2 in {}", t_1, (t_2+t_1)/2, (t_2-t_1)/2);
-                                    
-                        t_2 -= (t_2-t_1)/2;
+                        g_2 /= 2;
                     }
-                    else
+                    retainedSide = 1;
+                }
+                else
+                {
+                    t_2 = t_c;
+                    g_2 = g_c;
+                    if (retainedSide == -1)
                     {
-                        spdlog::get("default_pysyslink")->debug("No event on interval {} - {}, increase t_1 in {}", t_1, (t_2+t_1)/2, (t_2-t_1)/2);
-                        t_1 += (t_2-t_1)/2;
+                        g_1 /= 2;
                     }
+                    retainedSide = -1;
                 }
-                auto eventResolutionTimeResult = this->OdeStepSolverStep(systemLambda, systemJacobianLambda, this->GetStates(), currentTime, t_2 - currentTime);
-
-                appliedTimeStep = t_2 - currentTime;
-                this->nextTimeHitStates = std::get<1>(eventResolutionTimeResult);
-                newSuggestedTimeStep = std::get<2>(eventResolutionTimeResult);
-
-                spdlog::get("default_pysyslink")->debug("Event resolved, new time hit: {}", t_2);
             }
+            spdlog::get("default_pysyslink")->debug("Event {} located on interval {} - {}", i, t_1, t_2);
+            if (this->profiler)
+            {
+                this->profiler->CountEventBisectionIterations(iteration);
+            }
+            eventTime = std::min(eventTime, t_2);
         }
-        spdlog::get("default_pysyslink")->debug("Applied step size in time {}: {}", currentTime, appliedTimeStep);
-
-        this->nextSuggestedTimeStep = newSuggestedTimeStep;
-        this->nextUnknownTimeHit = currentTime + appliedTimeStep;
+        return eventTime;
     }
 
     double BasicOdeSolver::GetNextTimeHit() const
@@ -378,4 +704,32 @@ namespace PySysLinkBase
     {
         return this->nextSuggestedTimeStep;
     }
+
+    void BasicOdeSolver::SaveCheckpoint(CheckpointWriter& writer)
+    {
+        writer.WriteDoubles(this->GetStates());
+        writer.WriteDoubles(this->nextTimeHitStates);
+        writer.Write(this->nextUnknownTimeHit);
+        writer.Write(this->nextSuggestedTimeStep);
+    }
+
+    void BasicOdeSolver::RestoreCheckpoint(CheckpointReader& reader)
+    {
+        std::vector<double> states = reader.ReadDoubles();
+        if (states.size() != this->totalStates)
+        {
+            throw std::invalid_argument("Checkpoint holds " + std::to_string(states.size()) + " continuous states for a group with " + std::to_string(this->totalStates));
+        }
+        this->SetStates(states);
+        this->nextTimeHitStates = reader.ReadDoubles();
+        this->nextUnknownTimeHit = reader.Read<double>();
+        this->nextSuggestedTimeStep = reader.Read<double>();
+
+        // Known time hits are found again by time, the restored run may stop later than the one that was saved
+        this->currentKnownTimeHit = 0;
+        if (!std::isnan(this->nextUnknownTimeHit))
+        {
+            this->currentKnownTimeHit = std::lower_bound(this->knownTimeHits.begin(), this->knownTimeHits.end(), this->nextUnknownTimeHit) - this->knownTimeHits.begin();
+        }
+    }
 } // namespace PySysLinkBase
@@ -2,16 +2,22 @@
 #define SRC_BASIC_ODE_SOLVER
 
 #include "IOdeStepSolver.h"
+#include "IOdeSystem.h"
 #include "ISimulationBlockWithContinuousStates.h"
 #include "../SimulationModel.h"
 #include <memory>
 #include <vector>
+#include <utility>
 #include "../SimulationOptions.h"
+#include "../SimulationCheckpoint.h"
+#include "../AlgebraicLoopSolver.h"
+#include "../SimulationProfiler.h"
+#include <Eigen/Sparse>
 
 namespace PySysLinkBase
 {
 
-    class BasicOdeSolver
+    class BasicOdeSolver : public IOdeSystem
     {
         private:
             std::shared_ptr<IOdeStepSolver> odeStepSolver;
@@ -20,33 +26,86 @@ namespace PySysLinkBase
             std::vector<int> continuousStatesInEachBlock;
             int totalStates;
 
+            // Blocks with continuous states and where their states start in the solver vectors, resolved once at setup
+            struct ContinuousStatesOfBlock
+            {
+                std::shared_ptr<ISimulationBlockWithContinuousStates> block;
+                int offset;
+                int stateCount;
+                bool useAnalyticalJacobian = false;
+            };
+            std::vector<ContinuousStatesOfBlock> continuousStatesOfBlocks;
+
+            // Jacobian sparsity found from the links between blocks; columns of a group share no row and are perturbed together
+            std::vector<std::vector<int>> finiteDifferenceRowsOfEachColumn;
+            std::vector<std::vector<int>> jacobianColumnGroups;
+            void BuildJacobianSparsity();
+
+            // Blocks of the group with their output ports and the input ports each output feeds, resolved once at setup.
+            // Blocks of an algebraic loop solve it on the first of them and are skipped otherwise.
+            struct OutputsOfBlock
+            {
+                std::shared_ptr<ISimulationBlock> block;
+                std::vector<std::shared_ptr<OutputPort>> outputPorts;
+                std::vector<std::vector<std::shared_ptr<InputPort>>> connectedPortsOfEachOutput;
+                std::shared_ptr<AlgebraicLoopSolver> algebraicLoopSolver;
+                bool isAlgebraicLoopSolvedHere = false;
+            };
+            std::vector<OutputsOfBlock> outputsOfBlocks; // Same order as simulationBlocks
+
             std::vector<double> knownTimeHits = {};
             int currentKnownTimeHit = 0;
             double nextUnknownTimeHit;
             double nextSuggestedTimeStep;
             std::vector<double> nextTimeHitStates;
 
+            // Solver-owned buffers sized at setup, states and derivatives are gathered into them instead of new vectors
+            std::vector<double> stateBuffer;
+            std::vector<double> derivativeBuffer;
+            std::vector<double> stepInitialStates;
+            std::vector<double> eventResolutionStates;
+            std::vector<double> jacobianOriginalStates;
+            std::vector<double> jacobianOriginalDerivatives;
+            std::vector<double> jacobianPerturbedStates;
+            std::vector<double> jacobianPerturbations;
+            std::vector<double> blockJacobianBuffer;
+            std::vector<Eigen::Triplet<double>> jacobianEntries;
+            Eigen::SparseMatrix<double> sparseJacobian;
+
             std::shared_ptr<SampleTime> sampleTime;
+
+            std::shared_ptr<SimulationProfiler> profiler;
             
-            void ComputeBlockOutputs(std::shared_ptr<ISimulationBlock> block, std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep=false);
+            void ComputeBlockOutputs(const OutputsOfBlock& outputsOfBlock, std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep=false);
             void ComputeMinorOutputs(std::shared_ptr<SampleTime> sampleTime, double currentTime);
-            std::vector<double> GetDerivatives(std::shared_ptr<SampleTime> sampleTime, double currentTime);
+            const std::vector<double>& GetDerivatives(std::shared_ptr<SampleTime> sampleTime, double currentTime);
             std::vector<std::vector<double>> GetJacobian(std::shared_ptr<SampleTime> sampleTime, double currentTime);
-            void SetStates(std::vector<double> newStates);
-            std::vector<double> GetStates();
+            const Eigen::SparseMatrix<double>& GetSparseJacobian(std::shared_ptr<SampleTime> sampleTime, double currentTime);
+            void SetStates(const std::vector<double>& newStates);
+            const std::vector<double>& GetStates();
 
-            std::tuple<bool, std::vector<double>, double> OdeStepSolverStep(std::function<std::vector<double>(std::vector<double>, double)> systemLambda, 
-                                                    std::function<std::vector<std::vector<double>>(std::vector<double>, double)> systemJacobianLambda,
-                                                    std::vector<double> states_0, double currentTime, double timeStep);
+            // Writes the stepped states into newStates and returns whether the step was accepted and the suggested time step
+            std::pair<bool, double> OdeStepSolverStep(const std::function<std::vector<double>(std::vector<double>, double)>& systemLambda, 
+                                                    const std::function<std::vector<std::vector<double>>(std::vector<double>, double)>& systemJacobianLambda,
+                                                    const std::function<Eigen::SparseMatrix<double>(std::vector<double>, double)>& systemSparseJacobianLambda,
+                                                    const std::vector<double>& states_0, double currentTime, double timeStep, std::vector<double>& newStates);
 
             bool activateEvents;
             double eventTolerance;
-            const std::vector<std::pair<double, double>> GetEvents(const std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double eventTime, std::vector<double> eventTimeStates) const;
+            const std::vector<std::pair<double, double>> GetEvents(const std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double eventTime, const std::vector<double>& eventTimeStates) const;
+            bool IsThereEvent(const std::vector<std::pair<double, double>>& initialEvents, double eventTime, const std::vector<double>& eventTimeStates) const;
+            double LocateEvent(const std::vector<std::pair<double, double>>& initialEvents, double time_0, const std::vector<double>& states_0,
+                                double time_1, const std::vector<double>& states_1);
         public:
             double firstTimeStep;
 
-            std::vector<double> SystemModel(std::vector<double> states, double time);
-            std::vector<std::vector<double>> SystemModelJacobian(std::vector<double> states, double time);
+            // Results are references to solver-owned buffers, valid until the next evaluation
+            const std::vector<double>& SystemModel(const std::vector<double>& states, double time);
+            std::vector<std::vector<double>> SystemModelJacobian(const std::vector<double>& states, double time);
+            const Eigen::SparseMatrix<double>& SystemModelSparseJacobian(const std::vector<double>& states, double time);
+
+            int GetStateCount() const;
+            void EvaluateDerivatives(const double* states, double* derivatives, double time);
 
             BasicOdeSolver(std::shared_ptr<IOdeStepSolver> odeStepSolver, std::shared_ptr<SimulationModel> simulationModel, 
                             std::vector<std::shared_ptr<ISimulationBlock>> simulationBlocks, std::shared_ptr<SampleTime> sampleTime, 
@@ -56,9 +115,14 @@ namespace PySysLinkBase
             void UpdateStatesToNextTimeHits();
             void DoStep(double currentTime, double timeStep);
             void ComputeMajorOutputs(double currentTime);
+            void SetAlgebraicLoopSolvers(const std::vector<std::shared_ptr<AlgebraicLoopSolver>>& algebraicLoopSolvers);
+            void SetProfiler(std::shared_ptr<SimulationProfiler> profiler);
 
             double GetNextTimeHit() const;
             double GetNextSuggestedTimeStep() const;
+
+            void SaveCheckpoint(CheckpointWriter& writer);
+            void RestoreCheckpoint(CheckpointReader& reader);
     };
 } // namespace PySysLinkBase
 
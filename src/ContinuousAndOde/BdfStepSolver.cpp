@@ -0,0 +1,344 @@
+#include "BdfStepSolver.h"
+#include <spdlog/spdlog.h>
+#include <Eigen/Dense>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <string>
+
+namespace PySysLinkBase
+{
+    BdfStepSolver::BdfStepSolver(double absoluteTolerance, double relativeTolerance, int maximumOrder, int maximumNewtonIterations)
+        : absoluteTolerance(absoluteTolerance), relativeTolerance(relativeTolerance), maximumOrder(maximumOrder), maximumNewtonIterations(maximumNewtonIterations)
+    {
+        if (this->maximumOrder < 1 || this->maximumOrder > 5)
+        {
+            throw std::invalid_argument("BDF maximum order must be between 1 and 5, got " + std::to_string(this->maximumOrder));
+        }
+        if (this->maximumNewtonIterations < 1)
+        {
+            throw std::invalid_argument("BDF maximum Newton iterations must be at least 1, got " + std::to_string(this->maximumNewtonIterations));
+        }
+    }
+
+    int BdfStepSolver::GetCurrentOrder() const
+    {
+        return this->order;
+    }
+
+    std::tuple<bool, std::vector<double>, double> BdfStepSolver::SolveStep(std::function<std::vector<double>(std::vector<double>, double)> systemDerivatives,
+                                                                            std::function<std::vector<std::vector<double>>(std::vector<double>, double)> systemJacobian,
+                                                                            std::vector<double> states_0, double currentTime, double timeStep)
+    {
+        auto systemSparseJacobian = [&systemJacobian](std::vector<double> states, double time)
+        {
+            return ToSparseJacobian(systemJacobian(states, time));
+        };
+
+        return this->SolveStepWithSparseJacobian(systemDerivatives, systemSparseJacobian, states_0, currentTime, timeStep);
+    }
+
+    std::tuple<bool, std::vector<double>, double> BdfStepSolver::SolveStepWithSparseJacobian(std::function<std::vector<double>(std::vector<double>, double)> systemDerivatives,
+                                                                            std::function<Eigen::SparseMatrix<double>(std::vector<double>, double)> systemSparseJacobian,
+                                                                            std::vector<double> states_0, double currentTime, double timeStep)
+    {
+        if (timeStep <= 0.0)
+        {
+            throw std::invalid_argument("BDF step size must be positive, got " + std::to_string(timeStep));
+        }
+
+        this->SynchronizeHistory(states_0, currentTime);
+
+        int stateCount = states_0.size();
+        double nextTime = currentTime + timeStep;
+        bool isStartingStep = this->historyTimes.size() == 1;
+        int currentOrder = isStartingStep ? 1 : std::min<int>(this->order, this->historyTimes.size() - 1);
+
+        // Predictor, explicit Euler on the first step and polynomial extrapolation of the past points afterwards
+        std::vector<double> statesPredicted;
+        double errorConstant;
+        if (isStartingStep)
+        {
+            std::vector<double> derivatives_0 = systemDerivatives(states_0, currentTime);
+            statesPredicted = states_0;
+            for (int i = 0; i < stateCount; i++)
+            {
+                statesPredicted[i] += timeStep * derivatives_0[i];
+            }
+            errorConstant = 0.5;
+        }
+        else
+        {
+            statesPredicted = this->ExtrapolateHistory(nextTime, currentOrder + 1);
+            errorConstant = timeStep / (nextTime - this->historyTimes[this->historyTimes.size() - 1 - currentOrder]);
+        }
+
+        // Corrector: statesEnd - gamma * f(statesEnd) - psi = 0
+        std::vector<double> coefficients = this->ComputeCorrectorCoefficients(nextTime, currentOrder);
+        double gamma = 1.0 / coefficients[0];
+        Eigen::VectorXd psi = Eigen::VectorXd::Zero(stateCount);
+        for (int j = 1; j <= currentOrder; j++)
+        {
+            const std::vector<double>& pastStates = this->historyStates[this->historyStates.size() - j];
+            psi -= gamma * coefficients[j] * Eigen::Map<const Eigen::VectorXd>(pastStates.data(), stateCount);
+        }
+
+        std::vector<double> statesEnd;
+        bool isJacobianFresh = false;
+        bool isNewtonConverged = false;
+        while (!isNewtonConverged)
+        {
+            if (!this->isCachedJacobianAvailable || this->cachedJacobian.rows() != stateCount)
+            {
+                systemDerivatives(statesPredicted, nextTime);
+                this->cachedJacobian = systemSparseJacobian(statesPredicted, nextTime);
+                this->isCachedJacobianAvailable = true;
+                isJacobianFresh = true;
+            }
+
+            if (this->identity.rows() != stateCount)
+            {
+                this->identity.resize(stateCount, stateCount);
+                this->identity.setIdentity();
+            }
+            this->newtonMatrixFactorization.compute(this->identity - gamma * this->cachedJacobian);
+
+            if (this->newtonMatrixFactorization.info() == Eigen::Success)
+            {
+                statesEnd = statesPredicted;
+                double previousDeltaNorm = std::numeric_limits<double>::infinity();
+                for (int iteration = 0; iteration < this->maximumNewtonIterations; iteration++)
+                {
+                    std::vector<double> derivativesEnd = systemDerivatives(statesEnd, nextTime);
+                    Eigen::Map<Eigen::VectorXd> eigenStatesEnd(statesEnd.data(), stateCount);
+                    Eigen::Map<const Eigen::VectorXd> eigenDerivativesEnd(derivativesEnd.data(), stateCount);
+
+                    this->newtonResidual = psi + gamma * eigenDerivativesEnd - eigenStatesEnd;
+                    this->newtonStep = this->newtonMatrixFactorization.solve(this->newtonResidual);
+                    eigenStatesEnd += this->newtonStep;
+
+                    double deltaNorm = this->WeightedNorm(this->newtonStep.data(), states_0, statesEnd);
+                    if (deltaNorm <= this->newtonTolerance)
+                    {
+                        isNewtonConverged = true;
+                        break;
+                    }
+                    if (deltaNorm > 0.9 * previousDeltaNorm)
+                    {
+                        break;
+                    }
+                    previousDeltaNorm = deltaNorm;
+                }
+            }
+
+            if (!isNewtonConverged)
+            {
+                if (!isJacobianFresh)
+                {
+                    spdlog::get("default_pysyslink")->debug("BDF Newton iteration failed with a reused Jacobian at time {}, evaluating it again", nextTime);
+                    this->isCachedJacobianAvailable = false;
+                    continue;
+                }
+
+                spdlog::get("default_pysyslink")->debug("BDF Newton iteration failed at time {} with step size {}", nextTime, timeStep);
+                this->consecutiveRejections++;
+                return {false, statesPredicted, timeStep / 4.0};
+            }
+        }
+
+        std::vector<double> predictorCorrection(stateCount);
+        for (int i = 0; i < stateCount; i++)
+        {
+            predictorCorrection[i] = statesEnd[i] - statesPredicted[i];
+        }
+        double error = std::max(errorConstant * this->WeightedNorm(predictorCorrection.data(), states_0, statesEnd), 1e-10);
+
+        if (error > 1.0)
+        {
+            this->consecutiveRejections++;
+            if (this->consecutiveRejections >= 2 && this->order > 1)
+            {
+                this->order--;
+                this->stepsAtCurrentOrder = 0;
+            }
+
+            double reducedTimeStep = timeStep * std::max(0.2, 0.9 * std::pow(error, -1.0 / (currentOrder + 1)));
+            if (reducedTimeStep <= 16.0 * std::numeric_limits<double>::epsilon() * std::max(1.0, std::abs(currentTime)))
+            {
+                throw std::runtime_error("BDF step size became too small at time " + std::to_string(currentTime));
+            }
+
+            spdlog::get("default_pysyslink")->debug("BDF step rejected at time {}, error {}, order {}", currentTime, error, currentOrder);
+            return {false, statesEnd, reducedTimeStep};
+        }
+
+        // Accepted, choose the order among the neighbours of the current one that allows the largest next step
+        int selectedOrder = currentOrder;
+        double stepSizeFactor = std::pow(error, -1.0 / (currentOrder + 1));
+        if (!isStartingStep)
+        {
+            if (currentOrder > 1)
+            {
+                std::vector<double> statesPredictedLower = this->ExtrapolateHistory(nextTime, currentOrder);
+                std::vector<double> lowerPredictorCorrection(stateCount);
+                for (int i = 0; i < stateCount; i++)
+                {
+                    lowerPredictorCorrection[i] = statesEnd[i] - statesPredictedLower[i];
+                }
+                double lowerErrorConstant = timeStep / (nextTime - this->historyTimes[this->historyTimes.size() - currentOrder]);
+                double lowerError = std::max(lowerErrorConstant * this->WeightedNorm(lowerPredictorCorrection.data(), states_0, statesEnd), 1e-10);
+                double lowerStepSizeFactor = std::pow(lowerError, -1.0 / currentOrder);
+                if (lowerStepSizeFactor > stepSizeFactor)
+                {
+                    selectedOrder = currentOrder - 1;
+                    stepSizeFactor = lowerStepSizeFactor;
+                }
+            }
+            if (currentOrder == this->order && currentOrder < this->maximumOrder && this->stepsAtCurrentOrder >= currentOrder + 1 &&
+                this->lastPredictorCorrectionOrder == currentOrder && this->lastPredictorCorrection.size() == stateCount)
+            {
+                double stepSizeRatio = std::pow(timeStep / this->lastPredictorCorrectionTimeStep, currentOrder + 1);
+                std::vector<double> higherDifference(stateCount);
+                for (int i = 0; i < stateCount; i++)
+                {
+                    higherDifference[i] = predictorCorrection[i] - stepSizeRatio * this->lastPredictorCorrection[i];
+                }
+                double higherError = std::max(this->WeightedNorm(higherDifference.data(), states_0, statesEnd) / (currentOrder + 2), 1e-10);
+                double higherStepSizeFactor = std::pow(higherError, -1.0 / (currentOrder + 2));
+                if (higherStepSizeFactor > stepSizeFactor)
+                {
+                    selectedOrder = currentOrder + 1;
+                    stepSizeFactor = higherStepSizeFactor;
+                }
+            }
+        }
+
+        if (selectedOrder != this->order)
+        {
+            spdlog::get("default_pysyslink")->debug("BDF order changed from {} to {} at time {}", this->order, selectedOrder, nextTime);
+            this->order = selectedOrder;
+            this->stepsAtCurrentOrder = 0;
+        }
+        else
+        {
+            this->stepsAtCurrentOrder++;
+        }
+        this->consecutiveRejections = 0;
+        this->lastPredictorCorrection = predictorCorrection;
+        this->lastPredictorCorrectionTimeStep = timeStep;
+        this->lastPredictorCorrectionOrder = currentOrder;
+
+        this->PushToHistory(nextTime, statesEnd);
+
+        double nextTimeStep = timeStep * std::min(2.0, std::max(0.2, 0.9 * stepSizeFactor));
+
+        return {true, statesEnd, nextTimeStep};
+    }
+
+    void BdfStepSolver::SynchronizeHistory(const std::vector<double>& states_0, double currentTime)
+    {
+        // Steps may be retried or discarded by the caller (rejections, event location), so the history is cut back to the
+        // point the step starts from. Any other starting point means the states were changed from outside and the method restarts.
+        for (int i = static_cast<int>(this->historyTimes.size()) - 1; i >= 0; i--)
+        {
+            if (this->historyTimes[i] == currentTime && this->historyStates[i] == states_0)
+            {
+                if (i != static_cast<int>(this->historyTimes.size()) - 1)
+                {
+                    this->historyTimes.erase(this->historyTimes.begin() + i + 1, this->historyTimes.end());
+                    this->historyStates.erase(this->historyStates.begin() + i + 1, this->historyStates.end());
+                    this->lastPredictorCorrection.clear();
+                }
+                return;
+            }
+        }
+
+        if (!this->historyTimes.empty())
+        {
+            spdlog::get("default_pysyslink")->debug("BDF history does not match states at time {}, restarting at order 1", currentTime);
+        }
+        this->historyTimes = {currentTime};
+        this->historyStates = {states_0};
+        this->order = 1;
+        this->stepsAtCurrentOrder = 0;
+        this->lastPredictorCorrection.clear();
+    }
+
+    void BdfStepSolver::PushToHistory(double time, const std::vector<double>& states)
+    {
+        this->historyTimes.push_back(time);
+        this->historyStates.push_back(states);
+        while (this->historyTimes.size() > this->maximumOrder + 2)
+        {
+            this->historyTimes.pop_front();
+            this->historyStates.pop_front();
+        }
+    }
+
+    std::vector<double> BdfStepSolver::ExtrapolateHistory(double time, int pointCount) const
+    {
+        int firstPoint = this->historyTimes.size() - pointCount;
+        std::vector<double> extrapolatedStates(this->historyStates.back().size(), 0.0);
+        for (int j = firstPoint; j < this->historyTimes.size(); j++)
+        {
+            double lagrangeWeight = 1.0;
+            for (int m = firstPoint; m < this->historyTimes.size(); m++)
+            {
+                if (m != j)
+                {
+                    lagrangeWeight *= (time - this->historyTimes[m]) / (this->historyTimes[j] - this->historyTimes[m]);
+                }
+            }
+            for (int i = 0; i < extrapolatedStates.size(); i++)
+            {
+                extrapolatedStates[i] += lagrangeWeight * this->historyStates[j][i];
+            }
+        }
+        return extrapolatedStates;
+    }
+
+    std::vector<double> BdfStepSolver::ComputeCorrectorCoefficients(double time, int currentOrder) const
+    {
+        // Derivative at the new time of the interpolating polynomial through the new point and the last currentOrder points
+        std::vector<double> nodes = {time};
+        for (int j = 1; j <= currentOrder; j++)
+        {
+            nodes.push_back(this->historyTimes[this->historyTimes.size() - j]);
+        }
+
+        std::vector<double> coefficients(currentOrder + 1, 0.0);
+        for (int m = 1; m <= currentOrder; m++)
+        {
+            coefficients[0] += 1.0 / (nodes[0] - nodes[m]);
+        }
+        for (int j = 1; j <= currentOrder; j++)
+        {
+            double coefficient = 1.0 / (nodes[j] - nodes[0]);
+            for (int m = 1; m <= currentOrder; m++)
+            {
+                if (m != j)
+                {
+                    coefficient *= (nodes[0] - nodes[m]) / (nodes[j] - nodes[m]);
+                }
+            }
+            coefficients[j] = coefficient;
+        }
+        return coefficients;
+    }
+
+    double BdfStepSolver::WeightedNorm(const double* values, const std::vector<double>& states_0, const std::vector<double>& statesEnd) const
+    {
+        if (states_0.empty())
+        {
+            return 0.0;
+        }
+
+        double sumOfSquares = 0.0;
+        for (int i = 0; i < states_0.size(); i++)
+        {
+            double scale = this->absoluteTolerance + this->relativeTolerance * std::max(std::abs(states_0[i]), std::abs(statesEnd[i]));
+            sumOfSquares += (values[i] / scale) * (values[i] / scale);
+        }
+        return std::sqrt(sumOfSquares / states_0.size());
+    }
+} // namespace PySysLinkBase
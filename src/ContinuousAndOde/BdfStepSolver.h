@@ -0,0 +1,82 @@
+#ifndef SRC_CONTINUOUS_AND_ODE_BDF_STEP_SOLVER
+#define SRC_CONTINUOUS_AND_ODE_BDF_STEP_SOLVER
+
+#include <tuple>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <stdexcept>
+#include "IOdeStepSolver.h"
+#include <Eigen/Dense>
+#include <Eigen/SparseLU>
+
+namespace PySysLinkBase
+{
+    // Variable step, variable order (1 to 5) backward differentiation formula for stiff systems.
+    // Coefficients are recomputed from the actual past step sizes, the past solution points are kept between calls.
+    class BdfStepSolver : public IOdeStepSolver
+    {
+        public:
+            BdfStepSolver(double absoluteTolerance = 1e-6, double relativeTolerance = 1e-6, int maximumOrder = 5, int maximumNewtonIterations = 4);
+
+            virtual std::tuple<bool, std::vector<double>, double> SolveStep(std::function<std::vector<double>(std::vector<double>, double)> system,
+                                                                    std::vector<double> states_0, double currentTime, double timeStep)
+            {
+                throw std::runtime_error("Jacobian needed for BDF method");
+            }
+            virtual std::tuple<bool, std::vector<double>, double> SolveStep(std::function<std::vector<double>(std::vector<double>, double)> systemDerivatives,
+                                                                    std::function<std::vector<std::vector<double>>(std::vector<double>, double)> systemJacobian,
+                                                                    std::vector<double> states_0, double currentTime, double timeStep);
+            virtual bool IsJacobianNeeded() const
+            {
+                return true;
+            }
+            virtual bool IsSparseJacobianSupported() const
+            {
+                return true;
+            }
+            virtual std::tuple<bool, std::vector<double>, double> SolveStepWithSparseJacobian(std::function<std::vector<double>(std::vector<double>, double)> systemDerivatives,
+                                                                    std::function<Eigen::SparseMatrix<double>(std::vector<double>, double)> systemSparseJacobian,
+                                                                    std::vector<double> states_0, double currentTime, double timeStep);
+
+            int GetCurrentOrder() const;
+
+        private:
+            double absoluteTolerance;
+            double relativeTolerance;
+            int maximumOrder;
+            int maximumNewtonIterations;
+            const double newtonTolerance = 1e-2;
+
+            // Accepted solution points, oldest first
+            std::deque<double> historyTimes;
+            std::deque<std::vector<double>> historyStates;
+
+            int order = 1;
+            int stepsAtCurrentOrder = 0;
+            int consecutiveRejections = 0;
+
+            // Corrector minus predictor of the last accepted step, used to estimate the error of the next order
+            std::vector<double> lastPredictorCorrection;
+            double lastPredictorCorrectionTimeStep = 0.0;
+            int lastPredictorCorrectionOrder = 0;
+
+            // The Jacobian is kept across steps and only evaluated again when the Newton iteration fails with it
+            Eigen::SparseMatrix<double> cachedJacobian;
+            bool isCachedJacobianAvailable = false;
+
+            // Newton buffers kept across iterations and steps, resized only when the state count changes
+            Eigen::SparseMatrix<double> identity;
+            Eigen::SparseLU<Eigen::SparseMatrix<double>> newtonMatrixFactorization;
+            Eigen::VectorXd newtonResidual;
+            Eigen::VectorXd newtonStep;
+
+            void SynchronizeHistory(const std::vector<double>& states_0, double currentTime);
+            void PushToHistory(double time, const std::vector<double>& states);
+            std::vector<double> ExtrapolateHistory(double time, int pointCount) const;
+            std::vector<double> ComputeCorrectorCoefficients(double time, int currentOrder) const;
+            double WeightedNorm(const double* values, const std::vector<double>& states_0, const std::vector<double>& statesEnd) const;
+    };
+} // namespace PySysLinkBase
+
+#endif /* SRC_CONTINUOUS_AND_ODE_BDF_STEP_SOLVER */
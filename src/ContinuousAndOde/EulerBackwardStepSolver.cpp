@@ -1,87 +1,168 @@
 #include "EulerBackwardStepSolver.h"
 #include <spdlog/spdlog.h>
 #include <Eigen/Dense>
+#include <Eigen/SparseLU>
 
 namespace PySysLinkBase
 {
     std::tuple<bool, std::vector<double>, double> EulerBackwardStepSolver::SolveStep(std::function<std::vector<double>(std::vector<double>, double)> systemDerivatives,
                                                                                 std::function<std::vector<std::vector<double>>(std::vector<double>, double)> systemJacobian,
                                                                                 std::vector<double> states_0, double currentTime, double timeStep)
+    {
+        auto systemSparseJacobian = [&systemJacobian](std::vector<double> states, double time)
+        {
+            return ToSparseJacobian(systemJacobian(states, time));
+        };
+
+        return this->SolveStepWithSparseJacobian(systemDerivatives, systemSparseJacobian, states_0, currentTime, timeStep);
+    }
+
+    std::tuple<bool, std::vector<double>, double> EulerBackwardStepSolver::SolveStepWithSparseJacobian(std::function<std::vector<double>(std::vector<double>, double)> systemDerivatives,
+                                                                                std::function<Eigen::SparseMatrix<double>(std::vector<double>, double)> systemSparseJacobian,
+                                                                                std::vector<double> states_0, double currentTime, double timeStep)
+    {
+        if (this->useModifiedNewton)
+        {
+            return this->SolveStepWithModifiedNewton(systemDerivatives, systemSparseJacobian, states_0, currentTime, timeStep);
+        }
+        return this->SolveStepWithFullNewton(systemDerivatives, systemSparseJacobian, states_0, currentTime, timeStep);
+    }
+
+    std::tuple<bool, std::vector<double>, double> EulerBackwardStepSolver::SolveStepWithFullNewton(std::function<std::vector<double>(std::vector<double>, double)> systemDerivatives,
+                                                                                std::function<Eigen::SparseMatrix<double>(std::vector<double>, double)> systemSparseJacobian,
+                                                                                std::vector<double> states_0, double currentTime, double timeStep)
     {
         std::vector<double> statesEnd = states_0;
 
         for (int i = 0; i < this->maximumIterations; i++)
         {
-            std::vector<double> statesEndOld = statesEnd;
+            // The Jacobian is refreshed every iteration here, the modified Newton storage only serves as a buffer
+            this->previousStatesEnd = statesEnd;
             std::vector<double> systemDerivativesEnd = systemDerivatives(statesEnd, currentTime + timeStep);
-            std::vector<std::vector<double>> systemJacobianEnd = systemJacobian(statesEnd, currentTime + timeStep);
+            this->cachedJacobian = systemSparseJacobian(statesEnd, currentTime + timeStep);
 
-       
-            std::vector<double> delta = this->ComputeNewtonStep(systemJacobianEnd, systemDerivativesEnd, states_0, statesEnd, timeStep);
+            this->FactorizeNewtonMatrix(this->cachedJacobian, timeStep, this->cachedNewtonMatrixFactorization);
+            this->ComputeNewtonStep(this->cachedNewtonMatrixFactorization, systemDerivativesEnd, states_0, statesEnd, timeStep);
 
             for (size_t j = 0; j < statesEnd.size(); j++) {
-                statesEnd[j] += delta[j];
+                statesEnd[j] += this->newtonStep[j];
             }
 
             // Check convergence
             double maxError = 0.0;
             for (size_t j = 0; j < statesEnd.size(); j++)
             {
-                maxError = std::max(maxError, std::abs(statesEnd[j] - statesEndOld[j]));
+                maxError = std::max(maxError, std::abs(statesEnd[j] - this->previousStatesEnd[j]));
             }
-            
+
             if (maxError < this->tolerance)
             {
-                systemDerivatives(states_0, currentTime);
                 return {true, statesEnd, timeStep};
             }
         }
 
-        systemDerivatives(states_0, currentTime);
         return {true, statesEnd, timeStep};
     }
 
-    std::vector<double> EulerBackwardStepSolver::ComputeNewtonStep(const std::vector<std::vector<double>>& systemJacobianEnd,
-        const std::vector<double>& systemDerivativesEnd, const std::vector<double>& states_0, const std::vector<double>& statesEnd,
-         double timeStep) 
+    std::tuple<bool, std::vector<double>, double> EulerBackwardStepSolver::SolveStepWithModifiedNewton(std::function<std::vector<double>(std::vector<double>, double)> systemDerivatives,
+                                                                                std::function<Eigen::SparseMatrix<double>(std::vector<double>, double)> systemSparseJacobian,
+                                                                                std::vector<double> states_0, double currentTime, double timeStep)
     {
-        int rows = systemJacobianEnd.size();
-        if (rows == 0 || systemJacobianEnd[0].size() != rows) {
-            throw std::runtime_error("Jacobian must be a non-empty square matrix.");
+        std::vector<double> statesEnd = states_0;
+
+        bool isJacobianFresh = false;
+        if (!this->isCachedJacobianAvailable || this->cachedJacobian.rows() != static_cast<Eigen::Index>(states_0.size()))
+        {
+            systemDerivatives(statesEnd, currentTime + timeStep);
+            this->cachedJacobian = systemSparseJacobian(statesEnd, currentTime + timeStep);
+            this->isCachedJacobianAvailable = true;
+            isJacobianFresh = true;
+            this->FactorizeNewtonMatrix(this->cachedJacobian, timeStep, this->cachedNewtonMatrixFactorization);
+            this->cachedTimeStep = timeStep;
+        }
+        else if (timeStep != this->cachedTimeStep)
+        {
+            this->FactorizeNewtonMatrix(this->cachedJacobian, timeStep, this->cachedNewtonMatrixFactorization);
+            this->cachedTimeStep = timeStep;
         }
 
-        Eigen::MatrixXd eigenJacobian(rows, rows);
-        for (int i = 0; i < rows; i++) {
-            if (systemJacobianEnd[i].size() != rows) {
-                throw std::runtime_error("Jacobian must be a square matrix.");
+        double previousMaxError = std::numeric_limits<double>::infinity();
+        int remainingIterations = this->maximumIterations;
+        while (remainingIterations > 0)
+        {
+            remainingIterations--;
+
+            std::vector<double> systemDerivativesEnd = systemDerivatives(statesEnd, currentTime + timeStep);
+            this->ComputeNewtonStep(this->cachedNewtonMatrixFactorization, systemDerivativesEnd, states_0, statesEnd, timeStep);
+
+            double maxError = 0.0;
+            for (Eigen::Index j = 0; j < this->newtonStep.size(); j++)
+            {
+                maxError = std::max(maxError, std::abs(this->newtonStep[j]));
+            }
+
+            // A stale Jacobian that no longer contracts the iteration is refreshed at the current iterate,
+            // which leaves the block states evaluated at statesEnd as the Jacobian callback expects
+            bool isConvergenceDegraded = maxError >= this->tolerance && (maxError > 0.5 * previousMaxError || remainingIterations == 0);
+            if (!isJacobianFresh && isConvergenceDegraded)
+            {
+                spdlog::get("default_pysyslink")->debug("Modified Newton iteration degraded at time {}, refreshing Jacobian", currentTime + timeStep);
+                this->cachedJacobian = systemSparseJacobian(statesEnd, currentTime + timeStep);
+                this->FactorizeNewtonMatrix(this->cachedJacobian, timeStep, this->cachedNewtonMatrixFactorization);
+                this->cachedTimeStep = timeStep;
+                isJacobianFresh = true;
+                previousMaxError = std::numeric_limits<double>::infinity();
+                remainingIterations = this->maximumIterations;
+                continue;
             }
-            for (int j = 0; j < rows; j++) {
-                eigenJacobian(i, j) = systemJacobianEnd[i][j];
+
+            for (size_t j = 0; j < statesEnd.size(); j++) {
+                statesEnd[j] += this->newtonStep[j];
             }
+
+            if (maxError < this->tolerance)
+            {
+                return {true, statesEnd, timeStep};
+            }
+            previousMaxError = maxError;
         }
 
-        Eigen::VectorXd eigenDerivatives(rows);
-        for (int i = 0; i < rows; i++) {
-            eigenDerivatives(i) = systemDerivativesEnd[i];
+        return {true, statesEnd, timeStep};
+    }
+
+    void EulerBackwardStepSolver::FactorizeNewtonMatrix(const Eigen::SparseMatrix<double>& systemJacobian, double timeStep,
+                                                        Eigen::SparseLU<Eigen::SparseMatrix<double>>& factorization)
+    {
+        int rows = systemJacobian.rows();
+        if (rows == 0 || systemJacobian.cols() != rows) {
+            throw std::runtime_error("Jacobian must be a non-empty square matrix.");
         }
 
-        Eigen::VectorXd eigenStatesEnd(rows);
-        for (int i = 0; i < rows; i++) {
-            eigenStatesEnd(i) = statesEnd[i];
+        if (this->identity.rows() != rows)
+        {
+            this->identity.resize(rows, rows);
+            this->identity.setIdentity();
         }
-        Eigen::VectorXd eigenStates_0(rows);
-        for (int i = 0; i < rows; i++) {
-            eigenStates_0(i) = states_0[i];
+        this->newtonMatrix = this->identity - timeStep * systemJacobian;
+
+        factorization.compute(this->newtonMatrix);
+        if (factorization.info() != Eigen::Success) {
+            throw std::runtime_error("Newton matrix of implicit Euler step could not be factorized.");
         }
+    }
 
-        Eigen::VectorXd F = eigenStatesEnd - eigenStates_0 - timeStep * eigenDerivatives;
-        Eigen::MatrixXd dF = Eigen::MatrixXd::Identity(rows, rows) - timeStep * eigenJacobian;
+    void EulerBackwardStepSolver::ComputeNewtonStep(const Eigen::SparseLU<Eigen::SparseMatrix<double>>& newtonMatrixFactorization,
+        const std::vector<double>& systemDerivativesEnd, const std::vector<double>& states_0, const std::vector<double>& statesEnd,
+         double timeStep)
+    {
+        int rows = states_0.size();
 
-        Eigen::VectorXd delta = -dF.inverse() * F;
+        Eigen::Map<const Eigen::VectorXd> eigenDerivatives(systemDerivativesEnd.data(), rows);
+        Eigen::Map<const Eigen::VectorXd> eigenStatesEnd(statesEnd.data(), rows);
+        Eigen::Map<const Eigen::VectorXd> eigenStates_0(states_0.data(), rows);
 
-        // Convert the result back to std::vector<double>
-        std::vector<double> deltaStd(delta.data(), delta.data() + delta.size());
-        return deltaStd;
+        this->newtonResidual = eigenStates_0 - eigenStatesEnd + timeStep * eigenDerivatives;
+        this->newtonStep = newtonMatrixFactorization.solve(this->newtonResidual);
     }
 
 } // namespace PySysLinkBase
@@ -10,14 +10,17 @@
 #include <cmath>
 #include <stdexcept>
 #include <iostream>
+#include <limits>
+#include <Eigen/Dense>
+#include <Eigen/SparseLU>
 
 namespace PySysLinkBase
 {
     class EulerBackwardStepSolver : public IOdeStepSolver
     {
         public:
-            EulerBackwardStepSolver(double maximumIterations = 50, double tolerance = 1e-6) 
-                : maximumIterations(maximumIterations), tolerance(tolerance)
+            EulerBackwardStepSolver(double maximumIterations = 50, double tolerance = 1e-6, bool useModifiedNewton = false) 
+                : maximumIterations(maximumIterations), tolerance(tolerance), useModifiedNewton(useModifiedNewton)
             {
             };
             virtual std::tuple<bool, std::vector<double>, double> SolveStep(std::function<std::vector<double>(std::vector<double>, double)> system, 
@@ -32,11 +35,43 @@ namespace PySysLinkBase
             {
                 return true;
             }          
+            virtual bool IsSparseJacobianSupported() const
+            {
+                return true;
+            }
+            virtual std::tuple<bool, std::vector<double>, double> SolveStepWithSparseJacobian(std::function<std::vector<double>(std::vector<double>, double)> systemDerivatives,
+                                                                    std::function<Eigen::SparseMatrix<double>(std::vector<double>, double)> systemSparseJacobian, 
+                                                                    std::vector<double> states_0, double currentTime, double timeStep);
         
         private:
             double maximumIterations;
             double tolerance;
-            std::vector<double> ComputeNewtonStep(const std::vector<std::vector<double>>& systemJacobianEnd,
+            bool useModifiedNewton;
+
+            // Modified Newton keeps the Jacobian and the factorization of I - h*J across iterations and steps,
+            // they are only refreshed when the step size changes or the iterations stop contracting
+            Eigen::SparseMatrix<double> cachedJacobian;
+            Eigen::SparseLU<Eigen::SparseMatrix<double>> cachedNewtonMatrixFactorization;
+            double cachedTimeStep = std::numeric_limits<double>::quiet_NaN();
+            bool isCachedJacobianAvailable = false;
+
+            // Newton buffers kept across iterations and steps, resized only when the state count changes
+            Eigen::SparseMatrix<double> identity;
+            Eigen::SparseMatrix<double> newtonMatrix;
+            Eigen::VectorXd newtonResidual;
+            Eigen::VectorXd newtonStep;
+            std::vector<double> previousStatesEnd;
+
+            std::tuple<bool, std::vector<double>, double> SolveStepWithFullNewton(std::function<std::vector<double>(std::vector<double>, double)> systemDerivatives,
+                                                                    std::function<Eigen::SparseMatrix<double>(std::vector<double>, double)> systemSparseJacobian, 
+                                                                    std::vector<double> states_0, double currentTime, double timeStep);
+            std::tuple<bool, std::vector<double>, double> SolveStepWithModifiedNewton(std::function<std::vector<double>(std::vector<double>, double)> systemDerivatives,
+                                                                    std::function<Eigen::SparseMatrix<double>(std::vector<double>, double)> systemSparseJacobian, 
+                                                                    std::vector<double> states_0, double currentTime, double timeStep);
+            void FactorizeNewtonMatrix(const Eigen::SparseMatrix<double>& systemJacobian, double timeStep, 
+                                        Eigen::SparseLU<Eigen::SparseMatrix<double>>& factorization);
+            // Leaves the step in newtonStep
+            void ComputeNewtonStep(const Eigen::SparseLU<Eigen::SparseMatrix<double>>& newtonMatrixFactorization,
                 const std::vector<double>& systemDerivativesEnd, const std::vector<double>& states_0, const std::vector<double>& statesEnd,
                  double timeStep);
     };
@@ -2,9 +2,12 @@
 #define SRC_CONTINUOUS_AND_ODE_IODE_STEP_SOLVER
 
 #include <tuple>
+#include <utility>
 #include <vector>
 #include <functional>
 #include <stdexcept>
+#include <Eigen/Sparse>
+#include "IOdeSystem.h"
 
 namespace PySysLinkBase
 {
@@ -17,12 +20,59 @@ namespace PySysLinkBase
             }
             virtual std::tuple<bool, std::vector<double>, double> SolveStep(std::function<std::vector<double>(std::vector<double>, double)> system, 
                                                                     std::vector<double> states_0, double currentTime, double timeStep) = 0;
-            virtual std::tuple<bool, std::vector<double>, double> SolveStep(std::function<std::vector<double>(std::vector<double>, double)> systemDerivatives,
-                                                                    std::function<std::vector<std::vector<double>>(std::vector<double>, double)> systemJacobian, 
-                                                                    std::vector<double> states_0, double currentTime, double timeStep)
+            virtual std::tuple<bool, std::vector<double>, double> SolveStep(std::function<std::vector<double>(std::vector<double>, double)>,
+                                                                    std::function<std::vector<std::vector<double>>(std::vector<double>, double)>, 
+                                                                    std::vector<double>, double, double)
             {
                 throw std::runtime_error("Jacobian not needed");
             }
+
+            virtual bool IsSparseJacobianSupported() const
+            {
+                return false;
+            }
+            virtual std::tuple<bool, std::vector<double>, double> SolveStepWithSparseJacobian(std::function<std::vector<double>(std::vector<double>, double)>,
+                                                                    std::function<Eigen::SparseMatrix<double>(std::vector<double>, double)>, 
+                                                                    std::vector<double>, double, double)
+            {
+                throw std::runtime_error("Sparse Jacobian not supported");
+            }
+
+            virtual bool IsInPlaceSystemSupported() const
+            {
+                return false;
+            }
+            // Writes the stepped states into the vector given last, reusing its storage, and returns whether the step was accepted and the suggested time step
+            virtual std::pair<bool, double> SolveStepInPlace(IOdeSystem&, const std::vector<double>&, double, double, std::vector<double>&)
+            {
+                throw std::runtime_error("In place system not supported");
+            }
+
+        protected:
+            static Eigen::SparseMatrix<double> ToSparseJacobian(const std::vector<std::vector<double>>& denseJacobian)
+            {
+                int rows = denseJacobian.size();
+
+                std::vector<Eigen::Triplet<double>> entries;
+                for (int i = 0; i < rows; i++)
+                {
+                    if (denseJacobian[i].size() != rows)
+                    {
+                        throw std::runtime_error("Jacobian must be a square matrix.");
+                    }
+                    for (int j = 0; j < rows; j++)
+                    {
+                        if (denseJacobian[i][j] != 0.0)
+                        {
+                            entries.emplace_back(i, j, denseJacobian[i][j]);
+                        }
+                    }
+                }
+
+                Eigen::SparseMatrix<double> sparseJacobian(rows, rows);
+                sparseJacobian.setFromTriplets(entries.begin(), entries.end());
+                return sparseJacobian;
+            }
     };
 } // namespace PySysLinkBase
 
@@ -0,0 +1,17 @@
+#ifndef SRC_CONTINUOUS_AND_ODE_IODE_SYSTEM
+#define SRC_CONTINUOUS_AND_ODE_IODE_SYSTEM
+
+namespace PySysLinkBase
+{
+    // System of differential equations evaluated straight from and into contiguous buffers, with no intermediate vectors
+    class IOdeSystem
+    {
+        public:
+            virtual ~IOdeSystem() = default;
+
+            virtual int GetStateCount() const = 0;
+            virtual void EvaluateDerivatives(const double* states, double* derivatives, double time) = 0;
+    };
+} // namespace PySysLinkBase
+
+#endif /* SRC_CONTINUOUS_AND_ODE_IODE_SYSTEM */
@@ -6,6 +6,8 @@
 #include <memory>
 #include <stdexcept>
 #include <utility>
+#include <algorithm>
+#include <string>
 
 namespace PySysLinkBase
 {
@@ -21,6 +23,52 @@ namespace PySysLinkBase
             virtual void SetContinuousStates(std::vector<double> newStates) = 0;
 
             virtual const std::vector<double> GetContinuousStateDerivatives(const std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime) const = 0;
+
+            // In-place access used by the solvers, reading and writing straight into their contiguous buffers.
+            // The number of states must not change once the simulation is set up.
+            // Defaults go through the vector methods above; blocks override them to avoid those copies.
+            virtual int GetContinuousStateCount() const
+            {
+                return this->GetContinuousStates().size();
+            }
+
+            virtual void CopyContinuousStatesTo(double* states, int stateCount) const
+            {
+                const std::vector<double> currentStates = this->GetContinuousStates();
+                if (static_cast<int>(currentStates.size()) != stateCount)
+                {
+                    throw std::length_error("Block " + this->GetId() + " has " + std::to_string(currentStates.size()) + " continuous states, " + std::to_string(stateCount) + " expected");
+                }
+                std::copy(currentStates.begin(), currentStates.end(), states);
+            }
+
+            virtual void SetContinuousStatesFrom(const double* newStates, int stateCount)
+            {
+                this->SetContinuousStates(std::vector<double>(newStates, newStates + stateCount));
+            }
+
+            virtual void CopyContinuousStateDerivativesTo(const std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime, double* derivatives, int stateCount) const
+            {
+                const std::vector<double> currentDerivatives = this->GetContinuousStateDerivatives(sampleTime, currentTime);
+                if (static_cast<int>(currentDerivatives.size()) != stateCount)
+                {
+                    throw std::length_error("Block " + this->GetId() + " has " + std::to_string(currentDerivatives.size()) + " continuous state derivatives, " + std::to_string(stateCount) + " expected");
+                }
+                std::copy(currentDerivatives.begin(), currentDerivatives.end(), derivatives);
+            }
+
+            // Optional analytical partial derivatives of this block's state derivatives with respect to its own states, inputs held constant.
+            // Solvers fall back to finite differences for blocks that do not provide them, or whose states reach their own inputs.
+            virtual bool HasContinuousStateJacobian() const
+            {
+                return false;
+            }
+
+            // Fills a row major matrix with one row and one column per state
+            virtual void CopyContinuousStateJacobianTo(const std::shared_ptr<PySysLinkBase::SampleTime>, double, double*, int) const
+            {
+                throw std::logic_error("Block " + this->GetId() + " does not provide an analytical continuous state Jacobian");
+            }
     };
 } // namespace PySysLinkBase
 
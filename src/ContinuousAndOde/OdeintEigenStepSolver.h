@@ -0,0 +1,96 @@
+#ifndef SRC_CONTINUOUS_AND_ODE_ODEINT_EIGEN_STEP_SOLVER
+#define SRC_CONTINUOUS_AND_ODE_ODEINT_EIGEN_STEP_SOLVER
+
+
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <functional>
+#include "IOdeStepSolver.h"
+#include "IOdeSystem.h"
+#include <Eigen/Dense>
+#include <boost/numeric/odeint.hpp>
+#include <boost/numeric/odeint/external/eigen/eigen.hpp>
+
+namespace PySysLinkBase
+{
+    // Odeint controlled stepper over Eigen::VectorXd. The state buffers and the stepper temporaries are allocated on the first
+    // step and reused afterwards, and every stage calls the system directly instead of through a std::function.
+    template <typename T>
+    class OdeintEigenStepSolver : public IOdeStepSolver
+    {
+        private:
+            T controlledStepper;
+            Eigen::VectorXd states;
+
+            struct SystemFunction
+            {
+                IOdeSystem* system;
+
+                void operator()(const Eigen::VectorXd& x, Eigen::VectorXd& dxdt, double t) const
+                {
+                    this->system->EvaluateDerivatives(x.data(), dxdt.data(), t);
+                }
+            };
+
+            std::pair<bool, double> TryStep(SystemFunction systemFunction, const std::vector<double>& states_0, double currentTime, double timeStep,
+                                            std::vector<double>& newStates)
+            {
+                this->states = Eigen::Map<const Eigen::VectorXd>(states_0.data(), states_0.size());
+                double dt = timeStep;
+
+                boost::numeric::odeint::controlled_step_result result = this->controlledStepper.try_step(systemFunction, this->states, currentTime, dt);
+
+                newStates.assign(this->states.data(), this->states.data() + this->states.size());
+                return {result == boost::numeric::odeint::success, dt};
+            }
+
+            // Adapts the copying system function of the generic interface
+            class StdFunctionOdeSystem : public IOdeSystem
+            {
+                public:
+                    StdFunctionOdeSystem(std::function<std::vector<double>(std::vector<double>, double)>& system, int stateCount)
+                        : system(system), stateCount(stateCount) {}
+
+                    int GetStateCount() const
+                    {
+                        return this->stateCount;
+                    }
+                    void EvaluateDerivatives(const double* states, double* derivatives, double time)
+                    {
+                        std::vector<double> gradient = this->system(std::vector<double>(states, states + this->stateCount), time);
+                        std::copy(gradient.begin(), gradient.end(), derivatives);
+                    }
+
+                private:
+                    std::function<std::vector<double>(std::vector<double>, double)>& system;
+                    int stateCount;
+            };
+
+        public:
+            OdeintEigenStepSolver(T controlledStepper) : controlledStepper(controlledStepper)
+            {
+            }
+
+            std::tuple<bool, std::vector<double>, double> SolveStep(std::function<std::vector<double>(std::vector<double>, double)> system,
+                                                                    std::vector<double> states_0, double currentTime, double timeStep)
+            {
+                StdFunctionOdeSystem odeSystem(system, states_0.size());
+                std::vector<double> newStates;
+                auto [isAccepted, suggestedTimeStep] = this->TryStep(SystemFunction{&odeSystem}, states_0, currentTime, timeStep, newStates);
+                return {isAccepted, std::move(newStates), suggestedTimeStep};
+            }
+
+            bool IsInPlaceSystemSupported() const
+            {
+                return true;
+            }
+            std::pair<bool, double> SolveStepInPlace(IOdeSystem& system, const std::vector<double>& states_0, double currentTime, double timeStep,
+                                                    std::vector<double>& newStates)
+            {
+                return this->TryStep(SystemFunction{&system}, states_0, currentTime, timeStep, newStates);
+            }
+    };
+} // namespace PySysLinkBase
+
+#endif /* SRC_CONTINUOUS_AND_ODE_ODEINT_EIGEN_STEP_SOLVER */
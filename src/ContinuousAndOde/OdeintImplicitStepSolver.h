@@ -118,8 +118,6 @@ namespace PySysLinkBase
                 
                 newStates = OdeintImplicitStepSolver::ublasToStd(newStates_ublas);
 
-                system(states_0, currentTime); // Set initial states again, may be optimized
-
                 // Debug log output
                 if (result == boost::numeric::odeint::success)
                 {
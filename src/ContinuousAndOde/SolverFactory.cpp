@@ -1,12 +1,29 @@
 #include "SolverFactory.h"
 #include "OdeintStepSolver.h"
+#include "OdeintEigenStepSolver.h"
 #include "EulerForwardStepSolver.h"
 #include "EulerBackwardStepSolver.h"
+#include "BdfStepSolver.h"
 #include "OdeintImplicitStepSolver.h"
 #include "spdlog/spdlog.h"
 
 namespace PySysLinkBase
 {
+    namespace
+    {
+        template <template <typename...> class Stepper>
+        std::shared_ptr<IOdeStepSolver> CreateOdeintStepSolver(double absoluteTolerance, double relativeTolerance, bool useEigenStates)
+        {
+            if (useEigenStates)
+            {
+                auto controlledStepper = boost::numeric::odeint::make_controlled(absoluteTolerance, relativeTolerance, Stepper<Eigen::VectorXd>());
+                return std::make_shared<OdeintEigenStepSolver<decltype(controlledStepper)>>(controlledStepper);
+            }
+            auto controlledStepper = boost::numeric::odeint::make_controlled(absoluteTolerance, relativeTolerance, Stepper<std::vector<double>>());
+            return std::make_shared<OdeintStepSolver<decltype(controlledStepper)>>(controlledStepper);
+        }
+    } // namespace
+
     std::shared_ptr<IOdeStepSolver> SolverFactory::CreateOdeStepSolver(std::map<std::string, ConfigurationValue> solverConfiguration)
     {
         std::string solverType = ConfigurationValueManager::TryGetConfigurationValue<std::string>("Type", solverConfiguration);
@@ -34,23 +51,40 @@ namespace PySysLinkBase
                 spdlog::get("default_pysyslink")->debug("Relative tolerance not found in configuration, using default value: {}", relativeTolerance);
             }
 
+            std::string stateType = "Eigen";
+            try
+            {
+                stateType = ConfigurationValueManager::TryGetConfigurationValue<std::string>("StateType", solverConfiguration);
+            }
+            catch (std::out_of_range const& ex)
+            {
+                spdlog::get("default_pysyslink")->debug("State type not found in configuration, using default value: {}", stateType);
+            }
+            bool useEigenStates;
+            if (stateType == "Eigen")
+            {
+                useEigenStates = true;
+            }
+            else if (stateType == "StdVector")
+            {
+                useEigenStates = false;
+            }
+            else
+            {
+                throw std::invalid_argument("State type not recognized: " + stateType + ", expected Eigen or StdVector");
+            }
+
             if (controlledSolver == "runge_kutta_cash_karp54")
             {
-                auto controlledStepper = boost::numeric::odeint::make_controlled(absoluteTolerance, relativeTolerance, boost::numeric::odeint::runge_kutta_cash_karp54<std::vector<double>>());
-                using controlledStepperType = decltype(boost::numeric::odeint::make_controlled(absoluteTolerance, relativeTolerance, boost::numeric::odeint::runge_kutta_cash_karp54<std::vector<double>>()));
-                return std::make_shared<OdeintStepSolver<controlledStepperType>>(controlledStepper);
+                return CreateOdeintStepSolver<boost::numeric::odeint::runge_kutta_cash_karp54>(absoluteTolerance, relativeTolerance, useEigenStates);
             }
             else if (controlledSolver == "runge_kutta_dopri5")
             {
-                auto controlledStepper = boost::numeric::odeint::make_controlled(absoluteTolerance, relativeTolerance, boost::numeric::odeint::runge_kutta_dopri5<std::vector<double>>());
-                using controlledStepperType = decltype(boost::numeric::odeint::make_controlled(absoluteTolerance, relativeTolerance, boost::numeric::odeint::runge_kutta_dopri5<std::vector<double>>()));
-                return std::make_shared<OdeintStepSolver<controlledStepperType>>(controlledStepper);
+                return CreateOdeintStepSolver<boost::numeric::odeint::runge_kutta_dopri5>(absoluteTolerance, relativeTolerance, useEigenStates);
             }
             else if (controlledSolver == "runge_kutta_fehlberg78")
             {
-                auto controlledStepper = boost::numeric::odeint::make_controlled(absoluteTolerance, relativeTolerance, boost::numeric::odeint::runge_kutta_fehlberg78<std::vector<double>>());
-                using controlledStepperType = decltype(boost::numeric::odeint::make_controlled(absoluteTolerance, relativeTolerance, boost::numeric::odeint::runge_kutta_fehlberg78<std::vector<double>>()));
-                return std::make_shared<OdeintStepSolver<controlledStepperType>>(controlledStepper);
+                return CreateOdeintStepSolver<boost::numeric::odeint::runge_kutta_fehlberg78>(absoluteTolerance, relativeTolerance, useEigenStates);
             }
             else if (controlledSolver == "rosenbrock4_controller") // TODO: this does not seem to work
             {
@@ -93,7 +127,47 @@ namespace PySysLinkBase
             {
                 spdlog::get("default_pysyslink")->debug("Tolerance not found in configuration, using default value: {}", tolerance);
             }
-            return std::make_shared<EulerBackwardStepSolver>(maximumIterations, tolerance);
+            bool useModifiedNewton = false;
+            try
+            {
+                useModifiedNewton = ConfigurationValueManager::TryGetConfigurationValue<bool>("ModifiedNewton", solverConfiguration);
+            }
+            catch (std::out_of_range const& ex)
+            {
+                spdlog::get("default_pysyslink")->debug("Modified Newton not found in configuration, using default value: {}", useModifiedNewton);
+            }
+            return std::make_shared<EulerBackwardStepSolver>(maximumIterations, tolerance, useModifiedNewton);
+        }
+        else if (solverType == "BDF")
+        {
+            double absoluteTolerance = 1e-6;
+            double relativeTolerance = 1e-6;
+            int maximumOrder = 5;
+            try
+            {
+                absoluteTolerance = ConfigurationValueManager::TryGetConfigurationValue<double>("AbsoluteTolerance", solverConfiguration);
+            }
+            catch (std::out_of_range const& ex)
+            {
+                spdlog::get("default_pysyslink")->debug("Absolute tolerance not found in configuration, using default value: {}", absoluteTolerance);
+            }
+            try
+            {
+                relativeTolerance = ConfigurationValueManager::TryGetConfigurationValue<double>("RelativeTolerance", solverConfiguration);
+            }
+            catch (std::out_of_range const& ex)
+            {
+                spdlog::get("default_pysyslink")->debug("Relative tolerance not found in configuration, using default value: {}", relativeTolerance);
+            }
+            try
+            {
+                maximumOrder = ConfigurationValueManager::TryGetConfigurationValue<int>("MaximumOrder", solverConfiguration);
+            }
+            catch (std::out_of_range const& ex)
+            {
+                spdlog::get("default_pysyslink")->debug("Maximum order not found in configuration, using default value: {}", maximumOrder);
+            }
+            return std::make_shared<BdfStepSolver>(absoluteTolerance, relativeTolerance, maximumOrder);
         }
         else
         {
@@ -0,0 +1,247 @@
+#include "DiscreteTimeHitScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include "spdlog/spdlog.h"
+
+namespace PySysLinkBase
+{
+    namespace
+    {
+        // Earliest time on top of the heap, sample times hit at the same time come out in the order they were given
+        struct IsLaterHeapEntry
+        {
+            template <typename T>
+            bool operator()(const T& lhs, const T& rhs) const
+            {
+                if (lhs.time != rhs.time)
+                {
+                    return lhs.time > rhs.time;
+                }
+                return lhs.scheduledSampleTimeIndex > rhs.scheduledSampleTimeIndex;
+            }
+        };
+    }
+
+    DiscreteTimeHitScheduler::DiscreteTimeHitScheduler(std::vector<std::shared_ptr<SampleTime>> discreteSampleTimes, double startTime, double stopTime)
+                                                        : startTime(startTime), stopTime(stopTime)
+    {
+        for (const auto& sampleTime : discreteSampleTimes)
+        {
+            double samplePeriod = sampleTime->GetDiscreteSampleTime();
+            if (!(samplePeriod > 0.0))
+            {
+                throw std::invalid_argument("Discrete sample time must be positive, got " + std::to_string(samplePeriod));
+            }
+            ScheduledSampleTime scheduledSampleTime;
+            scheduledSampleTime.sampleTime = sampleTime;
+            scheduledSampleTime.samplePeriod = samplePeriod;
+            this->scheduledSampleTimes.push_back(scheduledSampleTime);
+        }
+
+        this->hasTickBase = this->TryBuildTickBase();
+        if (!this->hasTickBase)
+        {
+            spdlog::get("default_pysyslink")->debug("Discrete sample times have no common time base, time hits are computed in floating point");
+        }
+
+        this->heap.reserve(this->scheduledSampleTimes.size());
+        for (int i = 0; i < this->scheduledSampleTimes.size(); i++)
+        {
+            this->scheduledSampleTimes[i].numberOfSamples = this->CountSamplesBeforeStopTime(this->scheduledSampleTimes[i]);
+            this->PushNextSample(i);
+        }
+    }
+
+    bool DiscreteTimeHitScheduler::TryBuildTickBase()
+    {
+        const std::int64_t maximumTickDenominator = 1000000000000;
+
+        std::vector<std::pair<std::int64_t, std::int64_t>> fractions;
+        std::int64_t commonDenominator = 1;
+        for (const auto& scheduledSampleTime : this->scheduledSampleTimes)
+        {
+            std::pair<std::int64_t, std::int64_t> fraction = scheduledSampleTime.sampleTime->GetDiscreteSampleTimeFraction();
+            double fractionValue = static_cast<double>(fraction.first) / fraction.second;
+            if (fraction.first <= 0 || std::abs(fractionValue - scheduledSampleTime.samplePeriod) > 1e-12 * scheduledSampleTime.samplePeriod)
+            {
+                return false;
+            }
+            fractions.push_back(fraction);
+
+            std::int64_t factor = fraction.second / std::gcd(commonDenominator, fraction.second);
+            if (commonDenominator > maximumTickDenominator / factor)
+            {
+                return false;
+            }
+            commonDenominator *= factor;
+        }
+
+        // Periods over the common denominator, their greatest common divisor is the tick
+        std::vector<std::int64_t> scaledNumerators;
+        std::int64_t commonNumerator = 0;
+        for (const auto& [numerator, denominator] : fractions)
+        {
+            std::int64_t scale = commonDenominator / denominator;
+            if (numerator > std::numeric_limits<std::int64_t>::max() / scale)
+            {
+                return false;
+            }
+            scaledNumerators.push_back(numerator * scale);
+            commonNumerator = std::gcd(commonNumerator, scaledNumerators.back());
+        }
+
+        for (int i = 0; i < this->scheduledSampleTimes.size(); i++)
+        {
+            this->scheduledSampleTimes[i].periodTicks = scaledNumerators[i] / commonNumerator;
+        }
+        this->tickNumerator = commonNumerator;
+        this->tickDenominator = commonDenominator;
+        return true;
+    }
+
+    std::int64_t DiscreteTimeHitScheduler::CountSamplesBeforeStopTime(const ScheduledSampleTime& scheduledSampleTime) const
+    {
+        if (this->hasTickBase)
+        {
+            long double rangeTicks = static_cast<long double>(this->stopTime - this->startTime) * this->tickDenominator / this->tickNumerator;
+            long double nearestRangeTicks = std::round(rangeTicks);
+            // A range that is a whole number of ticks up to rounding is taken as exact
+            if (std::abs(rangeTicks - nearestRangeTicks) <= 1e-9L * std::max(1.0L, nearestRangeTicks))
+            {
+                return static_cast<std::int64_t>(nearestRangeTicks) / scheduledSampleTime.periodTicks;
+            }
+            return static_cast<std::int64_t>(std::floor(rangeTicks / scheduledSampleTime.periodTicks));
+        }
+        return static_cast<std::int64_t>((this->stopTime - this->startTime) / scheduledSampleTime.samplePeriod);
+    }
+
+    double DiscreteTimeHitScheduler::GetTimeOfSampleIndex(const ScheduledSampleTime& scheduledSampleTime, std::int64_t sampleIndex) const
+    {
+        if (this->hasTickBase)
+        {
+            // Same tick, same time: the time only depends on the integer tick count
+            long double ticks = static_cast<long double>(sampleIndex) * scheduledSampleTime.periodTicks;
+            return this->startTime + static_cast<double>(ticks * this->tickNumerator / this->tickDenominator);
+        }
+        return this->startTime + sampleIndex * scheduledSampleTime.samplePeriod;
+    }
+
+    bool DiscreteTimeHitScheduler::TryGetTimeOfSample(const ScheduledSampleTime& scheduledSampleTime, std::int64_t sampleIndex, double& time) const
+    {
+        if (sampleIndex < scheduledSampleTime.numberOfSamples)
+        {
+            time = this->GetTimeOfSampleIndex(scheduledSampleTime, sampleIndex);
+            return true;
+        }
+        if (sampleIndex == scheduledSampleTime.numberOfSamples && this->GetTimeOfSampleIndex(scheduledSampleTime, scheduledSampleTime.numberOfSamples - 1) < this->stopTime)
+        {
+            time = this->stopTime;
+            return true;
+        }
+        return false;
+    }
+
+    void DiscreteTimeHitScheduler::PushNextSample(int scheduledSampleTimeIndex)
+    {
+        const ScheduledSampleTime& scheduledSampleTime = this->scheduledSampleTimes[scheduledSampleTimeIndex];
+        double time;
+        if (this->TryGetTimeOfSample(scheduledSampleTime, scheduledSampleTime.nextSampleIndex, time))
+        {
+            this->heap.push_back({time, scheduledSampleTimeIndex});
+            std::push_heap(this->heap.begin(), this->heap.end(), IsLaterHeapEntry());
+        }
+    }
+
+    bool DiscreteTimeHitScheduler::HasNextTimeHit() const
+    {
+        return !this->heap.empty();
+    }
+
+    double DiscreteTimeHitScheduler::GetNextTimeHit() const
+    {
+        if (this->heap.empty())
+        {
+            throw std::out_of_range("There are no discrete time hits left");
+        }
+        return this->heap.front().time;
+    }
+
+    std::vector<std::shared_ptr<SampleTime>> DiscreteTimeHitScheduler::PopNextTimeHit()
+    {
+        double time = this->GetNextTimeHit();
+        std::vector<int> hitScheduledSampleTimes;
+        while (!this->heap.empty() && this->heap.front().time == time)
+        {
+            std::pop_heap(this->heap.begin(), this->heap.end(), IsLaterHeapEntry());
+            hitScheduledSampleTimes.push_back(this->heap.back().scheduledSampleTimeIndex);
+            this->heap.pop_back();
+        }
+
+        std::vector<std::shared_ptr<SampleTime>> sampleTimes;
+        sampleTimes.reserve(hitScheduledSampleTimes.size());
+        for (int scheduledSampleTimeIndex : hitScheduledSampleTimes)
+        {
+            sampleTimes.push_back(this->scheduledSampleTimes[scheduledSampleTimeIndex].sampleTime);
+            this->scheduledSampleTimes[scheduledSampleTimeIndex].nextSampleIndex += 1;
+            this->PushNextSample(scheduledSampleTimeIndex);
+        }
+        return sampleTimes;
+    }
+
+    void DiscreteTimeHitScheduler::SkipTimeHitsUpTo(double time)
+    {
+        this->heap.clear();
+        for (int i = 0; i < this->scheduledSampleTimes.size(); i++)
+        {
+            ScheduledSampleTime& scheduledSampleTime = this->scheduledSampleTimes[i];
+            // Start one sample early so rounding of the estimate can not skip a hit
+            double elapsedSamples = std::floor((time - this->startTime) / scheduledSampleTime.samplePeriod) - 1.0;
+            scheduledSampleTime.nextSampleIndex = std::clamp<double>(elapsedSamples, 0.0, scheduledSampleTime.numberOfSamples);
+            double sampleTime;
+            while (this->TryGetTimeOfSample(scheduledSampleTime, scheduledSampleTime.nextSampleIndex, sampleTime) && sampleTime <= time)
+            {
+                scheduledSampleTime.nextSampleIndex += 1;
+            }
+            this->PushNextSample(i);
+        }
+    }
+
+    std::tuple<double, std::vector<std::shared_ptr<SampleTime>>> DiscreteTimeHitScheduler::GetFirstTimeHitAfter(double time) const
+    {
+        double firstTimeHit = std::numeric_limits<double>::quiet_NaN();
+        std::vector<std::shared_ptr<SampleTime>> sampleTimes = {};
+        if (std::isnan(time))
+        {
+            return {firstTimeHit, sampleTimes};
+        }
+
+        for (const auto& scheduledSampleTime : this->scheduledSampleTimes)
+        {
+            std::int64_t sampleIndex = std::max(0.0, std::floor((time - this->startTime) / scheduledSampleTime.samplePeriod) + 1.0);
+            while (this->GetTimeOfSampleIndex(scheduledSampleTime, sampleIndex) <= time)
+            {
+                sampleIndex += 1;
+            }
+            while (sampleIndex > 0 && this->GetTimeOfSampleIndex(scheduledSampleTime, sampleIndex - 1) > time)
+            {
+                sampleIndex -= 1;
+            }
+
+            double timeHit = this->GetTimeOfSampleIndex(scheduledSampleTime, sampleIndex);
+            if (std::isnan(firstTimeHit) || timeHit < firstTimeHit)
+            {
+                firstTimeHit = timeHit;
+                sampleTimes = {scheduledSampleTime.sampleTime};
+            }
+            else if (timeHit == firstTimeHit)
+            {
+                sampleTimes.push_back(scheduledSampleTime.sampleTime);
+            }
+        }
+        return {firstTimeHit, sampleTimes};
+    }
+} // namespace PySysLinkBase
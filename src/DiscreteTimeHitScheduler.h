@@ -0,0 +1,69 @@
+#ifndef SRC_DISCRETE_TIME_HIT_SCHEDULER
+#define SRC_DISCRETE_TIME_HIT_SCHEDULER
+
+#include "SampleTime.h"
+
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace PySysLinkBase
+{
+    // Yields the time hits of the discrete sample times in order, computing each one when it is reached.
+    // A min-heap holds the next hit of every sample time, memory does not grow with the simulated range.
+    // Hits are counted in integer ticks of a time base shared by all the periods, so hits of different periods that
+    // coincide, such as the third of 0.1 and the first of 0.3, get the very same time and are merged.
+    class DiscreteTimeHitScheduler
+    {
+        public:
+        DiscreteTimeHitScheduler(std::vector<std::shared_ptr<SampleTime>> discreteSampleTimes, double startTime, double stopTime);
+
+        bool HasNextTimeHit() const;
+        double GetNextTimeHit() const;
+        // Removes the next time hit and returns the sample times hit on it, in the order they were given
+        std::vector<std::shared_ptr<SampleTime>> PopNextTimeHit();
+        // Drops every time hit up to and including time
+        void SkipTimeHitsUpTo(double time);
+        // Earliest hit strictly after time of any sample time, with no regard to the stop time. Not a hit when time is NaN
+        std::tuple<double, std::vector<std::shared_ptr<SampleTime>>> GetFirstTimeHitAfter(double time) const;
+
+        private:
+        struct ScheduledSampleTime
+        {
+            std::shared_ptr<SampleTime> sampleTime;
+            double samplePeriod;
+            std::int64_t periodTicks = 0;
+            std::int64_t numberOfSamples = 0;
+            std::int64_t nextSampleIndex = 0;
+        };
+
+        struct HeapEntry
+        {
+            double time;
+            int scheduledSampleTimeIndex;
+        };
+
+        double startTime;
+        double stopTime;
+
+        // A tick lasts tickNumerator / tickDenominator seconds, the greatest common divisor of the periods.
+        // Periods that are not close enough to a fraction leave the scheduler without ticks, on floating point sample times
+        bool hasTickBase = false;
+        std::int64_t tickNumerator = 1;
+        std::int64_t tickDenominator = 1;
+
+        bool TryBuildTickBase();
+        std::int64_t CountSamplesBeforeStopTime(const ScheduledSampleTime& scheduledSampleTime) const;
+        double GetTimeOfSampleIndex(const ScheduledSampleTime& scheduledSampleTime, std::int64_t sampleIndex) const;
+
+        std::vector<ScheduledSampleTime> scheduledSampleTimes;
+        std::vector<HeapEntry> heap;
+
+        // Samples start at startTime every period, the last hit of every sample time is on stopTime
+        bool TryGetTimeOfSample(const ScheduledSampleTime& scheduledSampleTime, std::int64_t sampleIndex, double& time) const;
+        void PushNextSample(int scheduledSampleTimeIndex);
+    };
+} // namespace PySysLinkBase
+
+#endif /* SRC_DISCRETE_TIME_HIT_SCHEDULER */
@@ -2,61 +2,31 @@
 
 namespace PySysLinkBase
 {
-    FullySupportedSignalValue ConvertToFullySupportedSignalValue(const std::shared_ptr<UnknownTypeSignalValue>& unknownValue)
+    template<typename T>
+    bool TryConvertTyped(const UnknownTypeSignalValue& unknownValue, SignalTypeId signalTypeId, FullySupportedSignalValue& result)
     {
-        try {
-            if (auto intValue = unknownValue->TryCastToTyped<int>()) {
-                return FullySupportedSignalValue(intValue->GetPayload());
-            }
-        } catch (const std::bad_cast&) {}
-
-        try {
-            if (auto doubleValue = unknownValue->TryCastToTyped<double>()) {
-                return FullySupportedSignalValue(doubleValue->GetPayload());
-            }
-        } catch (const std::bad_cast&) {}
-
-        try {
-            if (auto boolValue = unknownValue->TryCastToTyped<bool>()) {
-                return FullySupportedSignalValue(boolValue->GetPayload());
-            }
-        } catch (const std::bad_cast&) {}
-
-        try {
-            if (auto complexValue = unknownValue->TryCastToTyped<std::complex<double>>()) {
-                return FullySupportedSignalValue(complexValue->GetPayload());
-            }
-        } catch (const std::bad_cast&) {}
-
-        try {
-            if (auto stringValue = unknownValue->TryCastToTyped<std::string>()) {
-                return FullySupportedSignalValue(stringValue->GetPayload());
-            }
-        } catch (const std::bad_cast&) {}
-
-        try {
-            if (auto stringValue = unknownValue->TryCastToTyped<IntMatrix>()) {
-                return FullySupportedSignalValue(stringValue->GetPayload());
-            }
-        } catch (const std::bad_cast&) {}
-
-        try {
-            if (auto stringValue = unknownValue->TryCastToTyped<DoubleMatrix>()) {
-                return FullySupportedSignalValue(stringValue->GetPayload());
-            }
-        } catch (const std::bad_cast&) {}
+        if (signalTypeId != GetSignalTypeId<T>())
+        {
+            return false;
+        }
+        result = unknownValue.TryCastToTypedReference<T>().GetPayloadReference();
+        return true;
+    }
 
-        try {
-            if (auto stringValue = unknownValue->TryCastToTyped<BoolMatrix>()) {
-                return FullySupportedSignalValue(stringValue->GetPayload());
-            }
-        } catch (const std::bad_cast&) {}
+    template<typename... Ts>
+    bool TryConvertToAlternative(const UnknownTypeSignalValue& unknownValue, FullySupportedSignalValue& result, std::variant<Ts...>*)
+    {
+        const SignalTypeId signalTypeId = unknownValue.GetSignalTypeId();
+        return (TryConvertTyped<Ts>(unknownValue, signalTypeId, result) || ...);
+    }
 
-        try {
-            if (auto stringValue = unknownValue->TryCastToTyped<ComplexMatrix>()) {
-                return FullySupportedSignalValue(stringValue->GetPayload());
-            }
-        } catch (const std::bad_cast&) {}
+    FullySupportedSignalValue ConvertToFullySupportedSignalValue(const std::shared_ptr<UnknownTypeSignalValue>& unknownValue)
+    {
+        FullySupportedSignalValue result;
+        if (TryConvertToAlternative(*unknownValue, result, static_cast<FullySupportedSignalValue*>(nullptr)))
+        {
+            return result;
+        }
 
         throw std::runtime_error("UnknownTypeSignalValue cannot be converted to FullySupportedSignalValue");
     }
@@ -126,12 +126,12 @@ namespace PySysLinkBase
         return outputPorts;
     }
 
-    void ISimulationBlock::RegisterReadInputsCallbacks(std::function<void (const std::string, const std::vector<std::shared_ptr<PySysLinkBase::InputPort>>, std::shared_ptr<PySysLinkBase::SampleTime>, double)> callback)
+    void ISimulationBlock::RegisterReadInputsCallbacks(std::function<void (const std::string&, const std::vector<std::shared_ptr<PySysLinkBase::InputPort>>&, std::shared_ptr<PySysLinkBase::SampleTime>, double)> callback)
     {
         this->readInputCallbacks.push_back(callback);
     }
 
-    void ISimulationBlock::RegisterCalculateOutputCallbacks(std::function<void (const std::string, const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>>, std::shared_ptr<PySysLinkBase::SampleTime>, double)> callback)
+    void ISimulationBlock::RegisterCalculateOutputCallbacks(std::function<void (const std::string&, const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>>&, std::shared_ptr<PySysLinkBase::SampleTime>, double)> callback)
     {
         this->calculateOutputCallbacks.push_back(callback);
     }
@@ -29,8 +29,8 @@ namespace PySysLinkBase
         std::vector<PortTypeMetadata> inputPortTypes;
         std::vector<PortTypeMetadata> outputPortTypes;
 
-        std::vector<std::function<void (const std::string, const std::vector<std::shared_ptr<PySysLinkBase::InputPort>>, std::shared_ptr<PySysLinkBase::SampleTime>, double)>> readInputCallbacks;
-        std::vector<std::function<void (const std::string, const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>>, std::shared_ptr<PySysLinkBase::SampleTime>, double)>> calculateOutputCallbacks;
+        std::vector<std::function<void (const std::string&, const std::vector<std::shared_ptr<PySysLinkBase::InputPort>>&, std::shared_ptr<PySysLinkBase::SampleTime>, double)>> readInputCallbacks;
+        std::vector<std::function<void (const std::string&, const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>>&, std::shared_ptr<PySysLinkBase::SampleTime>, double)>> calculateOutputCallbacks;
         std::vector<std::function<void (const std::string, const std::string, const ConfigurationValue)>> updateConfigurationValueCallbacks;
     public:
         const std::string GetId() const;
@@ -63,8 +63,8 @@ namespace PySysLinkBase
 
         static std::shared_ptr<ISimulationBlock> FindBlockById(std::string id, const std::vector<std::shared_ptr<ISimulationBlock>>& blocksToFind);
 
-        void RegisterReadInputsCallbacks(std::function<void (const std::string, const std::vector<std::shared_ptr<PySysLinkBase::InputPort>>, std::shared_ptr<PySysLinkBase::SampleTime>, double)> callback);
-        void RegisterCalculateOutputCallbacks(std::function<void (const std::string, const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>>, std::shared_ptr<PySysLinkBase::SampleTime>, double)> callback);
+        void RegisterReadInputsCallbacks(std::function<void (const std::string&, const std::vector<std::shared_ptr<PySysLinkBase::InputPort>>&, std::shared_ptr<PySysLinkBase::SampleTime>, double)> callback);
+        void RegisterCalculateOutputCallbacks(std::function<void (const std::string&, const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>>&, std::shared_ptr<PySysLinkBase::SampleTime>, double)> callback);
         void RegisterUpdateConfigurationValueCallbacks(std::function<void (const std::string, const std::string, const ConfigurationValue)> callback);
 
         virtual const std::vector<std::pair<double, double>> GetEvents(const std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double eventTime, std::vector<double> eventTimeStates, bool includeKnownEvents=false) const
@@ -76,6 +76,16 @@ namespace PySysLinkBase
         {
             return {};
         }
+
+        // Internal state other than port values and continuous states, stored as an opaque blob in simulation checkpoints
+        virtual std::vector<unsigned char> GetCheckpointState() const
+        {
+            return {};
+        }
+
+        virtual void RestoreCheckpointState(const std::vector<unsigned char>& checkpointState)
+        {
+        }
     };
 }
 
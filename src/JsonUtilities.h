@@ -0,0 +1,37 @@
+#ifndef SRC_JSON_UTILITIES
+#define SRC_JSON_UTILITIES
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace PySysLinkBase
+{
+    // Escapes a string to be written between quotes in a JSON document
+    inline std::string escapeJson(const std::string& s) {
+        std::ostringstream o;
+        for (char c : s) {
+            switch (c) {
+                case '\"': o << "\\\""; break;
+                case '\\': o << "\\\\"; break;
+                case '\b': o << "\\b";  break;
+                case '\f': o << "\\f";  break;
+                case '\n': o << "\\n";  break;
+                case '\r': o << "\\r";  break;
+                case '\t': o << "\\t";  break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        // control characters → \u00XX
+                        o << "\\u"
+                          << std::hex << std::setw(4) << std::setfill('0')
+                          << (int)(unsigned char)c;
+                    } else {
+                        o << c;
+                    }
+            }
+        }
+        return o.str();
+    }
+} // namespace PySysLinkBase
+
+#endif /* SRC_JSON_UTILITIES */
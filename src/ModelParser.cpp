@@ -59,6 +59,11 @@ namespace PySysLinkBase
     }
     
     std::shared_ptr<SimulationModel> ModelParser::ParseFromYaml(std::string filename, const std::map<std::string, std::shared_ptr<IBlockFactory>>& blockFactories, std::shared_ptr<IBlockEventsHandler> blockEventsHandler)
+    {
+        return ModelParser::BuildModel(ModelParser::ParseConfigurationFromYaml(filename), blockFactories, blockEventsHandler);
+    }
+
+    ModelConfiguration ModelParser::ParseConfigurationFromYaml(std::string filename)
     {
         YAML::Node config;
         try
@@ -112,9 +117,14 @@ namespace PySysLinkBase
 
         spdlog::get("default_pysyslink")->debug("Configurations parsed");
 
-        std::vector<std::shared_ptr<ISimulationBlock>> blocks = ModelParser::ParseBlocks(blocksConfigurations, blockFactories, blockEventsHandler);
+        return {std::move(blocksConfigurations), std::move(linksConfigurations)};
+    }
+
+    std::shared_ptr<SimulationModel> ModelParser::BuildModel(const ModelConfiguration& modelConfiguration, const std::map<std::string, std::shared_ptr<IBlockFactory>>& blockFactories, std::shared_ptr<IBlockEventsHandler> blockEventsHandler)
+    {
+        std::vector<std::shared_ptr<ISimulationBlock>> blocks = ModelParser::ParseBlocks(modelConfiguration.blocksConfigurations, blockFactories, blockEventsHandler);
         spdlog::get("default_pysyslink")->debug("Blocks parsed");
-        std::vector<std::shared_ptr<PortLink>> links = ModelParser::ParseLinks(linksConfigurations, blocks);
+        std::vector<std::shared_ptr<PortLink>> links = ModelParser::ParseLinks(modelConfiguration.linksConfigurations, blocks);
         
         spdlog::get("default_pysyslink")->debug("Blocks and links parsed");
 
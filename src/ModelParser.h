@@ -16,6 +16,13 @@ namespace PySysLinkBase
         std::string keyName;
         std::string typeName;
     };
+
+    // Block and link configurations read from a model file, before any block is created
+    struct ModelConfiguration
+    {
+        std::vector<std::map<std::string, ConfigurationValue>> blocksConfigurations;
+        std::vector<std::map<std::string, ConfigurationValue>> linksConfigurations;
+    };
     
     class ModelParser
     {
@@ -27,6 +34,8 @@ namespace PySysLinkBase
             static std::complex<double> ParseComplex(const std::string& str);
             static ParsedConfigurationKey ParseConfigurationKey(const std::string& rawKey);
             static ConfigurationValue YamlToConfigurationValue(const YAML::Node& node, const std::string& typeName);
+            static ModelConfiguration ParseConfigurationFromYaml(std::string filename);
+            static std::shared_ptr<SimulationModel> BuildModel(const ModelConfiguration& modelConfiguration, const std::map<std::string, std::shared_ptr<IBlockFactory>>& blockFactories, std::shared_ptr<IBlockEventsHandler> blockEventsHandler);
             static std::shared_ptr<SimulationModel> ParseFromYaml(std::string filename, const std::map<std::string, std::shared_ptr<IBlockFactory>>& blockFactories, std::shared_ptr<IBlockEventsHandler> blockEventsHandler);
     };
 } // namespace PySysLinkBase
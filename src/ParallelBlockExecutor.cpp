@@ -0,0 +1,158 @@
+#include "ParallelBlockExecutor.h"
+#include <stdexcept>
+#include <string>
+
+namespace PySysLinkBase
+{
+    ParallelBlockExecutor::ParallelBlockExecutor(int numberOfThreads) : numberOfThreads(numberOfThreads)
+    {
+        if (this->numberOfThreads < 1)
+        {
+            throw std::invalid_argument("Number of threads must be at least 1, got " + std::to_string(this->numberOfThreads));
+        }
+
+        this->taskRanges = std::make_unique<TaskRange[]>(this->numberOfThreads);
+
+        // The calling thread works as worker 0
+        for (int workerIndex = 1; workerIndex < this->numberOfThreads; workerIndex++)
+        {
+            this->workers.emplace_back(&ParallelBlockExecutor::WorkerLoop, this, workerIndex);
+        }
+    }
+
+    ParallelBlockExecutor::~ParallelBlockExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->batchMutex);
+            this->isShuttingDown = true;
+            this->batchGeneration.fetch_add(1, std::memory_order_release);
+        }
+        this->batchCondition.notify_all();
+
+        for (auto& worker : this->workers)
+        {
+            if (worker.joinable())
+            {
+                worker.join();
+            }
+        }
+    }
+
+    int ParallelBlockExecutor::GetNumberOfThreads() const
+    {
+        return this->numberOfThreads;
+    }
+
+    void ParallelBlockExecutor::Run(int taskCount, const std::function<void (int)>& task)
+    {
+        if (taskCount <= 0)
+        {
+            return;
+        }
+        if (this->numberOfThreads == 1 || taskCount == 1)
+        {
+            for (int i = 0; i < taskCount; i++)
+            {
+                task(i);
+            }
+            return;
+        }
+
+        for (int workerIndex = 0; workerIndex < this->numberOfThreads; workerIndex++)
+        {
+            this->taskRanges[workerIndex].next.store(taskCount * workerIndex / this->numberOfThreads, std::memory_order_relaxed);
+            this->taskRanges[workerIndex].end = taskCount * (workerIndex + 1) / this->numberOfThreads;
+        }
+        this->currentTask = &task;
+        this->firstException = nullptr;
+        this->pendingTasks.store(taskCount, std::memory_order_relaxed);
+        this->activeWorkers.store(this->numberOfThreads - 1, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(this->batchMutex);
+            this->batchGeneration.fetch_add(1, std::memory_order_release);
+        }
+        this->batchCondition.notify_all();
+
+        this->ProcessBatch(0);
+
+        // Every worker has to leave the batch before its ranges can be reused
+        while (this->pendingTasks.load(std::memory_order_acquire) != 0 || this->activeWorkers.load(std::memory_order_acquire) != 0)
+        {
+            std::this_thread::yield();
+        }
+        this->currentTask = nullptr;
+
+        if (this->firstException)
+        {
+            std::rethrow_exception(this->firstException);
+        }
+    }
+
+    void ParallelBlockExecutor::WorkerLoop(int workerIndex)
+    {
+        unsigned long long seenGeneration = 0;
+        while (true)
+        {
+            // Spin for a short while, batches usually come in bursts of one per level
+            int spins = 0;
+            while (this->batchGeneration.load(std::memory_order_acquire) == seenGeneration && spins < 4096)
+            {
+                std::this_thread::yield();
+                spins++;
+            }
+            if (this->batchGeneration.load(std::memory_order_acquire) == seenGeneration)
+            {
+                std::unique_lock<std::mutex> lock(this->batchMutex);
+                this->batchCondition.wait(lock, [&]{ return this->batchGeneration.load(std::memory_order_acquire) != seenGeneration; });
+            }
+
+            seenGeneration = this->batchGeneration.load(std::memory_order_acquire);
+            {
+                std::lock_guard<std::mutex> lock(this->batchMutex);
+                if (this->isShuttingDown)
+                {
+                    return;
+                }
+            }
+
+            this->ProcessBatch(workerIndex);
+            this->activeWorkers.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    void ParallelBlockExecutor::ProcessBatch(int workerIndex)
+    {
+        while (this->TryRunTaskFromRange(this->taskRanges[workerIndex]));
+
+        for (int offset = 1; offset < this->numberOfThreads; offset++)
+        {
+            TaskRange& victimRange = this->taskRanges[(workerIndex + offset) % this->numberOfThreads];
+            while (this->TryRunTaskFromRange(victimRange));
+        }
+    }
+
+    bool ParallelBlockExecutor::TryRunTaskFromRange(TaskRange& taskRange)
+    {
+        const int taskIndex = taskRange.next.fetch_add(1, std::memory_order_relaxed);
+        if (taskIndex >= taskRange.end)
+        {
+            return false;
+        }
+
+        try
+        {
+            (*this->currentTask)(taskIndex);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(this->exceptionMutex);
+            if (!this->firstException)
+            {
+                this->firstException = std::current_exception();
+            }
+        }
+        this->pendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+} // namespace PySysLinkBase
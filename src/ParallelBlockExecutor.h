@@ -0,0 +1,60 @@
+#ifndef SRC_PARALLEL_BLOCK_EXECUTOR
+#define SRC_PARALLEL_BLOCK_EXECUTOR
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace PySysLinkBase
+{
+    // Fixed pool of worker threads that runs batches of independent tasks.
+    // Each batch is split in one contiguous range per thread; threads that finish their own range steal from the others.
+    class ParallelBlockExecutor
+    {
+        public:
+        ParallelBlockExecutor(int numberOfThreads);
+        ~ParallelBlockExecutor();
+
+        ParallelBlockExecutor(const ParallelBlockExecutor&) = delete;
+        ParallelBlockExecutor& operator=(const ParallelBlockExecutor&) = delete;
+
+        // Calls task(i) for every i in [0, taskCount) and returns once all of them are done.
+        // The calling thread takes part in the work. The first exception thrown by a task is rethrown here.
+        void Run(int taskCount, const std::function<void (int)>& task);
+
+        int GetNumberOfThreads() const;
+
+        private:
+        struct alignas(64) TaskRange
+        {
+            std::atomic<int> next{0};
+            int end = 0;
+        };
+
+        int numberOfThreads;
+        std::vector<std::thread> workers;
+        std::unique_ptr<TaskRange[]> taskRanges;
+
+        const std::function<void (int)>* currentTask = nullptr;
+        std::atomic<int> pendingTasks{0};
+        std::atomic<int> activeWorkers{0};
+        std::atomic<unsigned long long> batchGeneration{0};
+        bool isShuttingDown = false;
+        std::mutex batchMutex;
+        std::condition_variable batchCondition;
+
+        std::mutex exceptionMutex;
+        std::exception_ptr firstException;
+
+        void WorkerLoop(int workerIndex);
+        void ProcessBatch(int workerIndex);
+        bool TryRunTaskFromRange(TaskRange& taskRange);
+    };
+} // namespace PySysLinkBase
+
+#endif /* SRC_PARALLEL_BLOCK_EXECUTOR */
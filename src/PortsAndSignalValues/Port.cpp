@@ -12,9 +12,21 @@ namespace PySysLinkBase
 
     void Port::TryCopyValueToPort(Port &otherPort) const
     {
-        if (this->GetValue()->GetTypeId() == otherPort.GetValue()->GetTypeId())
+        if (!this->value || !otherPort.value)
         {
-            otherPort.SetValue(this->GetValue()->clone());
+            throw std::runtime_error("Value was null, should not be");
+        }
+
+        // Once the other port holds its own copy, later transfers reuse it and only assign the payload
+        if (otherPort.isValueOwnedByPort && otherPort.value->TryCopyPayloadFrom(*this->value))
+        {
+            return;
+        }
+
+        if (this->value->GetSignalTypeId() == otherPort.value->GetSignalTypeId())
+        {
+            otherPort.value = this->value->clone();
+            otherPort.isValueOwnedByPort = true;
         }
         else
         {
@@ -25,7 +37,9 @@ namespace PySysLinkBase
     void Port::SetValue(std::shared_ptr<UnknownTypeSignalValue> value)
     {
         this->value = value;
+        this->isValueOwnedByPort = false;
     }
+
     std::shared_ptr<UnknownTypeSignalValue> Port::GetValue() const
     {
         if (!this->value)
@@ -34,4 +48,13 @@ namespace PySysLinkBase
         }
         return this->value->clone();
     }
+
+    const UnknownTypeSignalValue& Port::GetValueReference() const
+    {
+        if (!this->value)
+        {
+            throw std::runtime_error("Value was null, should not be");
+        }
+        return *this->value;
+    }
 } // namespace PySysLinkBase
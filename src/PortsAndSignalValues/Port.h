@@ -14,6 +14,7 @@ namespace PySysLinkBase
     class Port {
     protected:
         std::shared_ptr<UnknownTypeSignalValue> value;
+        bool isValueOwnedByPort = false; // True when value is a private copy made by TryCopyValueToPort
         
     public:
         Port(std::shared_ptr<UnknownTypeSignalValue> value);
@@ -22,6 +23,7 @@ namespace PySysLinkBase
 
         void SetValue(std::shared_ptr<UnknownTypeSignalValue> value);
         std::shared_ptr<UnknownTypeSignalValue> GetValue() const;
+        const UnknownTypeSignalValue& GetValueReference() const;
 
         bool operator==(const Port& rhs) const
         {
@@ -0,0 +1,41 @@
+#ifndef SRC_PORTS_AND_SIGNAL_VALUES_SIGNAL_TYPE_ID
+#define SRC_PORTS_AND_SIGNAL_VALUES_SIGNAL_TYPE_ID
+
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+
+namespace PySysLinkBase
+{
+    using SignalTypeId = std::uint64_t;
+
+    // FNV-1a hash of the mangled type name. Plugins link their own copy of the library,
+    // so ids must not depend on addresses or on the order types are first seen.
+    inline SignalTypeId ComputeSignalTypeId(const char* mangledTypeName)
+    {
+        SignalTypeId hash = 14695981039346656037ULL;
+        for (const char* c = mangledTypeName; *c != '\0'; c++)
+        {
+            hash ^= static_cast<unsigned char>(*c);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    SignalTypeId GetSignalTypeId()
+    {
+        static const SignalTypeId signalTypeId = ComputeSignalTypeId(typeid(T).name());
+        return signalTypeId;
+    }
+
+    // Only meant for diagnostics, ids are what gets compared
+    template <typename T>
+    const std::string& GetSignalTypeName()
+    {
+        static const std::string signalTypeName = std::to_string(typeid(T).hash_code()) + typeid(T).name();
+        return signalTypeName;
+    }
+} // namespace PySysLinkBase
+
+#endif /* SRC_PORTS_AND_SIGNAL_VALUES_SIGNAL_TYPE_ID */
@@ -26,7 +26,22 @@ namespace PySysLinkBase
 
             const std::string GetTypeId() const
             {
-                return std::to_string(typeid(T).hash_code()) + typeid(T).name();
+                return PySysLinkBase::GetSignalTypeName<T>();
+            }
+
+            SignalTypeId GetSignalTypeId() const override
+            {
+                return PySysLinkBase::GetSignalTypeId<T>();
+            }
+
+            bool TryCopyPayloadFrom(const UnknownTypeSignalValue& other) override
+            {
+                if (other.GetSignalTypeId() != PySysLinkBase::GetSignalTypeId<T>())
+                {
+                    return false;
+                }
+                this->payload = static_cast<const SignalValue<T>&>(other).payload;
+                return true;
             }
 
             bool IsInitialized() const {
@@ -41,6 +56,14 @@ namespace PySysLinkBase
                 return *payload;
             }
 
+            const T& GetPayloadReference() const
+            {
+                if (!payload) {
+                    throw std::runtime_error("SignalValue accessed before initialization");
+                }
+                return *payload;
+            }
+
             void SetPayload(T newPayload)
             {
                 this->payload = newPayload;
@@ -4,6 +4,8 @@
 #include <string>
 #include <memory>
 #include <stdexcept>
+#include <typeinfo>
+#include "SignalTypeId.h"
 
 namespace PySysLinkBase
 {
@@ -17,6 +19,7 @@ namespace PySysLinkBase
 
             virtual ~UnknownTypeSignalValue() = default;
             virtual const std::string GetTypeId() const = 0;
+            virtual SignalTypeId GetSignalTypeId() const = 0;
 
             template <typename T>
             std::unique_ptr<SignalValue<T>> TryCastToTyped()
@@ -28,6 +31,17 @@ namespace PySysLinkBase
                 return std::make_unique<SignalValue<T>>(*typedPtr);
             }
 
+            template <typename T>
+            const SignalValue<T>& TryCastToTypedReference() const
+            {
+                if (this->GetSignalTypeId() != PySysLinkBase::GetSignalTypeId<T>()) throw std::bad_cast();
+
+                return static_cast<const SignalValue<T>&>(*this);
+            }
+
+            // Assigns the payload of other in place, returns false without changes if the types differ
+            virtual bool TryCopyPayloadFrom(const UnknownTypeSignalValue& other) = 0;
+
             virtual std::unique_ptr<UnknownTypeSignalValue> clone() const = 0;
     };
 } // namespace PySysLinkBase
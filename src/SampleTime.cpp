@@ -101,6 +101,36 @@ namespace PySysLinkBase
         }
     }
 
+    const std::pair<std::int64_t, std::int64_t> SampleTime::GetDiscreteSampleTimeFraction(std::int64_t maximumDenominator) const
+    {
+        double period = this->GetDiscreteSampleTime();
+
+        // Convergents of the continued fraction of the period
+        std::int64_t previousNumerator = 1, numerator = static_cast<std::int64_t>(std::floor(period));
+        std::int64_t previousDenominator = 0, denominator = 1;
+        double remainder = period - std::floor(period);
+        while (remainder > 0.0 && std::abs(period - static_cast<double>(numerator) / denominator) > 1e-15 * period)
+        {
+            double inverse = 1.0 / remainder;
+            // A term that is an integer up to rounding ends the expansion, floating point error must not add spurious terms
+            bool isLastTerm = std::abs(inverse - std::round(inverse)) < 1e-9 * inverse;
+            double termValue = isLastTerm ? std::round(inverse) : std::floor(inverse);
+            if (termValue > static_cast<double>((maximumDenominator - previousDenominator) / denominator))
+            {
+                break;
+            }
+            std::int64_t term = static_cast<std::int64_t>(termValue);
+            std::int64_t nextNumerator = term * numerator + previousNumerator;
+            std::int64_t nextDenominator = term * denominator + previousDenominator;
+            previousNumerator = numerator;
+            previousDenominator = denominator;
+            numerator = nextNumerator;
+            denominator = nextDenominator;
+            remainder = isLastTerm ? 0.0 : inverse - termValue;
+        }
+        return {numerator, denominator};
+    }
+
     const int SampleTime::GetContinuousSampleTimeGroup() const
     {
         if (this->sampleTimeType != SampleTimeType::continuous)
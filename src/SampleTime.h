@@ -6,6 +6,8 @@
 #include <limits>
 #include <string>
 #include <memory>
+#include <cstdint>
+#include <utility>
 
 namespace PySysLinkBase
 {
@@ -43,6 +45,9 @@ namespace PySysLinkBase
             
             const SampleTimeType& GetSampleTimeType() const;
             const double GetDiscreteSampleTime() const;
+            // Closest fraction, numerator and denominator in seconds, to the discrete sample time with a denominator up to maximumDenominator.
+            // Periods written in decimal, such as 0.1 or 0.3, are recovered exactly
+            const std::pair<std::int64_t, std::int64_t> GetDiscreteSampleTimeFraction(std::int64_t maximumDenominator = 1000000000) const;
             const int GetContinuousSampleTimeGroup() const;
             const std::vector<SampleTimeType> GetSupportedSampleTimeTypesForInheritance() const;
             const std::vector<std::shared_ptr<SampleTime>> GetMultirateSampleTimes() const;
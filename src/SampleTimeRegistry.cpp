@@ -0,0 +1,74 @@
+#include "SampleTimeRegistry.h"
+
+#include <stdexcept>
+
+namespace PySysLinkBase
+{
+    int SampleTimeRegistry::Intern(const std::shared_ptr<SampleTime>& sampleTime)
+    {
+        int id = this->FindId(sampleTime);
+        if (id == -1)
+        {
+            id = this->sampleTimes.size();
+            if (sampleTime->GetSampleTimeType() == SampleTimeType::discrete)
+            {
+                this->idOfEachDiscreteSampleTime.insert({sampleTime->GetDiscreteSampleTime(), id});
+            }
+            else if (sampleTime->GetSampleTimeType() == SampleTimeType::continuous)
+            {
+                this->idOfEachContinuousSampleTimeGroup.insert({sampleTime->GetContinuousSampleTimeGroup(), id});
+            }
+            else
+            {
+                throw std::invalid_argument("Only discrete and continuous sample times are interned, got " + SampleTime::SampleTimeTypeString(sampleTime->GetSampleTimeType()));
+            }
+            this->sampleTimes.push_back(sampleTime);
+        }
+
+        if (this->idOfEachInstance.insert({sampleTime.get(), id}).second)
+        {
+            this->internedInstances.push_back(sampleTime);
+        }
+        return id;
+    }
+
+    int SampleTimeRegistry::FindId(const std::shared_ptr<SampleTime>& sampleTime) const
+    {
+        auto instanceId = this->idOfEachInstance.find(sampleTime.get());
+        if (instanceId != this->idOfEachInstance.end())
+        {
+            return instanceId->second;
+        }
+        if (sampleTime->GetSampleTimeType() == SampleTimeType::discrete)
+        {
+            return this->FindDiscreteId(sampleTime->GetDiscreteSampleTime());
+        }
+        if (sampleTime->GetSampleTimeType() == SampleTimeType::continuous)
+        {
+            return this->FindContinuousId(sampleTime->GetContinuousSampleTimeGroup());
+        }
+        return -1;
+    }
+
+    int SampleTimeRegistry::FindDiscreteId(double discreteSampleTime) const
+    {
+        auto it = this->idOfEachDiscreteSampleTime.find(discreteSampleTime);
+        return it == this->idOfEachDiscreteSampleTime.end() ? -1 : it->second;
+    }
+
+    int SampleTimeRegistry::FindContinuousId(int continuousSampleTimeGroup) const
+    {
+        auto it = this->idOfEachContinuousSampleTimeGroup.find(continuousSampleTimeGroup);
+        return it == this->idOfEachContinuousSampleTimeGroup.end() ? -1 : it->second;
+    }
+
+    const std::shared_ptr<SampleTime>& SampleTimeRegistry::GetSampleTime(int id) const
+    {
+        return this->sampleTimes.at(id);
+    }
+
+    int SampleTimeRegistry::GetCount() const
+    {
+        return this->sampleTimes.size();
+    }
+} // namespace PySysLinkBase
@@ -0,0 +1,40 @@
+#ifndef SRC_SAMPLE_TIME_REGISTRY
+#define SRC_SAMPLE_TIME_REGISTRY
+
+#include "SampleTime.h"
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace PySysLinkBase
+{
+    // One canonical sample time for each discrete period and each continuous group, with dense ids in the order they are
+    // first interned. Tables indexed by id replace maps keyed by sample time pointers, and searches for equal sample times
+    class SampleTimeRegistry
+    {
+        public:
+        // Id of the sample time with the same period or group; the first instance interned for them is the canonical one
+        int Intern(const std::shared_ptr<SampleTime>& sampleTime);
+
+        // -1 when no sample time with the same period or group was interned
+        int FindId(const std::shared_ptr<SampleTime>& sampleTime) const;
+        int FindDiscreteId(double discreteSampleTime) const;
+        int FindContinuousId(int continuousSampleTimeGroup) const;
+
+        const std::shared_ptr<SampleTime>& GetSampleTime(int id) const;
+        int GetCount() const;
+
+        private:
+        std::vector<std::shared_ptr<SampleTime>> sampleTimes;
+        std::map<double, int> idOfEachDiscreteSampleTime;
+        std::map<int, int> idOfEachContinuousSampleTimeGroup;
+
+        // Every instance interned, kept alive so its address can not be taken by another sample time
+        std::unordered_map<const SampleTime*, int> idOfEachInstance;
+        std::vector<std::shared_ptr<SampleTime>> internedInstances;
+    };
+} // namespace PySysLinkBase
+
+#endif /* SRC_SAMPLE_TIME_REGISTRY */
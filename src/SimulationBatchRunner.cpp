@@ -0,0 +1,175 @@
+#include "SimulationBatchRunner.h"
+#include "SimulationManager.h"
+#include "BlockEventsHandler.h"
+#include "ISimulationBlock.h"
+#include "JsonUtilities.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include "spdlog/spdlog.h"
+
+namespace PySysLinkBase
+{
+    SimulationBatchRunner::SimulationBatchRunner(ModelConfiguration modelConfiguration, std::map<std::string, std::shared_ptr<IBlockFactory>> blockFactories,
+                                                 std::shared_ptr<SimulationOptions> simulationOptions, int numberOfThreads)
+                                                 : modelConfiguration(std::move(modelConfiguration)), blockFactories(std::move(blockFactories))
+    {
+        if (numberOfThreads < 1)
+        {
+            throw std::invalid_argument("Number of threads of a batch must be at least 1, got " + std::to_string(numberOfThreads));
+        }
+
+        this->simulationOptions = std::make_shared<SimulationOptions>(*simulationOptions);
+        if (this->simulationOptions->saveToFileContinuously)
+        {
+            spdlog::get("default_pysyslink")->warn("Continuous file output is not available in batch runs, outputs are kept in vectors");
+        }
+        this->simulationOptions->saveToFileContinuously = false;
+        this->simulationOptions->saveToVectors = true;
+
+        if (this->simulationOptions->activateProfiling)
+        {
+            spdlog::get("default_pysyslink")->warn("Profiling is not available in batch runs, profile a single run instead");
+        }
+        this->simulationOptions->activateProfiling = false;
+
+        // Runs simulated at the same time already use the threads, pools of their own would multiply them
+        if (numberOfThreads > 1 && (this->simulationOptions->numberOfThreads > 1 || this->simulationOptions->runContinuousGroupsConcurrently))
+        {
+            spdlog::get("default_pysyslink")->warn("Runs of a batch on {} threads are each simulated on a single thread", numberOfThreads);
+            this->simulationOptions->numberOfThreads = 1;
+            this->simulationOptions->runContinuousGroupsConcurrently = false;
+        }
+
+        // Overrides change configuration values, not links, so the order of the nominal model holds for every run
+        std::shared_ptr<SimulationModel> nominalModel = ModelParser::BuildModel(this->modelConfiguration, this->blockFactories, std::make_shared<BlockEventsHandler>());
+        for (const auto& block : SimulationManager::OrderBlocks(nominalModel))
+        {
+            this->orderedBlockIds.push_back(block->GetId());
+        }
+
+        if (numberOfThreads > 1)
+        {
+            this->runExecutor = std::make_unique<ParallelBlockExecutor>(numberOfThreads);
+        }
+    }
+
+    ModelConfiguration SimulationBatchRunner::ApplyOverrides(const SimulationBatchRun& run) const
+    {
+        ModelConfiguration runConfiguration = this->modelConfiguration;
+        for (const auto& [blockId, overrides] : run.blockConfigurationOverrides)
+        {
+            auto blockConfiguration = std::find_if(runConfiguration.blocksConfigurations.begin(), runConfiguration.blocksConfigurations.end(),
+                [&blockId](const std::map<std::string, ConfigurationValue>& configuration)
+                {
+                    return ConfigurationValueManager::TryGetConfigurationValue<std::string>("Id", configuration) == blockId;
+                });
+            if (blockConfiguration == runConfiguration.blocksConfigurations.end())
+            {
+                throw std::invalid_argument("Run " + run.runName + " overrides the configuration of block " + blockId + ", which is not in the model");
+            }
+            for (const auto& [keyName, value] : overrides)
+            {
+                (*blockConfiguration)[keyName] = value;
+            }
+        }
+        return runConfiguration;
+    }
+
+    std::shared_ptr<SimulationOutput> SimulationBatchRunner::Run(const SimulationBatchRun& run)
+    {
+        ModelConfiguration runConfiguration = this->ApplyOverrides(run);
+
+        std::shared_ptr<SimulationModel> simulationModel;
+        {
+            std::lock_guard<std::mutex> lock(this->modelBuildMutex);
+            simulationModel = ModelParser::BuildModel(runConfiguration, this->blockFactories, std::make_shared<BlockEventsHandler>());
+        }
+        simulationModel->PropagateSampleTimes();
+
+        std::unordered_map<std::string, std::shared_ptr<ISimulationBlock>> blockOfEachId;
+        for (const auto& block : simulationModel->simulationBlocks)
+        {
+            blockOfEachId.insert({block->GetId(), block});
+        }
+        std::vector<std::shared_ptr<ISimulationBlock>> orderedBlocks;
+        orderedBlocks.reserve(this->orderedBlockIds.size());
+        for (const auto& blockId : this->orderedBlockIds)
+        {
+            orderedBlocks.push_back(blockOfEachId.at(blockId));
+        }
+
+        spdlog::get("default_pysyslink")->debug("Starting batch run {}", run.runName);
+        SimulationManager simulationManager(simulationModel, this->simulationOptions, std::move(orderedBlocks));
+        return simulationManager.RunSimulation();
+    }
+
+    void SimulationBatchRunner::ForEachRun(const std::vector<SimulationBatchRun>& runs, const std::function<void (int)>& runAtIndex)
+    {
+        if (this->runExecutor)
+        {
+            this->runExecutor->Run(runs.size(), runAtIndex);
+        }
+        else
+        {
+            for (int i = 0; i < runs.size(); i++)
+            {
+                runAtIndex(i);
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<SimulationOutput>> SimulationBatchRunner::RunBatch(const std::vector<SimulationBatchRun>& runs)
+    {
+        std::vector<std::shared_ptr<SimulationOutput>> outputs(runs.size());
+        this->ForEachRun(runs, [this, &runs, &outputs](int runIndex)
+        {
+            outputs[runIndex] = this->Run(runs[runIndex]);
+        });
+        return outputs;
+    }
+
+    void SimulationBatchRunner::RunBatchToJson(const std::string& filename, const std::vector<SimulationBatchRun>& runs)
+    {
+        std::ofstream out(filename);
+        out << "{";
+
+        std::mutex outMutex;
+        int writtenRuns = 0;
+        this->ForEachRun(runs, [this, &runs, &out, &outMutex, &writtenRuns](int runIndex)
+        {
+            std::shared_ptr<SimulationOutput> output = this->Run(runs[runIndex]);
+
+            std::lock_guard<std::mutex> lock(outMutex);
+            if (writtenRuns++)
+                out << ",";
+
+            out << "\n  \"" << escapeJson(runs[runIndex].runName) << "\": ";
+            output->WriteJson(out, "  ");
+            out.flush();
+        });
+        out << "\n}\n";
+    }
+
+    void SimulationBatchRunner::WriteJson(const std::string& filename, const std::vector<SimulationBatchRun>& runs, const std::vector<std::shared_ptr<SimulationOutput>>& outputs)
+    {
+        if (runs.size() != outputs.size())
+        {
+            throw std::invalid_argument("Batch with " + std::to_string(runs.size()) + " runs can not be written with " + std::to_string(outputs.size()) + " outputs");
+        }
+
+        std::ofstream out(filename);
+        out << "{";
+        for (int i = 0; i < runs.size(); i++)
+        {
+            if (i)
+                out << ",";
+
+            out << "\n  \"" << escapeJson(runs[i].runName) << "\": ";
+            outputs[i]->WriteJson(out, "  ");
+        }
+        out << "\n}\n";
+    }
+} // namespace PySysLinkBase
@@ -0,0 +1,62 @@
+#ifndef SRC_SIMULATION_BATCH_RUNNER
+#define SRC_SIMULATION_BATCH_RUNNER
+
+#include "ModelParser.h"
+#include "SimulationModel.h"
+#include "SimulationOptions.h"
+#include "SimulationOutput.h"
+#include "IBlockFactory.h"
+#include "ParallelBlockExecutor.h"
+#include "ConfigurationValue.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace PySysLinkBase
+{
+    struct SimulationBatchRun
+    {
+        std::string runName;
+        // Configuration values replaced in each run, by block id and key name
+        std::map<std::string, std::map<std::string, ConfigurationValue>> blockConfigurationOverrides = {};
+    };
+
+    // Runs variants of the same model. The model file is parsed and the block execution order computed once,
+    // each run only builds its own blocks from the parsed configurations and its overrides.
+    // With more than one batch thread, each run is simulated on a single thread whatever the simulation options ask for.
+    // Profiling is turned off, a batch has no single run to report on.
+    class SimulationBatchRunner
+    {
+        public:
+        SimulationBatchRunner(ModelConfiguration modelConfiguration, std::map<std::string, std::shared_ptr<IBlockFactory>> blockFactories,
+                              std::shared_ptr<SimulationOptions> simulationOptions, int numberOfThreads=1);
+
+        // Outputs in the same order as runs, all kept in memory. Results are always kept in vectors, file output of each run is disabled
+        std::vector<std::shared_ptr<SimulationOutput>> RunBatch(const std::vector<SimulationBatchRun>& runs);
+
+        // Same JSON as WriteJson, but each run is written as soon as it ends and its output released, in the order runs end
+        void RunBatchToJson(const std::string& filename, const std::vector<SimulationBatchRun>& runs);
+
+        // One JSON object with the output of each run under its name
+        static void WriteJson(const std::string& filename, const std::vector<SimulationBatchRun>& runs, const std::vector<std::shared_ptr<SimulationOutput>>& outputs);
+
+        private:
+        ModelConfiguration modelConfiguration;
+        std::map<std::string, std::shared_ptr<IBlockFactory>> blockFactories;
+        std::shared_ptr<SimulationOptions> simulationOptions;
+
+        std::vector<std::string> orderedBlockIds;
+        std::unique_ptr<ParallelBlockExecutor> runExecutor; // Only created when more than one thread is requested
+        std::mutex modelBuildMutex; // Block factories of plugins are not required to be thread safe
+
+        ModelConfiguration ApplyOverrides(const SimulationBatchRun& run) const;
+        std::shared_ptr<SimulationOutput> Run(const SimulationBatchRun& run);
+        void ForEachRun(const std::vector<SimulationBatchRun>& runs, const std::function<void (int)>& runAtIndex);
+    };
+} // namespace PySysLinkBase
+
+#endif /* SRC_SIMULATION_BATCH_RUNNER */
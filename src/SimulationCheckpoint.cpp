@@ -0,0 +1,193 @@
+#include "SimulationCheckpoint.h"
+#include "FullySupportedSignalValue.h"
+#include "PortsAndSignalValues/SignalValue.h"
+
+#include <utility>
+
+namespace PySysLinkBase
+{
+    namespace
+    {
+        const std::uint8_t notStoredSignalValue = 255;
+
+        template<typename T>
+        void WritePayload(CheckpointWriter& writer, const T& payload)
+        {
+            writer.Write(payload);
+        }
+
+        void WritePayload(CheckpointWriter& writer, const std::string& payload)
+        {
+            writer.WriteString(payload);
+        }
+
+        template<typename T>
+        void WritePayload(CheckpointWriter& writer, const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>& payload)
+        {
+            writer.Write<std::int64_t>(payload.rows());
+            writer.Write<std::int64_t>(payload.cols());
+            for (Eigen::Index i = 0; i < payload.size(); i++)
+            {
+                writer.Write<T>(payload.data()[i]);
+            }
+        }
+
+        template<typename T>
+        struct PayloadReader
+        {
+            static T Read(CheckpointReader& reader)
+            {
+                return reader.Read<T>();
+            }
+        };
+
+        template<>
+        struct PayloadReader<std::string>
+        {
+            static std::string Read(CheckpointReader& reader)
+            {
+                return reader.ReadString();
+            }
+        };
+
+        template<typename T>
+        struct PayloadReader<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>>
+        {
+            static Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> Read(CheckpointReader& reader)
+            {
+                std::int64_t rows = reader.Read<std::int64_t>();
+                std::int64_t cols = reader.Read<std::int64_t>();
+                Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> payload(rows, cols);
+                for (Eigen::Index i = 0; i < payload.size(); i++)
+                {
+                    payload.data()[i] = reader.Read<T>();
+                }
+                return payload;
+            }
+        };
+
+        template<std::size_t I>
+        bool TryWriteAlternative(CheckpointWriter& writer, const UnknownTypeSignalValue& value)
+        {
+            using T = std::variant_alternative_t<I, FullySupportedSignalValue>;
+            if (value.GetSignalTypeId() != GetSignalTypeId<T>())
+            {
+                return false;
+            }
+            writer.Write<std::uint8_t>(I);
+            // Ports that were never written hold no payload, only their type is stored
+            const SignalValue<T>& typedValue = value.TryCastToTypedReference<T>();
+            writer.Write(typedValue.IsInitialized());
+            if (typedValue.IsInitialized())
+            {
+                WritePayload(writer, typedValue.GetPayloadReference());
+            }
+            return true;
+        }
+
+        template<std::size_t... Is>
+        bool TryWriteAlternatives(CheckpointWriter& writer, const UnknownTypeSignalValue& value, std::index_sequence<Is...>)
+        {
+            return (TryWriteAlternative<Is>(writer, value) || ...);
+        }
+
+        template<std::size_t I>
+        bool TryReadAlternative(CheckpointReader& reader, std::uint8_t index, std::shared_ptr<UnknownTypeSignalValue>& value)
+        {
+            if (index != I)
+            {
+                return false;
+            }
+            using T = std::variant_alternative_t<I, FullySupportedSignalValue>;
+            if (reader.Read<bool>())
+            {
+                value = std::make_shared<SignalValue<T>>(PayloadReader<T>::Read(reader));
+            }
+            else
+            {
+                value = std::make_shared<SignalValue<T>>();
+            }
+            return true;
+        }
+
+        template<std::size_t... Is>
+        bool TryReadAlternatives(CheckpointReader& reader, std::uint8_t index, std::shared_ptr<UnknownTypeSignalValue>& value, std::index_sequence<Is...>)
+        {
+            return (TryReadAlternative<Is>(reader, index, value) || ...);
+        }
+    }
+
+    void CheckpointWriter::WriteString(const std::string& value)
+    {
+        this->Write<std::uint64_t>(value.size());
+        this->blob.insert(this->blob.end(), value.begin(), value.end());
+    }
+
+    void CheckpointWriter::WriteDoubles(const std::vector<double>& values)
+    {
+        this->Write<std::uint64_t>(values.size());
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values.data());
+        this->blob.insert(this->blob.end(), bytes, bytes + values.size() * sizeof(double));
+    }
+
+    void CheckpointWriter::WriteBytes(const std::vector<unsigned char>& bytes)
+    {
+        this->Write<std::uint64_t>(bytes.size());
+        this->blob.insert(this->blob.end(), bytes.begin(), bytes.end());
+    }
+
+    bool CheckpointWriter::WriteSignalValue(const std::shared_ptr<UnknownTypeSignalValue>& value)
+    {
+        if (value && TryWriteAlternatives(*this, *value, std::make_index_sequence<std::variant_size_v<FullySupportedSignalValue>>{}))
+        {
+            return true;
+        }
+        this->Write<std::uint8_t>(notStoredSignalValue);
+        return false;
+    }
+
+    const unsigned char* CheckpointReader::Take(std::size_t byteCount)
+    {
+        if (byteCount > this->blob.size() - this->position)
+        {
+            throw std::runtime_error("Checkpoint ended before all the simulation state was read");
+        }
+        const unsigned char* bytes = this->blob.data() + this->position;
+        this->position += byteCount;
+        return bytes;
+    }
+
+    std::string CheckpointReader::ReadString()
+    {
+        std::size_t size = this->Read<std::uint64_t>();
+        const unsigned char* bytes = this->Take(size);
+        return std::string(bytes, bytes + size);
+    }
+
+    std::vector<double> CheckpointReader::ReadDoubles()
+    {
+        std::size_t size = this->Read<std::uint64_t>();
+        const unsigned char* bytes = this->Take(size * sizeof(double));
+        std::vector<double> values(size);
+        std::memcpy(values.data(), bytes, size * sizeof(double));
+        return values;
+    }
+
+    std::vector<unsigned char> CheckpointReader::ReadBytes()
+    {
+        std::size_t size = this->Read<std::uint64_t>();
+        const unsigned char* bytes = this->Take(size);
+        return std::vector<unsigned char>(bytes, bytes + size);
+    }
+
+    std::shared_ptr<UnknownTypeSignalValue> CheckpointReader::ReadSignalValue()
+    {
+        std::uint8_t index = this->Read<std::uint8_t>();
+        std::shared_ptr<UnknownTypeSignalValue> value;
+        if (index != notStoredSignalValue && !TryReadAlternatives(*this, index, value, std::make_index_sequence<std::variant_size_v<FullySupportedSignalValue>>{}))
+        {
+            throw std::runtime_error("Checkpoint holds a signal value of unknown type index " + std::to_string(index));
+        }
+        return value;
+    }
+} // namespace PySysLinkBase
@@ -0,0 +1,76 @@
+#ifndef SRC_SIMULATION_CHECKPOINT
+#define SRC_SIMULATION_CHECKPOINT
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <stdexcept>
+#include "PortsAndSignalValues/UnknownTypeSignalValue.h"
+
+namespace PySysLinkBase
+{
+    // Appends values to a binary checkpoint blob. Numbers are stored in the native byte order,
+    // checkpoints are meant to be restored by the same build that saved them.
+    class CheckpointWriter
+    {
+        public:
+        template <typename T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values are written as raw bytes");
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+            this->blob.insert(this->blob.end(), bytes, bytes + sizeof(T));
+        }
+
+        void WriteString(const std::string& value);
+        void WriteDoubles(const std::vector<double>& values);
+        void WriteBytes(const std::vector<unsigned char>& bytes);
+        // Values of types out of FullySupportedSignalValue are not stored, returns false for them
+        bool WriteSignalValue(const std::shared_ptr<UnknownTypeSignalValue>& value);
+
+        const std::vector<unsigned char>& GetBlob() const
+        {
+            return this->blob;
+        }
+
+        private:
+        std::vector<unsigned char> blob;
+    };
+
+    class CheckpointReader
+    {
+        public:
+        CheckpointReader(const std::vector<unsigned char>& blob) : blob(blob) {}
+
+        template <typename T>
+        T Read()
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values are read as raw bytes");
+            T value;
+            std::memcpy(&value, this->Take(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        std::string ReadString();
+        std::vector<double> ReadDoubles();
+        std::vector<unsigned char> ReadBytes();
+        // Null for the values that were not stored
+        std::shared_ptr<UnknownTypeSignalValue> ReadSignalValue();
+
+        bool IsAtEnd() const
+        {
+            return this->position == this->blob.size();
+        }
+
+        private:
+        const std::vector<unsigned char>& blob;
+        std::size_t position = 0;
+
+        const unsigned char* Take(std::size_t byteCount);
+    };
+} // namespace PySysLinkBase
+
+#endif /* SRC_SIMULATION_CHECKPOINT */
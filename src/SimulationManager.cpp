@@ -10,43 +10,83 @@
 #include <limits>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <unordered_map>
 
 namespace PySysLinkBase
 {
+    namespace
+    {
+        // Time hit a cluster worker is processing, not a number on threads outside a cluster step
+        thread_local double clusterTimeOfThread = std::numeric_limits<double>::quiet_NaN();
+    }
+
     SimulationManager::SimulationManager(std::shared_ptr<SimulationModel> simulationModel, std::shared_ptr<SimulationOptions> simulationOptions)
-                                        : simulationModel(simulationModel), simulationOptions(simulationOptions)
+                                        : SimulationManager(simulationModel, simulationOptions, SimulationManager::OrderBlocks(simulationModel))
     {
-        std::vector<std::vector<std::shared_ptr<PySysLinkBase::ISimulationBlock>>> blockChains = simulationModel->GetDirectBlockChains();
-        this->orderedBlocks = simulationModel->OrderBlockChainsOntoFreeOrder(blockChains);
-        
-        this->blocksForEachDiscreteSampleTime = {};
-        this->blocksForEachContinuousSampleTimeGroup = {};
+    }
+
+    std::vector<std::shared_ptr<ISimulationBlock>> SimulationManager::OrderBlocks(std::shared_ptr<SimulationModel> simulationModel)
+    {
+        return simulationModel->GetBlocksInExecutionOrder();
+    }
+
+    SimulationManager::SimulationManager(std::shared_ptr<SimulationModel> simulationModel, std::shared_ptr<SimulationOptions> simulationOptions, std::vector<std::shared_ptr<ISimulationBlock>> orderedBlocks)
+                                        : simulationModel(simulationModel), simulationOptions(simulationOptions), orderedBlocks(std::move(orderedBlocks))
+    {
+        this->blocksOfEachSampleTimeId = {};
         this->blocksWithConstantSampleTime = {};
         
-        this->ClassifyBlocks(orderedBlocks, blocksForEachDiscreteSampleTime, blocksWithConstantSampleTime, blocksForEachContinuousSampleTimeGroup);
-        spdlog::get("default_pysyslink")->debug("Different discrete sample times: {}", blocksForEachDiscreteSampleTime.size());
+        this->ClassifyBlocks(this->orderedBlocks, blocksOfEachSampleTimeId, blocksWithConstantSampleTime);
+        for (int sampleTimeId = 0; sampleTimeId < this->sampleTimeRegistry.GetCount(); sampleTimeId++)
+        {
+            if (this->sampleTimeRegistry.GetSampleTime(sampleTimeId)->GetSampleTimeType() == SampleTimeType::discrete)
+            {
+                this->discreteSampleTimeIds.push_back(sampleTimeId);
+            }
+            else
+            {
+                this->continuousSampleTimeIds.push_back(sampleTimeId);
+            }
+        }
+        spdlog::get("default_pysyslink")->debug("Different discrete sample times: {}", this->discreteSampleTimeIds.size());
         spdlog::get("default_pysyslink")->debug("Blocks with constant sample time: {}", blocksWithConstantSampleTime.size());
-        spdlog::get("default_pysyslink")->debug("Different continuous sample times: {}", blocksForEachContinuousSampleTimeGroup.size());
+        spdlog::get("default_pysyslink")->debug("Different continuous sample times: {}", this->continuousSampleTimeIds.size());
+
+        if (this->simulationOptions->activateProfiling)
+        {
+            this->profiler = std::make_shared<SimulationProfiler>(this->simulationOptions->profilerMaximumTraceEvents);
+            spdlog::get("default_pysyslink")->debug("Profiling activated, keeping up to {} trace events", this->simulationOptions->profilerMaximumTraceEvents);
+        }
 
-        for (std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>::iterator iter = blocksForEachContinuousSampleTimeGroup.begin(); iter != blocksForEachContinuousSampleTimeGroup.end(); ++iter)
+        this->CompileExecutionPlan();
+        if (this->simulationOptions->numberOfThreads > 1)
         {
+            this->blockExecutor = std::make_unique<ParallelBlockExecutor>(this->simulationOptions->numberOfThreads);
+            spdlog::get("default_pysyslink")->debug("Blocks of each time hit evaluated with {} threads", this->simulationOptions->numberOfThreads);
+        }
+
+        this->odeSolverOfEachSampleTimeId = std::vector<std::shared_ptr<BasicOdeSolver>>(this->sampleTimeRegistry.GetCount());
+        for (int sampleTimeId : this->continuousSampleTimeIds)
+        {
+            const std::shared_ptr<SampleTime>& sampleTime = this->sampleTimeRegistry.GetSampleTime(sampleTimeId);
             std::shared_ptr<IOdeStepSolver> odeStepSolver;
             std::string selectedKey = "default";            
-            if (this->simulationOptions->solversConfiguration.find(std::to_string(iter->first->GetContinuousSampleTimeGroup())) == this->simulationOptions->solversConfiguration.end())
+            if (this->simulationOptions->solversConfiguration.find(std::to_string(sampleTime->GetContinuousSampleTimeGroup())) == this->simulationOptions->solversConfiguration.end())
             {
                 if (this->simulationOptions->solversConfiguration.find("default") == this->simulationOptions->solversConfiguration.end())
                 {
-                    throw std::invalid_argument("Solver for continuous sample time " + std::to_string(iter->first->GetContinuousSampleTimeGroup()) + " not found in configuration, and no default solver was provided.");
+                    throw std::invalid_argument("Solver for continuous sample time " + std::to_string(sampleTime->GetContinuousSampleTimeGroup()) + " not found in configuration, and no default solver was provided.");
                 }
                 else
                 {
-                    spdlog::get("default_pysyslink")->info("Solver for continuous sample time {} not found in configuration, using default solver.", iter->first->GetContinuousSampleTimeGroup());
+                    spdlog::get("default_pysyslink")->info("Solver for continuous sample time {} not found in configuration, using default solver.", sampleTime->GetContinuousSampleTimeGroup());
                     selectedKey = "default";
                 }
             }
             else
             {
-                selectedKey = std::to_string(iter->first->GetContinuousSampleTimeGroup());
+                selectedKey = std::to_string(sampleTime->GetContinuousSampleTimeGroup());
             }
 
             double firstTimeStep = 1e-6;
@@ -81,13 +121,35 @@ namespace PySysLinkBase
 
             odeStepSolver = SolverFactory::CreateOdeStepSolver(this->simulationOptions->solversConfiguration[selectedKey]);
 
-            std::shared_ptr<BasicOdeSolver> odeSolver = std::make_shared<BasicOdeSolver>(odeStepSolver, this->simulationModel, iter->second, iter->first, this->simulationOptions, firstTimeStep, activateEvents, eventTolerance);
-            this->odeSolversForEachContinuousSampleTimeGroup.insert({iter->first, odeSolver});
+            std::shared_ptr<BasicOdeSolver> odeSolver = std::make_shared<BasicOdeSolver>(odeStepSolver, this->simulationModel, this->blocksOfEachSampleTimeId[sampleTimeId], sampleTime, this->simulationOptions, firstTimeStep, activateEvents, eventTolerance);
+            odeSolver->SetAlgebraicLoopSolvers(this->algebraicLoopSolvers);
+            odeSolver->SetProfiler(this->profiler);
+            this->odeSolverOfEachSampleTimeId[sampleTimeId] = odeSolver;
         }
 
-        this->GetTimeHitsToSampleTimes(simulationOptions, blocksForEachDiscreteSampleTime);
+        this->ClusterLinkedContinuousSampleTimeGroups();
+        if (this->simulationOptions->runContinuousGroupsConcurrently && this->continuousGroupClusterCount > 1)
+        {
+            // Clusters beyond the thread count are shared out among the workers
+            int threadCount = this->simulationOptions->numberOfThreads > 1 ? this->simulationOptions->numberOfThreads : std::max(1u, std::thread::hardware_concurrency());
+            threadCount = std::min(threadCount, this->continuousGroupClusterCount);
+            if (threadCount > 1)
+            {
+                this->continuousGroupExecutor = std::make_unique<ParallelBlockExecutor>(threadCount);
+                spdlog::get("default_pysyslink")->debug("Continuous sample time groups stepped concurrently in {} independent clusters on {} threads", this->continuousGroupClusterCount, threadCount);
+            }
+        }
+
+        std::vector<std::shared_ptr<SampleTime>> discreteSampleTimes = {};
+        for (int sampleTimeId : this->discreteSampleTimeIds)
+        {
+            discreteSampleTimes.push_back(this->sampleTimeRegistry.GetSampleTime(sampleTimeId));
+        }
+        this->discreteTimeHitScheduler = std::make_unique<DiscreteTimeHitScheduler>(discreteSampleTimes, simulationOptions->startTime, simulationOptions->stopTime);
 
-        this->simulationOutput = std::make_shared<SimulationOutput>(simulationOptions->saveToVectors, simulationOptions->saveToFileContinuously, simulationOptions->hdf5FileName);
+        this->simulationOutput = std::make_shared<SimulationOutput>(simulationOptions->saveToVectors, simulationOptions->saveToFileContinuously, simulationOptions->hdf5FileName,
+                                                                    simulationOptions->hdf5ChunkSize, simulationOptions->hdf5FlushInterval, simulationOptions->hdf5DeflateLevel, simulationOptions->hdf5UseShuffleFilter,
+                                                                    simulationOptions->hdf5WriteQueueCapacity, simulationOptions->hdf5WriteQueueFullPolicy);
         this->simulationModel->blockEventsHandler->RegisterValueUpdateBlockEventCallback(std::bind(&SimulationManager::ValueUpdateBlockEventCallback, this, std::placeholders::_1));
 
         for (const auto& blockIdInputOrOutputAndIndexToLog : simulationOptions->blockIdsInputOrOutputAndIndexesToLog)
@@ -98,11 +160,13 @@ namespace PySysLinkBase
             std::shared_ptr<ISimulationBlock> block = ISimulationBlock::FindBlockById(blockId, this->simulationModel->simulationBlocks);
             if (inputOrOutput == "input")
             {
-                block->RegisterReadInputsCallbacks(std::bind(&SimulationManager::LogSignalInputReadCallback, this, std::placeholders::_1, std::placeholders::_2, outputIndex, std::placeholders::_3, std::placeholders::_4));
+                int signalHandle = this->simulationOutput->RegisterSignal("LoggedSignals", blockId + "/input/" + std::to_string(outputIndex));
+                block->RegisterReadInputsCallbacks(std::bind(&SimulationManager::LogSignalInputReadCallback, this, std::placeholders::_1, std::placeholders::_2, outputIndex, signalHandle, std::placeholders::_3, std::placeholders::_4));
             }
             else if (inputOrOutput == "output")
             {
-                block->RegisterCalculateOutputCallbacks(std::bind(&SimulationManager::LogSignalOutputUpdateCallback, this, std::placeholders::_1, std::placeholders::_2, outputIndex, std::placeholders::_3, std::placeholders::_4));
+                int signalHandle = this->simulationOutput->RegisterSignal("LoggedSignals", blockId + "/output/" + std::to_string(outputIndex));
+                block->RegisterCalculateOutputCallbacks(std::bind(&SimulationManager::LogSignalOutputUpdateCallback, this, std::placeholders::_1, std::placeholders::_2, outputIndex, signalHandle, std::placeholders::_3, std::placeholders::_4));
             }
             else
             {
@@ -116,16 +180,27 @@ namespace PySysLinkBase
         }
     }
 
-    void SimulationManager::LogSignalOutputUpdateCallback(const std::string blockId, const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>> outputPorts, int outputPortIndex, std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime)
+    void SimulationManager::LogSignalOutputUpdateCallback(const std::string& blockId, const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>>& outputPorts, int outputPortIndex, int signalHandle, std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime)
     {
-        std::string signalId = blockId + "/output/" + std::to_string(outputPortIndex);
-        this->simulationOutput->InsertUnknownValue("LoggedSignals", signalId, outputPorts[outputPortIndex]->GetValue(), currentTime);
+        ProfiledScope profiledScope(this->profiler.get(), ProfiledPhase::loggingAndOutput);
+        std::unique_lock<std::mutex> lock = this->LockCallbackStateIfParallel();
+        this->simulationOutput->InsertUnknownValue(signalHandle, outputPorts[outputPortIndex]->GetValueReference(), currentTime);
     }
 
-    void SimulationManager::LogSignalInputReadCallback(const std::string blockId, const std::vector<std::shared_ptr<PySysLinkBase::InputPort>> inputPorts, int inputPortIndex, std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime)
+    void SimulationManager::LogSignalInputReadCallback(const std::string& blockId, const std::vector<std::shared_ptr<PySysLinkBase::InputPort>>& inputPorts, int inputPortIndex, int signalHandle, std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime)
     {
-        std::string signalId = blockId + "/input/" + std::to_string(inputPortIndex);
-        this->simulationOutput->InsertUnknownValue("LoggedSignals", signalId, inputPorts[inputPortIndex]->GetValue(), currentTime);
+        ProfiledScope profiledScope(this->profiler.get(), ProfiledPhase::loggingAndOutput);
+        std::unique_lock<std::mutex> lock = this->LockCallbackStateIfParallel();
+        this->simulationOutput->InsertUnknownValue(signalHandle, inputPorts[inputPortIndex]->GetValueReference(), currentTime);
+    }
+
+    std::unique_lock<std::mutex> SimulationManager::LockCallbackStateIfParallel()
+    {
+        if (this->blockExecutor || this->continuousGroupExecutor)
+        {
+            return std::unique_lock<std::mutex>(this->callbackMutex);
+        }
+        return std::unique_lock<std::mutex>();
     }
 
     void SimulationManager::ValueUpdateBlockEventCallback(const std::shared_ptr<ValueUpdateBlockEvent> blockEvent)
@@ -138,91 +213,30 @@ namespace PySysLinkBase
         spdlog::get("default_pysyslink")->debug("Value update event type: {}", valueEventType);
         spdlog::get("default_pysyslink")->debug("Display id: {}", displayId);
 
-        this->simulationOutput->InsertFullySupportedValue("Displays", displayId, blockEvent->value, currentTime);
+        ProfiledScope profiledScope(this->profiler.get(), ProfiledPhase::loggingAndOutput);
+        std::unique_lock<std::mutex> lock = this->LockCallbackStateIfParallel();
+        this->simulationOutput->InsertFullySupportedValue("Displays", displayId, blockEvent->value, std::isnan(clusterTimeOfThread) ? this->currentTime : clusterTimeOfThread);
     }
 
     void SimulationManager::UpdateConfigurationValueCallback(const std::string blockId, const std::string keyName, ConfigurationValue value)
     {
         std::shared_ptr<ISimulationBlock> block = ISimulationBlock::FindBlockById(blockId, this->simulationModel->simulationBlocks);
+        std::unique_lock<std::mutex> lock = this->LockCallbackStateIfParallel();
         this->simulationBlocksForceOutputUpdate.push_back(block);
     }
 
 
     void SimulationManager::ClassifyBlocks(std::vector<std::shared_ptr<PySysLinkBase::ISimulationBlock>> orderedBlocks, 
-                                            std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>& blocksForEachDiscreteSampleTime,
-                                            std::vector<std::shared_ptr<ISimulationBlock>>& blocksWithConstantSampleTime,
-                                            std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>& blocksForEachContinuousSampleTimeGroup)
+                                            std::vector<std::vector<std::shared_ptr<ISimulationBlock>>>& blocksOfEachSampleTimeId,
+                                            std::vector<std::shared_ptr<ISimulationBlock>>& blocksWithConstantSampleTime)
     {
-        auto insertBlockInDiscreteSampleTime = [](const std::shared_ptr<ISimulationBlock> block, std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>& blocksForEachDiscreteSampleTime, std::shared_ptr<SampleTime> multirateSampleTime=nullptr) -> void {
-            bool isAlreadyOnDiscreteSampleTimes = false;
-            std::shared_ptr<SampleTime> currentSampleTime;
-
-            std::shared_ptr<SampleTime> keySampleTime;
-            if (multirateSampleTime == nullptr)
-            {
-                keySampleTime = block->GetSampleTime();
-            }
-            else
-            {
-                keySampleTime = multirateSampleTime;
-            }
-
-            for (std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>::iterator iter = blocksForEachDiscreteSampleTime.begin(); iter != blocksForEachDiscreteSampleTime.end(); ++iter)
-            {
-                if (iter->first->GetDiscreteSampleTime() == keySampleTime->GetDiscreteSampleTime())
-                {
-                    isAlreadyOnDiscreteSampleTimes = true;
-                    currentSampleTime = iter->first;
-                    break;
-                }
-            }
-
-            if (!isAlreadyOnDiscreteSampleTimes)
-            {
-                blocksForEachDiscreteSampleTime.insert({keySampleTime, std::vector<std::shared_ptr<ISimulationBlock>>({block})});
-            }
-            else
-            {
-                blocksForEachDiscreteSampleTime[currentSampleTime].push_back(block);
-            }
-        };
-
-        auto insertBlockInContinuousSampleTime = [](const std::shared_ptr<ISimulationBlock> block, std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>& blocksForEachContinuousSampleTimeGroup, std::shared_ptr<SampleTime> multirateSampleTime=nullptr) -> void {
-            spdlog::get("default_pysyslink")->debug("Block with continuous sample time: {}", block->GetId());
-
-            bool isAlreadyOnContinuousSampleTimes = false;
-            std::shared_ptr<SampleTime> currentSampleTime;
-
-            std::shared_ptr<SampleTime> keySampleTime;
-            if (multirateSampleTime == nullptr)
-            {
-                keySampleTime = block->GetSampleTime();
-            }
-            else
-            {
-                keySampleTime = multirateSampleTime;
-            }
-
-            for (std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>::iterator iter = blocksForEachContinuousSampleTimeGroup.begin(); iter != blocksForEachContinuousSampleTimeGroup.end(); ++iter)
-            {
-                if (iter->first->GetContinuousSampleTimeGroup() == keySampleTime->GetContinuousSampleTimeGroup())
-                {
-                    isAlreadyOnContinuousSampleTimes = true;
-                    currentSampleTime = iter->first;
-                    break;
-                }
-            }
-
-            if (!isAlreadyOnContinuousSampleTimes)
+        auto insertBlockInSampleTime = [&](const std::shared_ptr<ISimulationBlock> block, const std::shared_ptr<SampleTime> sampleTime) -> void {
+            int sampleTimeId = this->sampleTimeRegistry.Intern(sampleTime);
+            if (sampleTimeId >= blocksOfEachSampleTimeId.size())
             {
-                spdlog::get("default_pysyslink")->debug("Inserting onto dict");
-
-                blocksForEachContinuousSampleTimeGroup.insert({keySampleTime, std::vector<std::shared_ptr<ISimulationBlock>>({block})});
-            } else {
-                spdlog::get("default_pysyslink")->debug("Seems to be in dict, push back");
-
-                blocksForEachContinuousSampleTimeGroup[currentSampleTime].push_back(block);
+                blocksOfEachSampleTimeId.resize(sampleTimeId + 1);
             }
+            blocksOfEachSampleTimeId[sampleTimeId].push_back(block);
         };
 
         for (const auto& block : orderedBlocks)
@@ -230,11 +244,12 @@ namespace PySysLinkBase
             spdlog::get("default_pysyslink")->debug("Block {} has sample time {}", block->GetId(), SampleTime::SampleTimeTypeString(block->GetSampleTime()->GetSampleTimeType()));
             if (block->GetSampleTime()->GetSampleTimeType() == SampleTimeType::discrete)
             {
-                insertBlockInDiscreteSampleTime(block, blocksForEachDiscreteSampleTime);
+                insertBlockInSampleTime(block, block->GetSampleTime());
             }
             else if (block->GetSampleTime()->GetSampleTimeType() == SampleTimeType::continuous)
             {
-                insertBlockInContinuousSampleTime(block, blocksForEachContinuousSampleTimeGroup);
+                spdlog::get("default_pysyslink")->debug("Block with continuous sample time: {}", block->GetId());
+                insertBlockInSampleTime(block, block->GetSampleTime());
             }
             else if (block->GetSampleTime()->GetSampleTimeType() == SampleTimeType::constant)
             {
@@ -246,11 +261,12 @@ namespace PySysLinkBase
                 {
                     if (sampleTime->GetSampleTimeType() == SampleTimeType::discrete)
                     {
-                        insertBlockInDiscreteSampleTime(block, blocksForEachDiscreteSampleTime, sampleTime);
+                        insertBlockInSampleTime(block, sampleTime);
                     }
                     else if (sampleTime->GetSampleTimeType() == SampleTimeType::continuous)
                     {
-                        insertBlockInContinuousSampleTime(block, blocksForEachContinuousSampleTimeGroup, sampleTime);
+                        spdlog::get("default_pysyslink")->debug("Block with continuous sample time: {}", block->GetId());
+                        insertBlockInSampleTime(block, sampleTime);
                     }
                     else if (sampleTime->GetSampleTimeType() == SampleTimeType::constant)
                     {
@@ -269,42 +285,182 @@ namespace PySysLinkBase
         }
     }
 
-    void SimulationManager::GetTimeHitsToSampleTimes(std::shared_ptr<SimulationOptions> simulationOptions, std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>> blocksForEachDiscreteSampleTime)
+    void SimulationManager::CompileExecutionPlan()
     {
-        std::map<double, std::vector<std::shared_ptr<SampleTime>>> timeHitsToSampleTimes;
+        this->executionPlan = {};
+        this->executionPlanIndexOfBlock = {};
+        this->executionPlanIndexesOfEachSampleTimeId = {};
 
-        for (std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>::iterator iter = blocksForEachDiscreteSampleTime.begin(); iter != blocksForEachDiscreteSampleTime.end(); ++iter)
+        for (int i = 0; i < this->orderedBlocks.size(); i++)
         {
-            double samplePeriod = iter->first->GetDiscreteSampleTime();
-            int numberOfSamples = (simulationOptions->stopTime - simulationOptions->startTime) / samplePeriod;
-            for (int i = 0; i < numberOfSamples; i++)
+            const std::shared_ptr<ISimulationBlock>& block = this->orderedBlocks[i];
+
+            ExecutionPlanEntry entry;
+            entry.block = block;
+            entry.outputPorts = block->GetOutputPorts();
+            for (int j = 0; j < entry.outputPorts.size(); j++)
             {
-                double t = simulationOptions->startTime + i * samplePeriod;
-                if (timeHitsToSampleTimes.find(t) == timeHitsToSampleTimes.end()) 
+                entry.connectedPortsOfEachOutput.push_back(this->simulationModel->GetConnectedPorts(block, j));
+            }
+
+            this->executionPlan.push_back(entry);
+            this->executionPlanIndexOfBlock.insert({block.get(), i});
+        }
+
+        for (const auto& blocks : this->blocksOfEachSampleTimeId)
+        {
+            std::vector<int> planIndexes = {};
+            for (const auto& block : blocks)
+            {
+                planIndexes.push_back(this->executionPlanIndexOfBlock.at(block.get()));
+            }
+            this->executionPlanIndexesOfEachSampleTimeId.push_back(planIndexes);
+        }
+
+        this->CompileAlgebraicLoops();
+
+        this->isExecutionPlanEntryScheduled = std::vector<char>(this->executionPlan.size(), 0);
+        this->LevelizeExecutionPlan();
+
+        spdlog::get("default_pysyslink")->debug("Execution plan compiled with {} blocks in {} levels", this->executionPlan.size(), this->executionPlanLevels.size());
+    }
+
+    void SimulationManager::CompileAlgebraicLoops()
+    {
+        auto isSameSampleTime = [](const std::shared_ptr<SampleTime>& lhs, const std::shared_ptr<SampleTime>& rhs) -> bool {
+            if (lhs->GetSampleTimeType() != rhs->GetSampleTimeType() || lhs->GetSampleTimeType() == SampleTimeType::multirate)
+            {
+                return false;
+            }
+            if (lhs->GetSampleTimeType() == SampleTimeType::discrete)
+            {
+                return lhs->GetDiscreteSampleTime() == rhs->GetDiscreteSampleTime();
+            }
+            if (lhs->GetSampleTimeType() == SampleTimeType::continuous)
+            {
+                return lhs->GetContinuousSampleTimeGroup() == rhs->GetContinuousSampleTimeGroup();
+            }
+            return true;
+        };
+
+        this->algebraicLoopSolvers = {};
+        for (const auto& algebraicLoop : this->simulationModel->GetAlgebraicLoops())
+        {
+            std::vector<int> entryIndexes = {};
+            for (const auto& block : algebraicLoop)
+            {
+                auto it = this->executionPlanIndexOfBlock.find(block.get());
+                if (it != this->executionPlanIndexOfBlock.end())
                 {
-                    timeHitsToSampleTimes.insert({t, std::vector<std::shared_ptr<SampleTime>>({iter->first})});
-                } else {
-                    timeHitsToSampleTimes[t].push_back(iter->first);
+                    entryIndexes.push_back(it->second);
                 }
             }
-            if ((simulationOptions->startTime + (numberOfSamples - 1) * samplePeriod) < simulationOptions->stopTime) 
+            if (entryIndexes.empty())
+            {
+                continue;
+            }
+            std::sort(entryIndexes.begin(), entryIndexes.end());
+            if (entryIndexes.size() != algebraicLoop.size() || entryIndexes.back() - entryIndexes.front() + 1 != entryIndexes.size())
             {
-                double t = simulationOptions->stopTime;
-                if (timeHitsToSampleTimes.find(t) == timeHitsToSampleTimes.end()) 
+                throw std::invalid_argument("Blocks of the algebraic loop of block " + algebraicLoop.front()->GetId() + " must be contiguous in the execution order");
+            }
+
+            std::vector<std::shared_ptr<ISimulationBlock>> loopBlocks = {};
+            for (int entryIndex : entryIndexes)
+            {
+                const std::shared_ptr<ISimulationBlock>& block = this->executionPlan[entryIndex].block;
+                if (!isSameSampleTime(block->GetSampleTime(), loopBlocks.empty() ? block->GetSampleTime() : loopBlocks.front()->GetSampleTime()))
                 {
-                    timeHitsToSampleTimes.insert({t, std::vector<std::shared_ptr<SampleTime>>({iter->first})});
-                } else {
-                    timeHitsToSampleTimes[t].push_back(iter->first);
+                    throw std::invalid_argument("Block " + block->GetId() + " is in an algebraic loop with blocks of another sample time, loops can only be solved within one sample time");
                 }
+                loopBlocks.push_back(block);
+            }
+
+            std::shared_ptr<AlgebraicLoopSolver> algebraicLoopSolver = std::make_shared<AlgebraicLoopSolver>(loopBlocks, this->simulationModel, this->simulationOptions->algebraicLoopTolerance,
+                                                                                                                this->simulationOptions->algebraicLoopMaximumIterations);
+            algebraicLoopSolver->SetProfiler(this->profiler);
+            for (int entryIndex : entryIndexes)
+            {
+                this->executionPlan[entryIndex].algebraicLoopSolver = algebraicLoopSolver;
             }
+            this->executionPlan[entryIndexes.front()].algebraicLoopEntryCount = entryIndexes.size();
+            this->algebraicLoopSolvers.push_back(algebraicLoopSolver);
         }
+    }
 
-        this->timeHitsToSampleTimes = timeHitsToSampleTimes;
-        this->timeHits = {};
+    void SimulationManager::LevelizeExecutionPlan()
+    {
+        // Every link orders its two blocks as in the plan, not only direct feedthrough ones: a block reading a delayed input
+        // before its source overwrites it has to keep doing so, so parallel results match the sequential ones
+        std::vector<std::vector<int>> previousLinkedEntries(this->executionPlan.size());
+        for (int entryIndex = 0; entryIndex < this->executionPlan.size(); entryIndex++)
+        {
+            const std::shared_ptr<ISimulationBlock>& block = this->executionPlan[entryIndex].block;
+            for (int j = 0; j < this->executionPlan[entryIndex].outputPorts.size(); j++)
+            {
+                for (const auto& connectedBlock : this->simulationModel->GetConnectedBlocks(block, j).first)
+                {
+                    auto it = this->executionPlanIndexOfBlock.find(connectedBlock.get());
+                    if (it == this->executionPlanIndexOfBlock.end() || it->second == entryIndex)
+                    {
+                        continue;
+                    }
+                    previousLinkedEntries[std::max(entryIndex, it->second)].push_back(std::min(entryIndex, it->second));
+                }
+            }
+        }
 
-        for (const auto& [time, sampleTimes] : timeHitsToSampleTimes)
+        std::vector<int> levelOfEntry(this->executionPlan.size(), 0);
+        this->executionPlanLevels = {};
+        for (int entryIndex = 0; entryIndex < this->executionPlan.size(); entryIndex++)
         {
-            this->timeHits.push_back(time);
+            // An algebraic loop takes a single level, after the blocks linked to any of its entries
+            int entryCount = std::max(1, this->executionPlan[entryIndex].algebraicLoopEntryCount);
+            int level = 0;
+            for (int loopEntryIndex = entryIndex; loopEntryIndex < entryIndex + entryCount; loopEntryIndex++)
+            {
+                for (int previousEntry : previousLinkedEntries[loopEntryIndex])
+                {
+                    if (previousEntry < entryIndex)
+                    {
+                        level = std::max(level, levelOfEntry[previousEntry] + 1);
+                    }
+                }
+            }
+            for (int loopEntryIndex = entryIndex; loopEntryIndex < entryIndex + entryCount; loopEntryIndex++)
+            {
+                levelOfEntry[loopEntryIndex] = level;
+            }
+
+            if (level >= this->executionPlanLevels.size())
+            {
+                this->executionPlanLevels.resize(level + 1);
+            }
+            this->executionPlanLevels[level].push_back(entryIndex);
+            entryIndex += entryCount - 1;
+        }
+        this->scheduledEntriesOfLevel.reserve(this->executionPlan.size());
+    }
+
+    void SimulationManager::ProcessScheduledExecutionPlanEntriesInParallel(std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep)
+    {
+        const std::function<void (int)> processScheduledEntry = [&](int i) -> void {
+            int entryIndex = this->scheduledEntriesOfLevel[i];
+            this->ProcessExecutionPlanEntry(entryIndex, sampleTime ? sampleTime : this->executionPlan[entryIndex].block->GetSampleTime(), currentTime, isMinorStep);
+        };
+
+        for (const std::vector<int>& levelEntries : this->executionPlanLevels)
+        {
+            this->scheduledEntriesOfLevel.clear();
+            for (int entryIndex : levelEntries)
+            {
+                if (this->isExecutionPlanEntryScheduled[entryIndex])
+                {
+                    std::fill_n(this->isExecutionPlanEntryScheduled.begin() + entryIndex, std::max(1, this->executionPlan[entryIndex].algebraicLoopEntryCount), 0);
+                    this->scheduledEntriesOfLevel.push_back(entryIndex);
+                }
+            }
+            this->blockExecutor->Run(this->scheduledEntriesOfLevel.size(), processScheduledEntry);
         }
     }
 
@@ -331,7 +487,11 @@ namespace PySysLinkBase
         }
         else
         {
-            this->ProcessTimeHit(this->currentTime, this->nextSampleTimesToProcess);
+            // Nothing is pending after restoring a checkpoint of a full run
+            if (!this->nextSampleTimesToProcess.empty())
+            {
+                this->ProcessTimeHit(this->currentTime, this->nextSampleTimesToProcess);
+            }
 
             std::tuple<double, std::vector<std::shared_ptr<PySysLinkBase::SampleTime>>> nextTimeHitAndSampleTimes = this->GetNearestTimeHit(this->currentTime);
             
@@ -346,6 +506,11 @@ namespace PySysLinkBase
         return this->simulationOutput;
     }
 
+    std::shared_ptr<SimulationProfiler> SimulationManager::GetProfiler() const
+    {
+        return this->profiler;
+    }
+
     std::shared_ptr<SimulationOutput> SimulationManager::RunSimulation()
     {  
         if (this->isRunningStepByStep)
@@ -358,19 +523,40 @@ namespace PySysLinkBase
 
         auto simulationStartTime = std::chrono::system_clock::now();
         
-        this->MakeFirstSimulationStep();
-
-        int nextDiscreteTimeHitToProcessIndex = 0;
+        if (!this->isFirstStepDone)
+        {
+            this->MakeFirstSimulationStep();
+            this->isFirstStepDone = true;
+        }
+        else
+        {
+            // Resumed from a checkpoint, a time hit left pending by a step by step run is processed first
+            if (!this->nextSampleTimesToProcess.empty())
+            {
+                this->ProcessTimeHit(this->currentTime, this->nextSampleTimesToProcess);
+                this->nextSampleTimesToProcess = {};
+            }
+        }
 
         spdlog::get("default_pysyslink")->debug("Main simulation loop start");
         while (currentTime < simulationOptions->stopTime)
         {
-            std::tuple<double, int, std::vector<std::shared_ptr<SampleTime>>> timeIndexAndSampleTimes = this->GetNearestTimeHit(nextDiscreteTimeHitToProcessIndex);
-            double nearestTimeHit = std::get<0>(timeIndexAndSampleTimes);
-            nextDiscreteTimeHitToProcessIndex = std::get<1>(timeIndexAndSampleTimes);
-            std::vector<std::shared_ptr<SampleTime>> sampleTimesToProcess = std::get<2>(timeIndexAndSampleTimes);
+            // Clusters step on their own up to the next discrete time hit, where every group is synchronized again
+            if (this->continuousGroupExecutor && !simulationOptions->runInNaturalTime)
+            {
+                double synchronizationTime = simulationOptions->stopTime;
+                if (this->discreteTimeHitScheduler->HasNextTimeHit())
+                {
+                    synchronizationTime = std::min(synchronizationTime, this->discreteTimeHitScheduler->GetNextTimeHit());
+                }
+                this->AdvanceContinuousClusters(synchronizationTime);
+            }
+
+            std::tuple<double, std::vector<std::shared_ptr<SampleTime>>> timeAndSampleTimes = this->PopNearestTimeHit();
+            double nearestTimeHit = std::get<0>(timeAndSampleTimes);
+            std::vector<std::shared_ptr<SampleTime>> sampleTimesToProcess = std::get<1>(timeAndSampleTimes);
             
-            if (nextDiscreteTimeHitToProcessIndex == -1)
+            if (std::isnan(nearestTimeHit))
             {
                 break;
             }
@@ -400,6 +586,190 @@ namespace PySysLinkBase
         return this->simulationOutput;
     }
 
+    void SimulationManager::SaveSampleTime(CheckpointWriter& writer, const std::shared_ptr<SampleTime>& sampleTime) const
+    {
+        bool isContinuous = sampleTime->GetSampleTimeType() == SampleTimeType::continuous;
+        writer.Write(isContinuous);
+        if (isContinuous)
+        {
+            writer.Write<int>(sampleTime->GetContinuousSampleTimeGroup());
+        }
+        else
+        {
+            writer.Write<double>(sampleTime->GetDiscreteSampleTime());
+        }
+    }
+
+    std::shared_ptr<SampleTime> SimulationManager::RestoreSampleTime(CheckpointReader& reader) const
+    {
+        if (reader.Read<bool>())
+        {
+            int continuousSampleTimeGroup = reader.Read<int>();
+            int sampleTimeId = this->sampleTimeRegistry.FindContinuousId(continuousSampleTimeGroup);
+            if (sampleTimeId != -1)
+            {
+                return this->sampleTimeRegistry.GetSampleTime(sampleTimeId);
+            }
+            throw std::invalid_argument("Checkpoint refers to continuous sample time group " + std::to_string(continuousSampleTimeGroup) + ", which is not in the model");
+        }
+        else
+        {
+            double discreteSampleTime = reader.Read<double>();
+            int sampleTimeId = this->sampleTimeRegistry.FindDiscreteId(discreteSampleTime);
+            if (sampleTimeId != -1)
+            {
+                return this->sampleTimeRegistry.GetSampleTime(sampleTimeId);
+            }
+            throw std::invalid_argument("Checkpoint refers to discrete sample time " + std::to_string(discreteSampleTime) + ", which is not in the model");
+        }
+    }
+
+    std::vector<unsigned char> SimulationManager::SaveCheckpoint()
+    {
+        if (!this->isFirstStepDone)
+        {
+            throw std::runtime_error("Simulation has not started, there is no state to checkpoint");
+        }
+
+        CheckpointWriter writer;
+        writer.Write(checkpointMagicNumber);
+        writer.Write(this->currentTime);
+
+        writer.Write<std::uint64_t>(this->nextSampleTimesToProcess.size());
+        for (const auto& sampleTime : this->nextSampleTimesToProcess)
+        {
+            this->SaveSampleTime(writer, sampleTime);
+        }
+
+        writer.Write<std::uint64_t>(this->orderedBlocks.size());
+        for (const auto& block : this->orderedBlocks)
+        {
+            writer.WriteString(block->GetId());
+
+            std::vector<std::shared_ptr<InputPort>> inputPorts = block->GetInputPorts();
+            writer.Write<std::uint64_t>(inputPorts.size());
+            for (const auto& inputPort : inputPorts)
+            {
+                if (!writer.WriteSignalValue(inputPort->GetValue()))
+                {
+                    spdlog::get("default_pysyslink")->warn("Input value of block {} is not a fully supported type, it is not stored in the checkpoint", block->GetId());
+                }
+            }
+            const std::vector<std::shared_ptr<OutputPort>> outputPorts = block->GetOutputPorts();
+            writer.Write<std::uint64_t>(outputPorts.size());
+            for (const auto& outputPort : outputPorts)
+            {
+                if (!writer.WriteSignalValue(outputPort->GetValue()))
+                {
+                    spdlog::get("default_pysyslink")->warn("Output value of block {} is not a fully supported type, it is not stored in the checkpoint", block->GetId());
+                }
+            }
+
+            writer.WriteBytes(block->GetCheckpointState());
+        }
+
+        writer.Write<std::uint64_t>(this->continuousSampleTimeIds.size());
+        for (int sampleTimeId : this->continuousSampleTimeIds)
+        {
+            this->SaveSampleTime(writer, this->sampleTimeRegistry.GetSampleTime(sampleTimeId));
+            this->odeSolverOfEachSampleTimeId[sampleTimeId]->SaveCheckpoint(writer);
+        }
+
+        return writer.GetBlob();
+    }
+
+    void SimulationManager::RestoreCheckpoint(const std::vector<unsigned char>& checkpoint)
+    {
+        if (this->isFirstStepDone)
+        {
+            throw std::runtime_error("A checkpoint can only be restored before the simulation starts");
+        }
+
+        CheckpointReader reader(checkpoint);
+        if (reader.Read<std::uint32_t>() != checkpointMagicNumber)
+        {
+            throw std::invalid_argument("Data is not a simulation checkpoint");
+        }
+        this->currentTime = reader.Read<double>();
+
+        std::vector<std::shared_ptr<SampleTime>> pendingSampleTimes(reader.Read<std::uint64_t>());
+        for (auto& sampleTime : pendingSampleTimes)
+        {
+            sampleTime = this->RestoreSampleTime(reader);
+        }
+
+        std::unordered_map<std::string, std::shared_ptr<ISimulationBlock>> blockOfEachId;
+        for (const auto& block : this->orderedBlocks)
+        {
+            blockOfEachId.insert({block->GetId(), block});
+        }
+        std::size_t blockCount = reader.Read<std::uint64_t>();
+        if (blockCount != this->orderedBlocks.size())
+        {
+            throw std::invalid_argument("Checkpoint holds " + std::to_string(blockCount) + " blocks for a model with " + std::to_string(this->orderedBlocks.size()));
+        }
+        for (std::size_t i = 0; i < blockCount; i++)
+        {
+            std::string blockId = reader.ReadString();
+            auto it = blockOfEachId.find(blockId);
+            if (it == blockOfEachId.end())
+            {
+                throw std::invalid_argument("Checkpoint holds block " + blockId + ", which is not in the model");
+            }
+            std::shared_ptr<ISimulationBlock> block = it->second;
+
+            std::vector<std::shared_ptr<InputPort>> inputPorts = block->GetInputPorts();
+            if (reader.Read<std::uint64_t>() != inputPorts.size())
+            {
+                throw std::invalid_argument("Checkpoint does not match the input ports of block " + blockId);
+            }
+            for (const auto& inputPort : inputPorts)
+            {
+                std::shared_ptr<UnknownTypeSignalValue> value = reader.ReadSignalValue();
+                if (value)
+                {
+                    inputPort->SetValue(value);
+                }
+            }
+            const std::vector<std::shared_ptr<OutputPort>> outputPorts = block->GetOutputPorts();
+            if (reader.Read<std::uint64_t>() != outputPorts.size())
+            {
+                throw std::invalid_argument("Checkpoint does not match the output ports of block " + blockId);
+            }
+            for (const auto& outputPort : outputPorts)
+            {
+                std::shared_ptr<UnknownTypeSignalValue> value = reader.ReadSignalValue();
+                if (value)
+                {
+                    outputPort->SetValue(value);
+                }
+            }
+
+            block->RestoreCheckpointState(reader.ReadBytes());
+        }
+
+        std::size_t odeSolverCount = reader.Read<std::uint64_t>();
+        if (odeSolverCount != this->continuousSampleTimeIds.size())
+        {
+            throw std::invalid_argument("Checkpoint holds " + std::to_string(odeSolverCount) + " continuous sample time groups for a model with " + std::to_string(this->continuousSampleTimeIds.size()));
+        }
+        for (std::size_t i = 0; i < odeSolverCount; i++)
+        {
+            std::shared_ptr<SampleTime> sampleTime = this->RestoreSampleTime(reader);
+            this->odeSolverOfEachSampleTimeId[this->sampleTimeRegistry.FindId(sampleTime)]->RestoreCheckpoint(reader);
+        }
+
+        if (!reader.IsAtEnd())
+        {
+            throw std::invalid_argument("Checkpoint has data after the simulation state");
+        }
+
+        this->discreteTimeHitScheduler->SkipTimeHitsUpTo(this->currentTime);
+        this->nextSampleTimesToProcess = pendingSampleTimes;
+        this->isFirstStepDone = true;
+        spdlog::get("default_pysyslink")->debug("Simulation restored at time {}", this->currentTime);
+    }
+
     void SimulationManager::MakeFirstSimulationStep()
     {
         this->currentTime = simulationOptions->startTime;
@@ -410,12 +780,206 @@ namespace PySysLinkBase
             this->ProcessBlock(simulationModel, block, block->GetSampleTime(), currentTime);
         }
 
-        for (std::map<std::shared_ptr<SampleTime>, std::shared_ptr<BasicOdeSolver>>::iterator iter = this->odeSolversForEachContinuousSampleTimeGroup.begin(); iter != this->odeSolversForEachContinuousSampleTimeGroup.end(); ++iter)
+        std::vector<std::shared_ptr<SampleTime>> continuousSampleTimes = {};
+        for (int sampleTimeId : this->continuousSampleTimeIds)
+        {
+            continuousSampleTimes.push_back(this->sampleTimeRegistry.GetSampleTime(sampleTimeId));
+        }
+        this->DoContinuousSteps(continuousSampleTimes, currentTime, true);
+    }
+
+    void SimulationManager::ClusterLinkedContinuousSampleTimeGroups()
+    {
+        const std::vector<int>& groupSampleTimeIds = this->continuousSampleTimeIds;
+
+        // Union find over groups, joined by any block they share and by any link between their blocks
+        std::vector<int> parentGroup(groupSampleTimeIds.size());
+        for (int i = 0; i < parentGroup.size(); i++)
+        {
+            parentGroup[i] = i;
+        }
+        std::function<int (int)> findRootGroup = [&](int group) -> int {
+            return parentGroup[group] == group ? group : parentGroup[group] = findRootGroup(parentGroup[group]);
+        };
+
+        // A multirate block can be in several groups, all of them are stepped by the same cluster
+        std::unordered_map<const ISimulationBlock*, int> groupIndexOfBlock;
+        for (int groupIndex = 0; groupIndex < groupSampleTimeIds.size(); groupIndex++)
+        {
+            for (const auto& block : this->blocksOfEachSampleTimeId[groupSampleTimeIds[groupIndex]])
+            {
+                auto [it, isInserted] = groupIndexOfBlock.insert({block.get(), groupIndex});
+                if (!isInserted)
+                {
+                    parentGroup[findRootGroup(it->second)] = findRootGroup(groupIndex);
+                }
+            }
+        }
+
+        // Outputs are copied into the inputs of the blocks they feed, so groups feeding the same block, in a group or not,
+        // share a cluster and no input port is written from two workers
+        std::unordered_map<const ISimulationBlock*, int> feedingGroupIndexOfBlock;
+        for (int groupIndex = 0; groupIndex < groupSampleTimeIds.size(); groupIndex++)
+        {
+            for (const auto& block : this->blocksOfEachSampleTimeId[groupSampleTimeIds[groupIndex]])
+            {
+                for (int j = 0; j < block->GetOutputPorts().size(); j++)
+                {
+                    for (const auto& connectedBlock : this->simulationModel->GetConnectedBlocks(block, j).first)
+                    {
+                        auto it = groupIndexOfBlock.find(connectedBlock.get());
+                        if (it != groupIndexOfBlock.end())
+                        {
+                            parentGroup[findRootGroup(it->second)] = findRootGroup(groupIndex);
+                        }
+                        auto [feedingIt, isInserted] = feedingGroupIndexOfBlock.insert({connectedBlock.get(), groupIndex});
+                        if (!isInserted)
+                        {
+                            parentGroup[findRootGroup(feedingIt->second)] = findRootGroup(groupIndex);
+                        }
+                    }
+                }
+            }
+        }
+
+        this->clusterOfEachSampleTimeId = std::vector<int>(this->sampleTimeRegistry.GetCount(), -1);
+        std::map<int, int> clusterOfRootGroup;
+        for (int groupIndex = 0; groupIndex < groupSampleTimeIds.size(); groupIndex++)
+        {
+            int rootGroup = findRootGroup(groupIndex);
+            if (clusterOfRootGroup.find(rootGroup) == clusterOfRootGroup.end())
+            {
+                clusterOfRootGroup.insert({rootGroup, clusterOfRootGroup.size()});
+            }
+            this->clusterOfEachSampleTimeId[groupSampleTimeIds[groupIndex]] = clusterOfRootGroup[rootGroup];
+        }
+        this->continuousGroupClusterCount = clusterOfRootGroup.size();
+
+        this->continuousSampleTimeIdsOfEachCluster = std::vector<std::vector<int>>(this->continuousGroupClusterCount);
+        for (int sampleTimeId : groupSampleTimeIds)
+        {
+            this->continuousSampleTimeIdsOfEachCluster[this->clusterOfEachSampleTimeId[sampleTimeId]].push_back(sampleTimeId);
+        }
+    }
+
+    void SimulationManager::DoContinuousSteps(const std::vector<std::shared_ptr<SampleTime>>& sampleTimes, double currentTime, bool isFirstStep)
+    {
+        auto stepGroup = [&](const std::shared_ptr<SampleTime>& sampleTime) -> void {
+            std::shared_ptr<BasicOdeSolver> odeSolver = this->odeSolverOfEachSampleTimeId[this->sampleTimeRegistry.FindId(sampleTime)];
+            if (isFirstStep)
+            {
+                spdlog::get("default_pysyslink")->debug("First simulation step with continuous blocks of group {}", sampleTime->GetContinuousSampleTimeGroup());
+                odeSolver->DoStep(currentTime, odeSolver->firstTimeStep);
+                odeSolver->ComputeMajorOutputs(currentTime);
+            }
+            else
+            {
+                odeSolver->DoStep(currentTime, odeSolver->GetNextSuggestedTimeStep());
+            }
+        };
+
+        if (!this->continuousGroupExecutor)
+        {
+            for (const auto& sampleTime : sampleTimes)
+            {
+                if (sampleTime->GetSampleTimeType() == SampleTimeType::continuous)
+                {
+                    stepGroup(sampleTime);
+                }
+            }
+            return;
+        }
+
+        // Groups of a cluster keep the order they are given in, so each cluster sees the same sequence as on a single thread
+        std::vector<std::vector<std::shared_ptr<SampleTime>>> sampleTimesOfEachCluster(this->continuousGroupClusterCount);
+        for (const auto& sampleTime : sampleTimes)
+        {
+            if (sampleTime->GetSampleTimeType() == SampleTimeType::continuous)
+            {
+                sampleTimesOfEachCluster[this->clusterOfEachSampleTimeId[this->sampleTimeRegistry.FindId(sampleTime)]].push_back(sampleTime);
+            }
+        }
+
+        this->continuousGroupExecutor->Run(this->continuousGroupClusterCount, [&](int clusterIndex) -> void {
+            for (const auto& sampleTime : sampleTimesOfEachCluster[clusterIndex])
+            {
+                stepGroup(sampleTime);
+            }
+        });
+    }
+
+    void SimulationManager::AdvanceContinuousClusters(double synchronizationTime)
+    {
+        // Known events of a block are time hits of its own group, so they are resolved within its cluster
+        this->continuousGroupExecutor->Run(this->continuousGroupClusterCount, [&](int clusterIndex) -> void {
+            const std::vector<int>& sampleTimeIds = this->continuousSampleTimeIdsOfEachCluster[clusterIndex];
+            std::vector<int> sampleTimeIdsToProcess = {};
+            while (true)
+            {
+                double nearestTimeHit = std::numeric_limits<double>::quiet_NaN();
+                sampleTimeIdsToProcess.clear();
+                for (int sampleTimeId : sampleTimeIds)
+                {
+                    double nextTimeHit_i = this->odeSolverOfEachSampleTimeId[sampleTimeId]->GetNextTimeHit();
+                    if (std::isnan(nearestTimeHit) || nextTimeHit_i < nearestTimeHit)
+                    {
+                        nearestTimeHit = nextTimeHit_i;
+                        sampleTimeIdsToProcess = {sampleTimeId};
+                    }
+                    else if (nextTimeHit_i == nearestTimeHit)
+                    {
+                        sampleTimeIdsToProcess.push_back(sampleTimeId);
+                    }
+                }
+
+                // Hits at the synchronization time are left to the main loop, with the discrete ones
+                if (!(nearestTimeHit < synchronizationTime))
+                {
+                    return;
+                }
+                this->ProcessClusterTimeHit(nearestTimeHit, sampleTimeIdsToProcess);
+            }
+        });
+    }
+
+    void SimulationManager::ProcessClusterTimeHit(double currentTime, const std::vector<int>& sampleTimeIdsToProcess)
+    {
+        clusterTimeOfThread = currentTime;
+        if (sampleTimeIdsToProcess.size() == 1)
         {
-            spdlog::get("default_pysyslink")->debug("First simulation step with continuous blocks of group {}", iter->first->GetContinuousSampleTimeGroup());
-            iter->second->DoStep(currentTime, iter->second->firstTimeStep);
-            iter->second->ComputeMajorOutputs(currentTime);
+            auto odeSolver = this->odeSolverOfEachSampleTimeId[sampleTimeIdsToProcess.front()];
+            odeSolver->DoStep(currentTime, odeSolver->GetNextSuggestedTimeStep());
+            odeSolver->ComputeMajorOutputs(currentTime);
         }
+        else
+        {
+            // Same passes as a time hit of several sample times, over the plan entries of this cluster only.
+            // Blocks in several groups of the cluster are evaluated once per pass
+            std::vector<int> entryIndexes = {};
+            for (int sampleTimeId : sampleTimeIdsToProcess)
+            {
+                this->odeSolverOfEachSampleTimeId[sampleTimeId]->UpdateStatesToNextTimeHits();
+                const std::vector<int>& entryIndexesOfSampleTime = this->executionPlanIndexesOfEachSampleTimeId[sampleTimeId];
+                entryIndexes.insert(entryIndexes.end(), entryIndexesOfSampleTime.begin(), entryIndexesOfSampleTime.end());
+            }
+            std::sort(entryIndexes.begin(), entryIndexes.end());
+            entryIndexes.erase(std::unique(entryIndexes.begin(), entryIndexes.end()), entryIndexes.end());
+
+            for (int entryIndex : entryIndexes)
+            {
+                this->ProcessExecutionPlanEntry(entryIndex, this->executionPlan[entryIndex].block->GetSampleTime(), currentTime, true);
+            }
+            for (int sampleTimeId : sampleTimeIdsToProcess)
+            {
+                auto odeSolver = this->odeSolverOfEachSampleTimeId[sampleTimeId];
+                odeSolver->DoStep(currentTime, odeSolver->GetNextSuggestedTimeStep());
+            }
+            for (int entryIndex : entryIndexes)
+            {
+                this->ProcessExecutionPlanEntry(entryIndex, this->executionPlan[entryIndex].block->GetSampleTime(), currentTime, false);
+            }
+        }
+        clusterTimeOfThread = std::numeric_limits<double>::quiet_NaN();
     }
 
     void SimulationManager::ProcessTimeHit(double currentTime, const std::vector<std::shared_ptr<SampleTime>>& sampleTimesToProcess)
@@ -431,16 +995,28 @@ namespace PySysLinkBase
             for (const auto& sampleTime : sampleTimesToProcess)
             {
                 spdlog::get("default_pysyslink")->debug("Solving sample time of type: {}", SampleTime::SampleTimeTypeString(sampleTime->GetSampleTimeType()));            
+                int sampleTimeId = this->sampleTimeRegistry.FindId(sampleTime);
                 if (sampleTime->GetSampleTimeType() == SampleTimeType::discrete)
                 {
-                    for (auto& block : blocksForEachDiscreteSampleTime[sampleTime])
+                    if (this->blockExecutor)
                     {
-                        this->ProcessBlock(simulationModel, block, sampleTime, currentTime);
+                        for (int entryIndex : this->executionPlanIndexesOfEachSampleTimeId[sampleTimeId])
+                        {
+                            this->isExecutionPlanEntryScheduled[entryIndex] = 1;
+                        }
+                        this->ProcessScheduledExecutionPlanEntriesInParallel(sampleTime, currentTime, false);
+                    }
+                    else
+                    {
+                        for (int entryIndex : this->executionPlanIndexesOfEachSampleTimeId[sampleTimeId])
+                        {
+                            this->ProcessExecutionPlanEntry(entryIndex, sampleTime, currentTime);
+                        }
                     }
                 }
                 else if (sampleTime->GetSampleTimeType() == SampleTimeType::continuous)
                 {
-                    auto odeSolver = this->odeSolversForEachContinuousSampleTimeGroup[sampleTime];
+                    auto odeSolver = this->odeSolverOfEachSampleTimeId[sampleTimeId];
                     odeSolver->DoStep(currentTime, odeSolver->GetNextSuggestedTimeStep());
                     odeSolver->ComputeMajorOutputs(currentTime);
                 }
@@ -454,21 +1030,14 @@ namespace PySysLinkBase
             {
                 if (sampleTime->GetSampleTimeType() == SampleTimeType::continuous)
                 {
-                    auto odeSolver = this->odeSolversForEachContinuousSampleTimeGroup[sampleTime];
+                    auto odeSolver = this->odeSolverOfEachSampleTimeId[this->sampleTimeRegistry.FindId(sampleTime)];
                     odeSolver->UpdateStatesToNextTimeHits(); // So that the output of each block can be correctly calculated
                 }
             }           
             
             this->ProcessBlocksInSampleTimes(sampleTimesToProcess, true);
 
-            for (const auto& sampleTime : sampleTimesToProcess)
-            {
-                if (sampleTime->GetSampleTimeType() == SampleTimeType::continuous)
-                {
-                    auto odeSolver = this->odeSolversForEachContinuousSampleTimeGroup[sampleTime];
-                    odeSolver->DoStep(currentTime, odeSolver->GetNextSuggestedTimeStep());
-                }
-            }
+            this->DoContinuousSteps(sampleTimesToProcess, currentTime);
 
             this->ProcessBlocksInSampleTimes(sampleTimesToProcess, false);                
         }
@@ -476,84 +1045,48 @@ namespace PySysLinkBase
 
     void SimulationManager::ProcessBlocksInSampleTimes(const std::vector<std::shared_ptr<SampleTime>> sampleTimes, bool isMinorStep)
     {
-        for (const auto& block : this->orderedBlocks)
+        // Plan indexes of each sample time are sorted by execution order, so marking them and walking the plan keeps that order
+        for (const auto& sampleTime : sampleTimes)
         {
-            auto sampleTime = block->GetSampleTime();
-            
-            bool processBlock = false;
-            if (sampleTime->GetSampleTimeType() == SampleTimeType::discrete)
-            {
-                processBlock = this->IsBlockInSampleTimes(block, sampleTimes, this->blocksForEachDiscreteSampleTime);
-            }
-            else if (sampleTime->GetSampleTimeType() == SampleTimeType::continuous)
-            {
-                processBlock = this->IsBlockInSampleTimes(block, sampleTimes, this->blocksForEachContinuousSampleTimeGroup);
-            }
-            else if (sampleTime->GetSampleTimeType() == SampleTimeType::multirate)
-            {
-                bool processBlock1 = this->IsBlockInSampleTimes(block, sampleTimes, this->blocksForEachDiscreteSampleTime);
-                bool processBlock2 = this->IsBlockInSampleTimes(block, sampleTimes, this->blocksForEachContinuousSampleTimeGroup);
-                processBlock = processBlock1 || processBlock2;
-            }
-            // Only process if the sample time is in the current list to process
-            if (processBlock)
+            int sampleTimeId = this->sampleTimeRegistry.FindId(sampleTime);
+            if (sampleTimeId != -1)
             {
-                spdlog::get("default_pysyslink")->debug("Block to process on multiple time hit: {}", block->GetId()); 
-
-                this->ProcessBlock(simulationModel, block, sampleTime, currentTime, isMinorStep);
+                for (int entryIndex : this->executionPlanIndexesOfEachSampleTimeId[sampleTimeId])
+                {
+                    this->isExecutionPlanEntryScheduled[entryIndex] = 1;
+                }
             }
         }
-    }
 
+        if (this->blockExecutor)
+        {
+            this->ProcessScheduledExecutionPlanEntriesInParallel(nullptr, currentTime, isMinorStep);
+            return;
+        }
 
-    bool SimulationManager::IsBlockInSampleTimes(const std::shared_ptr<ISimulationBlock>& block, const std::vector<std::shared_ptr<SampleTime>>& sampleTimes, 
-                                            const std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>& blockMap)
-    {
-        for (const auto& sampleTime : sampleTimes)
+        for (int entryIndex = 0; entryIndex < this->executionPlan.size(); entryIndex++)
         {
-            auto it = blockMap.find(sampleTime);
-            if (it != blockMap.end())
+            if (this->isExecutionPlanEntryScheduled[entryIndex])
             {
-                // Use std::find to check if the block exists in the vector
-                if (std::find(it->second.begin(), it->second.end(), block) != it->second.end())
-                {
-                    return true;  // Block found in this sample time
-                }
+                this->isExecutionPlanEntryScheduled[entryIndex] = 0;
+                const std::shared_ptr<ISimulationBlock>& block = this->executionPlan[entryIndex].block;
+                spdlog::get("default_pysyslink")->debug("Block to process on multiple time hit: {}", block->GetId()); 
+
+                this->ProcessExecutionPlanEntry(entryIndex, block->GetSampleTime(), currentTime, isMinorStep);
             }
         }
-        return false;  // Block not found in any sample time
     }
 
     std::tuple<double, std::vector<std::shared_ptr<SampleTime>>> SimulationManager::GetNearestTimeHit(double currentTime)
     {
-        double nearestTimeHit = std::numeric_limits<double>::quiet_NaN();
-        std::vector<std::shared_ptr<SampleTime>> sampleTimesToProcess = {};
-
-        for (std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>::iterator iter = this->blocksForEachDiscreteSampleTime.begin(); iter != this->blocksForEachDiscreteSampleTime.end(); ++iter)
-        {
-            int elapsedTimeHits = currentTime / iter->first->GetDiscreteSampleTime();
-            double nextCandidateTimeHit = (elapsedTimeHits + 1) * iter->first->GetDiscreteSampleTime();
-            if (std::isnan(nearestTimeHit))
-            {
-                nearestTimeHit = nextCandidateTimeHit;
-                sampleTimesToProcess = {iter->first};
-            }
-            else if (nextCandidateTimeHit < nearestTimeHit)
-            {
-                nearestTimeHit = nextCandidateTimeHit;
-                sampleTimesToProcess = {iter->first};
-            }
-            else if (nextCandidateTimeHit == nearestTimeHit)
-            {
-                sampleTimesToProcess.push_back(iter->first);
-            }
-        }
+        auto [nearestTimeHit, sampleTimesToProcess] = this->discreteTimeHitScheduler->GetFirstTimeHitAfter(currentTime);
 
-        for (std::map<std::shared_ptr<SampleTime>, std::shared_ptr<BasicOdeSolver>>::iterator iter = this->odeSolversForEachContinuousSampleTimeGroup.begin(); iter != this->odeSolversForEachContinuousSampleTimeGroup.end(); ++iter)
+        for (int sampleTimeId : this->continuousSampleTimeIds)
         {
             spdlog::get("default_pysyslink")->debug("Looking on continuous sample time...");
 
-            double nextTimeHit_i = iter->second->GetNextTimeHit();
+            const std::shared_ptr<SampleTime>& sampleTime = this->sampleTimeRegistry.GetSampleTime(sampleTimeId);
+            double nextTimeHit_i = this->odeSolverOfEachSampleTimeId[sampleTimeId]->GetNextTimeHit();
             if (nextTimeHit_i > this->simulationOptions->stopTime) {
                 spdlog::get("default_pysyslink")->debug("Continuous sample time hit is after simulation stop time, last step.");
                 nextTimeHit_i = this->simulationOptions->stopTime;
@@ -562,78 +1095,90 @@ namespace PySysLinkBase
             if (std::isnan(nearestTimeHit))
             {
                 nearestTimeHit = nextTimeHit_i;
-                sampleTimesToProcess = {iter->first};
+                sampleTimesToProcess = {sampleTime};
             }
             else if (nextTimeHit_i < nearestTimeHit)
             {
                 nearestTimeHit = nextTimeHit_i;
-                sampleTimesToProcess = {iter->first};
+                sampleTimesToProcess = {sampleTime};
             }
             else if (nextTimeHit_i == nearestTimeHit)
             {
                 spdlog::get("default_pysyslink")->debug("New continuous sample time hit at the same moment!");
-                sampleTimesToProcess.push_back(iter->first);
+                sampleTimesToProcess.push_back(sampleTime);
             }
         }
 
         return {nearestTimeHit, sampleTimesToProcess};
     }
 
-    std::tuple<double, int, std::vector<std::shared_ptr<SampleTime>>> SimulationManager::GetNearestTimeHit(int nextDiscreteTimeHitToProcessIndex)
+    std::tuple<double, std::vector<std::shared_ptr<SampleTime>>> SimulationManager::PopNearestTimeHit()
     {
         double nearestTimeHit = std::numeric_limits<double>::quiet_NaN();
         std::vector<std::shared_ptr<SampleTime>> sampleTimesToProcess = {};
 
-        spdlog::get("default_pysyslink")->debug("Time hits size: {}", this->timeHits.size());
-        if (this->timeHits.size() != 0)
+        double nextDiscreteTimeHit = std::numeric_limits<double>::quiet_NaN();
+        if (this->discreteTimeHitScheduler->HasNextTimeHit())
         {
-            nearestTimeHit = this->timeHits[nextDiscreteTimeHitToProcessIndex];
-            sampleTimesToProcess = this->timeHitsToSampleTimes[this->timeHits[nextDiscreteTimeHitToProcessIndex]];
+            nextDiscreteTimeHit = this->discreteTimeHitScheduler->GetNextTimeHit();
+            nearestTimeHit = nextDiscreteTimeHit;
         }
 
-        for (std::map<std::shared_ptr<SampleTime>, std::shared_ptr<BasicOdeSolver>>::iterator iter = this->odeSolversForEachContinuousSampleTimeGroup.begin(); iter != this->odeSolversForEachContinuousSampleTimeGroup.end(); ++iter)
+        for (int sampleTimeId : this->continuousSampleTimeIds)
         {
             spdlog::get("default_pysyslink")->debug("Looking on continuous sample time...");
 
-            double nextTimeHit_i = iter->second->GetNextTimeHit();
+            const std::shared_ptr<SampleTime>& sampleTime = this->sampleTimeRegistry.GetSampleTime(sampleTimeId);
+            double nextTimeHit_i = this->odeSolverOfEachSampleTimeId[sampleTimeId]->GetNextTimeHit();
             
             if (std::isnan(nearestTimeHit))
             {
                 nearestTimeHit = nextTimeHit_i;
-                sampleTimesToProcess = {iter->first};
+                sampleTimesToProcess = {sampleTime};
             }
             else if (nextTimeHit_i < nearestTimeHit)
             {
                 nearestTimeHit = nextTimeHit_i;
-                sampleTimesToProcess = {iter->first};
+                sampleTimesToProcess = {sampleTime};
             }
             else if (nextTimeHit_i == nearestTimeHit)
             {
                 spdlog::get("default_pysyslink")->debug("New continuous sample time hit at the same moment!");
-                sampleTimesToProcess.push_back(iter->first);
+                sampleTimesToProcess.push_back(sampleTime);
             }
         }
 
-        if (this->timeHits.size() != 0)
+        // Discrete sample times go first when a continuous group is hit at the same time
+        if (nearestTimeHit == nextDiscreteTimeHit)
         {
-            if (nearestTimeHit == this->timeHits[nextDiscreteTimeHitToProcessIndex])
-            {
-                nextDiscreteTimeHitToProcessIndex += 1;
-                if (nextDiscreteTimeHitToProcessIndex > this->timeHits.size())
-                {
-                    spdlog::get("default_pysyslink")->debug("Too much index to look for");
-                    return {0.0, -1, sampleTimesToProcess};
-                }
-            }
+            std::vector<std::shared_ptr<SampleTime>> discreteSampleTimesToProcess = this->discreteTimeHitScheduler->PopNextTimeHit();
+            sampleTimesToProcess.insert(sampleTimesToProcess.begin(), discreteSampleTimesToProcess.begin(), discreteSampleTimesToProcess.end());
         }
 
-        return {nearestTimeHit, nextDiscreteTimeHitToProcessIndex, sampleTimesToProcess};
+        return {nearestTimeHit, sampleTimesToProcess};
     }
 
     void SimulationManager::ProcessBlock(std::shared_ptr<SimulationModel> simulationModel, std::shared_ptr<ISimulationBlock> block, std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep)
     {
-        spdlog::get("default_pysyslink")->debug("Processing block: {} at time {}", block->GetId(), currentTime);
-        block->ComputeOutputsOfBlock(sampleTime, currentTime, isMinorStep);
+        auto it = this->executionPlanIndexOfBlock.find(block.get());
+        if (it != this->executionPlanIndexOfBlock.end())
+        {
+            const std::shared_ptr<AlgebraicLoopSolver>& algebraicLoopSolver = this->executionPlan[it->second].algebraicLoopSolver;
+            if (algebraicLoopSolver)
+            {
+                algebraicLoopSolver->Solve(sampleTime, currentTime, isMinorStep);
+                return;
+            }
+            this->ProcessExecutionPlanEntry(it->second, sampleTime, currentTime, isMinorStep);
+            return;
+        }
+
+        spdlog::get("default_pysyslink")->debug("Processing block out of execution plan: {} at time {}", block->GetId(), currentTime);
+        {
+            ProfiledScope profiledScope(this->profiler.get(), *block);
+            block->ComputeOutputsOfBlock(sampleTime, currentTime, isMinorStep);
+        }
+        ProfiledScope profiledScope(this->profiler.get(), ProfiledPhase::linkPropagation);
         for (int i = 0; i < block->GetOutputPorts().size(); i++)
         {
             for (auto& connectedPort : simulationModel->GetConnectedPorts(block, i))
@@ -642,4 +1187,31 @@ namespace PySysLinkBase
             }
         }
     }
+
+    void SimulationManager::ProcessExecutionPlanEntry(int entryIndex, std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep)
+    {
+        const ExecutionPlanEntry& entry = this->executionPlan[entryIndex];
+        if (entry.algebraicLoopSolver)
+        {
+            if (entry.algebraicLoopEntryCount > 0)
+            {
+                spdlog::get("default_pysyslink")->debug("Solving algebraic loop of block: {} at time {}", entry.block->GetId(), currentTime);
+                entry.algebraicLoopSolver->Solve(sampleTime, currentTime, isMinorStep);
+            }
+            return;
+        }
+        spdlog::get("default_pysyslink")->debug("Processing block: {} at time {}", entry.block->GetId(), currentTime);
+        {
+            ProfiledScope profiledScope(this->profiler.get(), *entry.block);
+            entry.block->ComputeOutputsOfBlock(sampleTime, currentTime, isMinorStep);
+        }
+        ProfiledScope profiledScope(this->profiler.get(), ProfiledPhase::linkPropagation);
+        for (int i = 0; i < entry.outputPorts.size(); i++)
+        {
+            for (const auto& connectedPort : entry.connectedPortsOfEachOutput[i])
+            {
+                entry.outputPorts[i]->TryCopyValueToPort(*connectedPort);
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -7,10 +7,17 @@
 #include "ContinuousAndOde/IOdeStepSolver.h"
 #include "SimulationOutput.h"
 #include "BlockEvents/ValueUpdateBlockEvent.h"
+#include "ParallelBlockExecutor.h"
+#include "SimulationCheckpoint.h"
+#include "DiscreteTimeHitScheduler.h"
+#include "AlgebraicLoopSolver.h"
+#include "SampleTimeRegistry.h"
+#include "SimulationProfiler.h"
 
 #include <tuple>
 #include <unordered_map>
 #include <functional>
+#include <mutex>
 
 namespace PySysLinkBase
 {
@@ -18,52 +25,108 @@ namespace PySysLinkBase
     {
         public:
         SimulationManager(std::shared_ptr<SimulationModel> simulationModel, std::shared_ptr<SimulationOptions> simulationOptions);
+        // Skips ordering the blocks, orderedBlocks must be an execution order of the blocks of simulationModel
+        SimulationManager(std::shared_ptr<SimulationModel> simulationModel, std::shared_ptr<SimulationOptions> simulationOptions, std::vector<std::shared_ptr<ISimulationBlock>> orderedBlocks);
+        static std::vector<std::shared_ptr<ISimulationBlock>> OrderBlocks(std::shared_ptr<SimulationModel> simulationModel);
         std::shared_ptr<SimulationOutput> RunSimulation();
 
         double RunSimulationStep();
         std::shared_ptr<SimulationOutput> GetSimulationOutput();
 
+        // Binary snapshot of the simulation state, taken after RunSimulation or between calls to RunSimulationStep.
+        // It can be restored into a manager of the same model, even with a later stop time, before running it
+        std::vector<unsigned char> SaveCheckpoint();
+        void RestoreCheckpoint(const std::vector<unsigned char>& checkpoint);
+
+        // Null unless profiling is activated in the simulation options
+        std::shared_ptr<SimulationProfiler> GetProfiler() const;
+
         private:
         bool hasRunFullSimulation = false;
         bool isRunningStepByStep = false;
         bool isFirstStepDone = false;
+        static constexpr std::uint32_t checkpointMagicNumber = 0x434C5350; // "PSLC"
         std::vector<std::shared_ptr<SampleTime>> nextSampleTimesToProcess = {};
 
         void ClassifyBlocks(std::vector<std::shared_ptr<PySysLinkBase::ISimulationBlock>> orderedBlocks, 
-                            std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>& blocksForEachDiscreteSampleTime,
-                            std::vector<std::shared_ptr<ISimulationBlock>>& blocksWithConstantSampleTime,
-                            std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>& blocksForEachContinuousSampleTimeGroup);
+                            std::vector<std::vector<std::shared_ptr<ISimulationBlock>>>& blocksOfEachSampleTimeId,
+                            std::vector<std::shared_ptr<ISimulationBlock>>& blocksWithConstantSampleTime);
     
         void ProcessBlock(std::shared_ptr<SimulationModel> simulationModel, std::shared_ptr<ISimulationBlock> block, std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep=false);
 
-        void GetTimeHitsToSampleTimes(std::shared_ptr<SimulationOptions> simulationOptions, std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>> blocksForEachDiscreteSampleTime);
-
-        std::tuple<double, int, std::vector<std::shared_ptr<SampleTime>>> GetNearestTimeHit(int nextDiscreteTimeHitToProcessIndex);
+        // Output ports and their destination input ports, resolved once so time hits do not query the model graph
+        struct ExecutionPlanEntry
+        {
+            std::shared_ptr<ISimulationBlock> block;
+            std::vector<std::shared_ptr<OutputPort>> outputPorts;
+            std::vector<std::vector<std::shared_ptr<InputPort>>> connectedPortsOfEachOutput;
+            // Entries of an algebraic loop are contiguous; the loop is solved on its first entry, which holds the entry count, the others are skipped
+            std::shared_ptr<AlgebraicLoopSolver> algebraicLoopSolver;
+            int algebraicLoopEntryCount = 0;
+        };
+
+        std::vector<ExecutionPlanEntry> executionPlan; // Same order as orderedBlocks
+        std::unordered_map<const ISimulationBlock*, int> executionPlanIndexOfBlock;
+        std::vector<std::vector<int>> executionPlanIndexesOfEachSampleTimeId;
+        std::vector<char> isExecutionPlanEntryScheduled;
+
+        void CompileExecutionPlan();
+        void CompileAlgebraicLoops();
+        std::vector<std::shared_ptr<AlgebraicLoopSolver>> algebraicLoopSolvers;
+        void ProcessExecutionPlanEntry(int entryIndex, std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep=false);
+
+        // Entries of each level in plan order. Linked entries are always in different levels, in the same relative order as in the plan
+        std::vector<std::vector<int>> executionPlanLevels;
+        std::vector<int> scheduledEntriesOfLevel;
+        std::unique_ptr<ParallelBlockExecutor> blockExecutor; // Only created when more than one thread is requested
+        std::mutex callbackMutex; // Callbacks of blocks evaluated in parallel share the output and the forced updates
+
+        // Continuous groups linked to each other, sharing a block or feeding the same block share a cluster; different clusters are stepped on different workers
+        std::vector<int> clusterOfEachSampleTimeId; // Only continuous ids are in a cluster
+        std::vector<std::vector<int>> continuousSampleTimeIdsOfEachCluster;
+        int continuousGroupClusterCount = 0;
+        std::unique_ptr<ParallelBlockExecutor> continuousGroupExecutor;
+
+        void ClusterLinkedContinuousSampleTimeGroups();
+        void DoContinuousSteps(const std::vector<std::shared_ptr<SampleTime>>& sampleTimes, double currentTime, bool isFirstStep=false);
+        // Each cluster processes the time hits of its groups before synchronizationTime on its worker, and all of them are joined on return
+        void AdvanceContinuousClusters(double synchronizationTime);
+        void ProcessClusterTimeHit(double currentTime, const std::vector<int>& sampleTimeIdsToProcess);
+
+        std::unique_lock<std::mutex> LockCallbackStateIfParallel();
+
+        void LevelizeExecutionPlan();
+        // Processes the scheduled entries level by level; a null sample time uses the sample time of each block
+        void ProcessScheduledExecutionPlanEntriesInParallel(std::shared_ptr<SampleTime> sampleTime, double currentTime, bool isMinorStep);
+
+        // Next time hit of the full run, a discrete time hit is consumed once it is returned
+        std::tuple<double, std::vector<std::shared_ptr<SampleTime>>> PopNearestTimeHit();
         std::tuple<double, std::vector<std::shared_ptr<SampleTime>>> GetNearestTimeHit(double currentTime);
 
 
-        std::map<std::shared_ptr<SampleTime>, std::shared_ptr<BasicOdeSolver>> odeSolversForEachContinuousSampleTimeGroup;
+        // Discrete periods and continuous groups of the blocks, tables below are indexed by their id
+        SampleTimeRegistry sampleTimeRegistry;
+        std::vector<int> discreteSampleTimeIds;
+        std::vector<int> continuousSampleTimeIds;
 
-        std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>> blocksForEachDiscreteSampleTime;
-        std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>> blocksForEachContinuousSampleTimeGroup;
-        std::vector<std::shared_ptr<ISimulationBlock>> blocksWithConstantSampleTime;
+        std::vector<std::shared_ptr<BasicOdeSolver>> odeSolverOfEachSampleTimeId; // Null for discrete ids
 
-        bool IsBlockInSampleTimes(const std::shared_ptr<ISimulationBlock>& block, const std::vector<std::shared_ptr<SampleTime>>& sampleTimes, 
-                                            const std::map<std::shared_ptr<SampleTime>, std::vector<std::shared_ptr<ISimulationBlock>>>& blockMap);
+        std::vector<std::vector<std::shared_ptr<ISimulationBlock>>> blocksOfEachSampleTimeId;
+        std::vector<std::shared_ptr<ISimulationBlock>> blocksWithConstantSampleTime;
 
-        std::map<double, std::vector<std::shared_ptr<SampleTime>>> timeHitsToSampleTimes;
-        std::vector<double> timeHits;
+        std::unique_ptr<DiscreteTimeHitScheduler> discreteTimeHitScheduler;
         double currentTime;
 
         std::shared_ptr<SimulationModel> simulationModel;
         std::shared_ptr<SimulationOptions> simulationOptions;
 
         std::shared_ptr<SimulationOutput> simulationOutput;
+        std::shared_ptr<SimulationProfiler> profiler;
 
         void ValueUpdateBlockEventCallback(const std::shared_ptr<ValueUpdateBlockEvent> blockEvent);
 
-        void LogSignalInputReadCallback(const std::string blockId, const std::vector<std::shared_ptr<PySysLinkBase::InputPort>> inputPorts, int inputPortIndex, std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime);
-        void LogSignalOutputUpdateCallback(const std::string blockId, const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>> outputPorts, int outputPortIndex, std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime);
+        void LogSignalInputReadCallback(const std::string& blockId, const std::vector<std::shared_ptr<PySysLinkBase::InputPort>>& inputPorts, int inputPortIndex, int signalHandle, std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime);
+        void LogSignalOutputUpdateCallback(const std::string& blockId, const std::vector<std::shared_ptr<PySysLinkBase::OutputPort>>& outputPorts, int outputPortIndex, int signalHandle, std::shared_ptr<PySysLinkBase::SampleTime> sampleTime, double currentTime);
         void UpdateConfigurationValueCallback(const std::string blockId, const std::string keyName, ConfigurationValue value);
 
         std::unordered_map<const Port*, const Port*> portToLogInToAvoidRepetition = {};
@@ -71,6 +134,9 @@ namespace PySysLinkBase
 
         std::vector<std::shared_ptr<PySysLinkBase::ISimulationBlock>> orderedBlocks;
 
+        void SaveSampleTime(CheckpointWriter& writer, const std::shared_ptr<SampleTime>& sampleTime) const;
+        std::shared_ptr<SampleTime> RestoreSampleTime(CheckpointReader& reader) const;
+
         void ProcessBlocksInSampleTimes(const std::vector<std::shared_ptr<SampleTime>> sampleTimes, bool isMinorStep=false);
         void MakeFirstSimulationStep();
         void ProcessTimeHit(double time, const std::vector<std::shared_ptr<SampleTime>>& sampleTimesToProcess);
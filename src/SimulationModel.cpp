@@ -1,26 +1,142 @@
 #include "SimulationModel.h"
+#include <algorithm>
 #include <stdexcept>
 #include <unordered_set>
 #include <numeric>
+#include <queue>
+#include <functional>
 #include "spdlog/spdlog.h"
 
 namespace PySysLinkBase
 {  
+    namespace
+    {
+        // Blocks waiting to be examined, taken in model order in sweeps: a block pushed behind the last one taken waits
+        // for the next sweep, so blocks are examined in the order the sweeps over every block examined them
+        class SampleTimePropagationWorklist
+        {
+            public:
+            SampleTimePropagationWorklist(int blockCount) : isPending(blockCount, 0) {}
+
+            void Push(int blockIndex)
+            {
+                if (this->isPending[blockIndex])
+                {
+                    return;
+                }
+                this->isPending[blockIndex] = 1;
+                if (blockIndex > this->lastBlockIndex)
+                {
+                    this->currentSweep.push(blockIndex);
+                }
+                else
+                {
+                    this->nextSweep.push(blockIndex);
+                }
+            }
+
+            bool TryPop(int& blockIndex)
+            {
+                if (this->currentSweep.empty())
+                {
+                    std::swap(this->currentSweep, this->nextSweep);
+                    this->lastBlockIndex = -1;
+                }
+                if (this->currentSweep.empty())
+                {
+                    return false;
+                }
+                blockIndex = this->currentSweep.top();
+                this->currentSweep.pop();
+                this->isPending[blockIndex] = 0;
+                this->lastBlockIndex = blockIndex;
+                return true;
+            }
+
+            bool IsEmpty() const
+            {
+                return this->currentSweep.empty() && this->nextSweep.empty();
+            }
+
+            private:
+            std::vector<char> isPending;
+            std::priority_queue<int, std::vector<int>, std::greater<int>> currentSweep;
+            std::priority_queue<int, std::vector<int>, std::greater<int>> nextSweep;
+            int lastBlockIndex = -1;
+        };
+    }
+
     SimulationModel::SimulationModel(std::vector<std::shared_ptr<ISimulationBlock>> simulationBlocks, std::vector<std::shared_ptr<PortLink>> portLinks, std::shared_ptr<IBlockEventsHandler> blockEventsHandler) 
     {
         this->simulationBlocks.insert(this->simulationBlocks.end(), std::make_move_iterator(simulationBlocks.begin()), std::make_move_iterator(simulationBlocks.end()));
         this->portLinks.insert(this->portLinks.end(), std::make_move_iterator(portLinks.begin()), std::make_move_iterator(portLinks.end()));
         this->blockEventsHandler = blockEventsHandler;
+
+        this->BuildPortLinksIndex();
+    }
+
+    void SimulationModel::AddPortLink(std::shared_ptr<PortLink> portLink)
+    {
+        this->IndexPortLink(portLink);
+        this->portLinks.push_back(std::move(portLink));
+    }
+
+    void SimulationModel::RebuildPortLinksIndex()
+    {
+        this->BuildPortLinksIndex();
+    }
+
+    void SimulationModel::BuildPortLinksIndex()
+    {
+        this->linksOfEachOutputPort = {};
+        this->linkOfEachInputPort = {};
+
+        for (const auto& portLink : this->portLinks)
+        {
+            this->IndexPortLink(portLink);
+        }
+    }
+
+    void SimulationModel::IndexPortLink(const std::shared_ptr<PortLink>& portLink)
+    {
+        if (portLink->originBlockPortIndex < 0 || portLink->originBlockPortIndex >= portLink->originBlock->GetOutputPorts().size())
+        {
+            throw std::out_of_range("Link from output port " + std::to_string(portLink->originBlockPortIndex) + " of block " + portLink->originBlock->GetId() + ", which does not exist.");
+        }
+        std::vector<std::shared_ptr<InputPort>> sinkPorts = portLink->sinkBlock->GetInputPorts();
+        if (portLink->sinkBlockPortIndex < 0 || portLink->sinkBlockPortIndex >= sinkPorts.size())
+        {
+            throw std::out_of_range("Link to input port " + std::to_string(portLink->sinkBlockPortIndex) + " of block " + portLink->sinkBlock->GetId() + ", which does not exist.");
+        }
+
+        std::vector<std::vector<IndexedPortLink>>& originLinks = this->linksOfEachOutputPort[portLink->originBlock.get()];
+        if (originLinks.size() <= portLink->originBlockPortIndex)
+        {
+            originLinks.resize(portLink->originBlockPortIndex + 1);
+        }
+        originLinks[portLink->originBlockPortIndex].push_back({portLink, sinkPorts[portLink->sinkBlockPortIndex]});
+
+        std::vector<std::shared_ptr<PortLink>>& sinkLinks = this->linkOfEachInputPort[portLink->sinkBlock.get()];
+        if (sinkLinks.size() <= portLink->sinkBlockPortIndex)
+        {
+            sinkLinks.resize(portLink->sinkBlockPortIndex + 1);
+        }
+        // Keep the first link found, as a linear search over portLinks would
+        if (!sinkLinks[portLink->sinkBlockPortIndex])
+        {
+            sinkLinks[portLink->sinkBlockPortIndex] = portLink;
+        }
     }
 
     const std::vector<std::shared_ptr<InputPort>> SimulationModel::GetConnectedPorts(const std::shared_ptr<ISimulationBlock> originBlock, int outputPortIndex) const
     {
         std::vector<std::shared_ptr<InputPort>> connectedPorts = {};
-        for (int i=0; i < this->portLinks.size(); i++)
+        auto it = this->linksOfEachOutputPort.find(originBlock.get());
+        if (it != this->linksOfEachOutputPort.end() && outputPortIndex >= 0 && outputPortIndex < it->second.size())
         {
-            if (this->portLinks[i]->originBlock == originBlock && this->portLinks[i]->originBlockPortIndex == outputPortIndex)
+            for (const auto& indexedPortLink : it->second[outputPortIndex])
             {
-                connectedPorts.push_back(this->portLinks[i]->sinkBlock->GetInputPorts()[this->portLinks[i]->sinkBlockPortIndex]);
+                connectedPorts.push_back(indexedPortLink.sinkPort);
             }
         }
         return connectedPorts;
@@ -30,17 +146,318 @@ namespace PySysLinkBase
     {
         std::vector<std::shared_ptr<ISimulationBlock>> connectedBlocks = {};
         std::vector<int> connectedPortIndexes = {};
-        for (int i=0; i < this->portLinks.size(); i++)
+        auto it = this->linksOfEachOutputPort.find(originBlock.get());
+        if (it != this->linksOfEachOutputPort.end() && outputPortIndex >= 0 && outputPortIndex < it->second.size())
         {
-            if (this->portLinks[i]->originBlock == originBlock && this->portLinks[i]->originBlockPortIndex == outputPortIndex)
+            for (const auto& indexedPortLink : it->second[outputPortIndex])
             {
-                connectedBlocks.push_back(this->portLinks[i]->sinkBlock);
-                connectedPortIndexes.push_back(this->portLinks[i]->sinkBlockPortIndex);
+                connectedBlocks.push_back(indexedPortLink.portLink->sinkBlock);
+                connectedPortIndexes.push_back(indexedPortLink.portLink->sinkBlockPortIndex);
             }
         }
         return std::pair<std::vector<std::shared_ptr<ISimulationBlock>>, std::vector<int>>(connectedBlocks, connectedPortIndexes);
     }
 
+    bool SimulationModel::IsDirectFeedthroughLink(const std::shared_ptr<ISimulationBlock>& originBlock, const std::shared_ptr<ISimulationBlock>& sinkBlock, int sinkBlockPortIndex) const
+    {
+        return sinkBlock->GetInputPorts()[sinkBlockPortIndex]->HasDirectFeedthrough() && this->GetOriginBlock(sinkBlock, sinkBlockPortIndex) == originBlock;
+    }
+
+    const std::vector<std::vector<std::shared_ptr<ISimulationBlock>>> SimulationModel::GetAlgebraicLoops() const
+    {
+        std::unordered_map<const ISimulationBlock*, int> indexOfBlock = {};
+        for (int i = 0; i < this->simulationBlocks.size(); i++)
+        {
+            indexOfBlock.insert({this->simulationBlocks[i].get(), i});
+        }
+
+        std::vector<std::vector<int>> successorsOfEachBlock(this->simulationBlocks.size());
+        std::vector<char> hasSelfLoop(this->simulationBlocks.size(), 0);
+        for (int i = 0; i < this->simulationBlocks.size(); i++)
+        {
+            const std::shared_ptr<ISimulationBlock>& block = this->simulationBlocks[i];
+            for (int j = 0; j < block->GetOutputPorts().size(); j++)
+            {
+                const auto [connectedBlocks, connectedPortIndexes] = this->GetConnectedBlocks(block, j);
+                for (int k = 0; k < connectedBlocks.size(); k++)
+                {
+                    auto it = indexOfBlock.find(connectedBlocks[k].get());
+                    if (it == indexOfBlock.end() || !this->IsDirectFeedthroughLink(block, connectedBlocks[k], connectedPortIndexes[k]))
+                    {
+                        continue;
+                    }
+                    successorsOfEachBlock[i].push_back(it->second);
+                    hasSelfLoop[i] |= it->second == i;
+                }
+            }
+        }
+
+        // Tarjan's strongly connected components, with an explicit stack so long chains do not exhaust the call stack
+        std::vector<int> visitIndexOfBlock(this->simulationBlocks.size(), -1);
+        std::vector<int> lowLinkOfBlock(this->simulationBlocks.size(), 0);
+        std::vector<char> isOnComponentStack(this->simulationBlocks.size(), 0);
+        std::vector<int> componentStack = {};
+        std::vector<std::pair<int, int>> searchStack = {}; // Block and its next successor to visit
+        std::vector<std::vector<std::shared_ptr<ISimulationBlock>>> algebraicLoops = {};
+        int nextVisitIndex = 0;
+
+        for (int root = 0; root < this->simulationBlocks.size(); root++)
+        {
+            if (visitIndexOfBlock[root] != -1)
+            {
+                continue;
+            }
+            searchStack.push_back({root, 0});
+            while (!searchStack.empty())
+            {
+                auto& [block, nextSuccessor] = searchStack.back();
+                if (nextSuccessor == 0 && visitIndexOfBlock[block] == -1)
+                {
+                    visitIndexOfBlock[block] = lowLinkOfBlock[block] = nextVisitIndex++;
+                    componentStack.push_back(block);
+                    isOnComponentStack[block] = 1;
+                }
+
+                if (nextSuccessor < successorsOfEachBlock[block].size())
+                {
+                    int successor = successorsOfEachBlock[block][nextSuccessor++];
+                    if (visitIndexOfBlock[successor] == -1)
+                    {
+                        searchStack.push_back({successor, 0});
+                    }
+                    else if (isOnComponentStack[successor])
+                    {
+                        lowLinkOfBlock[block] = std::min(lowLinkOfBlock[block], visitIndexOfBlock[successor]);
+                    }
+                    continue;
+                }
+
+                int finishedBlock = block;
+                searchStack.pop_back();
+                if (!searchStack.empty())
+                {
+                    int parentBlock = searchStack.back().first;
+                    lowLinkOfBlock[parentBlock] = std::min(lowLinkOfBlock[parentBlock], lowLinkOfBlock[finishedBlock]);
+                }
+                if (lowLinkOfBlock[finishedBlock] != visitIndexOfBlock[finishedBlock])
+                {
+                    continue;
+                }
+
+                std::vector<int> component = {};
+                int member;
+                do
+                {
+                    member = componentStack.back();
+                    componentStack.pop_back();
+                    isOnComponentStack[member] = 0;
+                    component.push_back(member);
+                } while (member != finishedBlock);
+
+                if (component.size() > 1 || hasSelfLoop[finishedBlock])
+                {
+                    std::sort(component.begin(), component.end());
+                    std::vector<std::shared_ptr<ISimulationBlock>> algebraicLoop = {};
+                    for (int memberIndex : component)
+                    {
+                        algebraicLoop.push_back(this->simulationBlocks[memberIndex]);
+                    }
+                    algebraicLoops.push_back(algebraicLoop);
+                }
+            }
+        }
+
+        std::sort(algebraicLoops.begin(), algebraicLoops.end(), [&indexOfBlock](const auto& lhs, const auto& rhs)
+        {
+            return indexOfBlock.at(lhs.front().get()) < indexOfBlock.at(rhs.front().get());
+        });
+        return algebraicLoops;
+    }
+
+    std::vector<std::shared_ptr<ISimulationBlock>> SimulationModel::OrderAlgebraicLoop(const std::vector<std::shared_ptr<ISimulationBlock>>& algebraicLoop) const
+    {
+        std::unordered_map<const ISimulationBlock*, int> pendingInputsOfEachMember = {};
+        for (const auto& member : algebraicLoop)
+        {
+            pendingInputsOfEachMember.insert({member.get(), 0});
+        }
+        for (const auto& member : algebraicLoop)
+        {
+            for (int i = 0; i < member->GetInputPorts().size(); i++)
+            {
+                std::shared_ptr<ISimulationBlock> originBlock = this->GetOriginBlock(member, i);
+                if (originBlock && member->GetInputPorts()[i]->HasDirectFeedthrough() && pendingInputsOfEachMember.count(originBlock.get()))
+                {
+                    pendingInputsOfEachMember[member.get()] += 1;
+                }
+            }
+        }
+
+        // Members are ordered as their inputs get resolved; when every member left waits on another one, the member
+        // waiting on the fewest is taken and those inputs are cut, the loop solver iterates on the signals reaching them
+        std::vector<std::shared_ptr<ISimulationBlock>> orderedMembers = {};
+        std::unordered_set<const ISimulationBlock*> orderedMemberSet = {};
+        while (orderedMembers.size() < algebraicLoop.size())
+        {
+            std::shared_ptr<ISimulationBlock> nextMember = nullptr;
+            for (const auto& member : algebraicLoop)
+            {
+                if (!orderedMemberSet.count(member.get()) && (!nextMember || pendingInputsOfEachMember[member.get()] < pendingInputsOfEachMember[nextMember.get()]))
+                {
+                    nextMember = member;
+                }
+            }
+            orderedMembers.push_back(nextMember);
+            orderedMemberSet.insert(nextMember.get());
+
+            for (int i = 0; i < nextMember->GetOutputPorts().size(); i++)
+            {
+                const auto [connectedBlocks, connectedPortIndexes] = this->GetConnectedBlocks(nextMember, i);
+                for (int j = 0; j < connectedBlocks.size(); j++)
+                {
+                    if (pendingInputsOfEachMember.count(connectedBlocks[j].get()) && this->IsDirectFeedthroughLink(nextMember, connectedBlocks[j], connectedPortIndexes[j]))
+                    {
+                        pendingInputsOfEachMember[connectedBlocks[j].get()] -= 1;
+                    }
+                }
+            }
+        }
+        return orderedMembers;
+    }
+
+    const std::vector<std::shared_ptr<ISimulationBlock>> SimulationModel::GetBlocksInExecutionOrder()
+    {
+        std::vector<std::vector<std::shared_ptr<ISimulationBlock>>> algebraicLoops = this->GetAlgebraicLoops();
+        std::unordered_map<const ISimulationBlock*, int> algebraicLoopOfEachBlock = {};
+        for (int i = 0; i < algebraicLoops.size(); i++)
+        {
+            for (const auto& member : algebraicLoops[i])
+            {
+                algebraicLoopOfEachBlock.insert({member.get(), i});
+            }
+        }
+        if (!algebraicLoops.empty())
+        {
+            spdlog::get("default_pysyslink")->info("{} algebraic loops found, they are solved iteratively on each time hit", algebraicLoops.size());
+            for (int i = 0; i < algebraicLoops.size(); i++)
+            {
+                std::string loopDescription = "";
+                for (const auto& member : algebraicLoops[i])
+                {
+                    loopDescription += (loopDescription.empty() ? "" : ", ") + member->GetId();
+                }
+                spdlog::get("default_pysyslink")->debug("Algebraic loop {} through blocks {}", i, loopDescription);
+            }
+        }
+
+        // Blocks of an algebraic loop are ordered together as a single unit, keyed by its first block
+        auto getUnitKey = [&](const std::shared_ptr<ISimulationBlock>& block) -> const ISimulationBlock*
+        {
+            auto it = algebraicLoopOfEachBlock.find(block.get());
+            return it == algebraicLoopOfEachBlock.end() ? block.get() : algebraicLoops[it->second].front().get();
+        };
+        auto getUnitMembers = [&](const std::shared_ptr<ISimulationBlock>& block) -> std::vector<std::shared_ptr<ISimulationBlock>>
+        {
+            auto it = algebraicLoopOfEachBlock.find(block.get());
+            return it == algebraicLoopOfEachBlock.end() ? std::vector<std::shared_ptr<ISimulationBlock>>({block}) : this->OrderAlgebraicLoop(algebraicLoops[it->second]);
+        };
+
+        std::vector<std::shared_ptr<ISimulationBlock>> orderedBlocks = {};
+        // Direct feedthrough inputs of each reached unit still waiting for their origin block to be ordered
+        std::unordered_map<const ISimulationBlock*, int> pendingInputsOfEachUnit = {};
+        std::unordered_set<const ISimulationBlock*> readyUnits = {};
+
+        auto countPendingInputs = [&](const std::shared_ptr<ISimulationBlock>& block) -> int
+        {
+            const ISimulationBlock* unitKey = getUnitKey(block);
+            auto it = algebraicLoopOfEachBlock.find(block.get());
+            const std::vector<std::shared_ptr<ISimulationBlock>> members = it == algebraicLoopOfEachBlock.end() ? std::vector<std::shared_ptr<ISimulationBlock>>({block}) : algebraicLoops[it->second];
+
+            int pendingInputs = 0;
+            for (const auto& member : members)
+            {
+                std::vector<std::shared_ptr<InputPort>> inputPorts = member->GetInputPorts();
+                for (int i = 0; i < inputPorts.size(); i++)
+                {
+                    std::shared_ptr<ISimulationBlock> originBlock = this->GetOriginBlock(member, i);
+                    if (inputPorts[i]->HasDirectFeedthrough() && originBlock && getUnitKey(originBlock) != unitKey)
+                    {
+                        pendingInputs += 1;
+                    }
+                }
+            }
+            return pendingInputs;
+        };
+
+        // Ready units are taken depth first, so each chain is ordered as far as possible before the next one
+        std::vector<std::shared_ptr<ISimulationBlock>> readyStack = {};
+        std::vector<std::shared_ptr<ISimulationBlock>> freeSourceBlocks = this->GetFreeSourceBlocks();
+        for (auto it = freeSourceBlocks.rbegin(); it != freeSourceBlocks.rend(); ++it)
+        {
+            pendingInputsOfEachUnit[it->get()] = 0;
+            readyUnits.insert(it->get());
+            readyStack.push_back(*it);
+        }
+
+        while (!readyStack.empty())
+        {
+            std::shared_ptr<ISimulationBlock> unitBlock = readyStack.back();
+            readyStack.pop_back();
+            const ISimulationBlock* unitKey = getUnitKey(unitBlock);
+
+            std::vector<std::shared_ptr<ISimulationBlock>> newReadyBlocks = {};
+            for (const auto& block : getUnitMembers(unitBlock))
+            {
+                orderedBlocks.push_back(block);
+                for (int i = 0; i < block->GetOutputPorts().size(); i++)
+                {
+                    const auto [connectedBlocks, connectedPortIndexes] = this->GetConnectedBlocks(block, i);
+                    for (int j = 0; j < connectedBlocks.size(); j++)
+                    {
+                        const std::shared_ptr<ISimulationBlock>& connectedBlock = connectedBlocks[j];
+                        const ISimulationBlock* connectedUnitKey = getUnitKey(connectedBlock);
+                        if (connectedUnitKey == unitKey)
+                        {
+                            continue;
+                        }
+                        auto pendingInputs = pendingInputsOfEachUnit.find(connectedUnitKey);
+                        if (pendingInputs == pendingInputsOfEachUnit.end())
+                        {
+                            pendingInputs = pendingInputsOfEachUnit.insert({connectedUnitKey, countPendingInputs(connectedBlock)}).first;
+                        }
+                        if (this->IsDirectFeedthroughLink(block, connectedBlock, connectedPortIndexes[j]))
+                        {
+                            pendingInputs->second -= 1;
+                        }
+                        if (pendingInputs->second == 0 && readyUnits.insert(connectedUnitKey).second)
+                        {
+                            newReadyBlocks.push_back(connectedBlock);
+                        }
+                    }
+                }
+            }
+            readyStack.insert(readyStack.end(), newReadyBlocks.rbegin(), newReadyBlocks.rend());
+        }
+
+        int waitingUnits = 0;
+        for (const auto& [unitKey, pendingInputs] : pendingInputsOfEachUnit)
+        {
+            waitingUnits += pendingInputs > 0;
+        }
+        if (waitingUnits > 0)
+        {
+            spdlog::get("default_pysyslink")->warn("{} blocks or algebraic loops are not ordered, their direct feedthrough inputs come from blocks not reached from any free source block", waitingUnits);
+        }
+
+        spdlog::get("default_pysyslink")->debug("Final chain start:");
+        for (const auto& block: orderedBlocks)
+        {
+            spdlog::get("default_pysyslink")->debug(block->GetId());
+        }
+
+        return orderedBlocks;
+    }
+
     const std::vector<std::vector<std::shared_ptr<ISimulationBlock>>> SimulationModel::GetDirectBlockChains() 
     {
         std::vector<std::shared_ptr<ISimulationBlock>> freeSourceBlocks = this->GetFreeSourceBlocks();
@@ -206,15 +623,80 @@ namespace PySysLinkBase
 
     const std::shared_ptr<ISimulationBlock> SimulationModel::GetOriginBlock(const std::shared_ptr<ISimulationBlock> sinkBlock, int sinkBlockPortIndex) const 
     {
-        for (const auto& link : portLinks) {
-            if (link->sinkBlock == sinkBlock && link->sinkBlockPortIndex == sinkBlockPortIndex) {
-                return link->originBlock;
-            }
+        auto it = this->linkOfEachInputPort.find(sinkBlock.get());
+        if (it != this->linkOfEachInputPort.end() && sinkBlockPortIndex >= 0 && sinkBlockPortIndex < it->second.size() && it->second[sinkBlockPortIndex])
+        {
+            return it->second[sinkBlockPortIndex]->originBlock;
         }
         return nullptr; // No connection found
     }
 
-    void SimulationModel::PropagateSampleTimes() {
+    void SimulationModel::PropagateSampleTimes()
+    {
+        std::vector<int> blockIndexes(this->simulationBlocks.size());
+        std::iota(blockIndexes.begin(), blockIndexes.end(), 0);
+        this->PropagateSampleTimesOfBlocks(blockIndexes);
+    }
+
+    void SimulationModel::PropagateSampleTimes(const std::vector<std::shared_ptr<ISimulationBlock>>& editedBlocks)
+    {
+        std::unordered_map<const ISimulationBlock*, int> indexOfBlock = {};
+        for (int i = 0; i < this->simulationBlocks.size(); i++)
+        {
+            indexOfBlock.insert({this->simulationBlocks[i].get(), i});
+        }
+
+        // The region spreads from the edited blocks through the blocks that still hold an inherited sample time, or have
+        // not got one yet. Those are given back their inherited sample time; multirate blocks keep theirs and bound the region
+        std::vector<char> isInRegion(this->simulationBlocks.size(), 0);
+        std::vector<int> regionBlockIndexes = {};
+        auto tryAddToRegion = [&](const std::shared_ptr<ISimulationBlock>& block, bool isEdited) {
+            auto blockIndex = block ? indexOfBlock.find(block.get()) : indexOfBlock.end();
+            if (blockIndex == indexOfBlock.end() || isInRegion[blockIndex->second])
+            {
+                return;
+            }
+            auto inheritance = this->inheritanceOfEachBlock.find(block.get());
+            bool hasInheritedSampleTime = inheritance != this->inheritanceOfEachBlock.end() && inheritance->second.resolvedSampleTime == block->GetSampleTime();
+            if (!isEdited && !hasInheritedSampleTime && block->GetSampleTime()->GetSampleTimeType() != SampleTimeType::inherited)
+            {
+                return;
+            }
+            if (hasInheritedSampleTime)
+            {
+                block->SetSampleTime(inheritance->second.inheritedSampleTime);
+                this->inheritanceOfEachBlock.erase(inheritance);
+            }
+            isInRegion[blockIndex->second] = 1;
+            regionBlockIndexes.push_back(blockIndex->second);
+        };
+
+        for (const auto& editedBlock : editedBlocks)
+        {
+            tryAddToRegion(editedBlock, true);
+        }
+        for (int i = 0; i < regionBlockIndexes.size(); i++)
+        {
+            const std::shared_ptr<ISimulationBlock> block = this->simulationBlocks[regionBlockIndexes[i]];
+            for (int j = 0; j < block->GetInputPorts().size(); j++)
+            {
+                tryAddToRegion(this->GetOriginBlock(block, j), false);
+            }
+            for (int j = 0; j < block->GetOutputPorts().size(); j++)
+            {
+                for (const auto& connectedBlock : this->GetConnectedBlocks(block, j).first)
+                {
+                    tryAddToRegion(connectedBlock, false);
+                }
+            }
+        }
+
+        spdlog::get("default_pysyslink")->debug("Sample times propagated again over {} blocks around {} edited blocks", regionBlockIndexes.size(), editedBlocks.size());
+        std::sort(regionBlockIndexes.begin(), regionBlockIndexes.end());
+        this->PropagateSampleTimesOfBlocks(regionBlockIndexes);
+    }
+
+    void SimulationModel::PropagateSampleTimesOfBlocks(const std::vector<int>& blockIndexes) {
         // Helper lambdas
         auto hasKnownInputSampleTime = [](const std::shared_ptr<SampleTime> sampleTime) -> bool {
             if (sampleTime->GetSampleTimeType() != SampleTimeType::multirate)
@@ -354,178 +836,187 @@ namespace PySysLinkBase
             throw std::runtime_error("Incompatible sample times: Continuous and discrete types cannot mix.");
         };
 
-        bool performForwardPropagation = true;
-        while (performForwardPropagation) {
-            performForwardPropagation = false;
-            spdlog::get("default_pysyslink")->debug("Forward sample time propagation start");
-            // Forward propagation
-            bool progressMade = true;
-            while (progressMade) {
-                progressMade = false;
+        auto isInheritanceSupported = [](const std::shared_ptr<SampleTime>& inheritedSampleTime, const std::shared_ptr<SampleTime>& resolvedSampleTime) -> bool {
+            std::vector<SampleTimeType> supportedSampleTimeTypesForInheritance = inheritedSampleTime->GetSupportedSampleTimeTypesForInheritance();
+            return std::find(supportedSampleTimeTypesForInheritance.begin(), supportedSampleTimeTypesForInheritance.end(), resolvedSampleTime->GetSampleTimeType()) != supportedSampleTimeTypesForInheritance.end();
+        };
 
-                for (const auto& block : simulationBlocks) {
-                    bool allInputsResolved = true;
-                    std::vector<std::shared_ptr<SampleTime>> inputSampleTimes;
+        // Forward rule: a block gets the sample time of the origin blocks of its inputs, once they are all known
+        auto propagateFromInputs = [&](const std::shared_ptr<ISimulationBlock>& block) -> bool {
+            std::vector<std::shared_ptr<SampleTime>> inputSampleTimes;
 
-                    spdlog::get("default_pysyslink")->debug("Start working with block: {}", block->GetId());
+            spdlog::get("default_pysyslink")->debug("Start working with block: {}", block->GetId());
 
-                    for (int i = 0; i < block->GetInputPorts().size(); i++) 
-                    {
-                        const auto originBlock = GetOriginBlock(block, i);
-                        if (!originBlock) 
-                        {
-                            allInputsResolved = false;
-                            break;
-                        }
+            for (int i = 0; i < block->GetInputPorts().size(); i++) 
+            {
+                const auto originBlock = GetOriginBlock(block, i);
+                if (!originBlock || !hasKnownOutputSampleTime(originBlock->GetSampleTime())) 
+                {
+                    return false;
+                }
+                if (originBlock->GetSampleTime()->GetSampleTimeType() == SampleTimeType::multirate) {
+                    inputSampleTimes.push_back(originBlock->GetSampleTime()->GetMultirateSampleTimes()[originBlock->GetSampleTime()->GetOutputMultirateSampleTimeIndex()]);
+                } 
+                else {
+                    inputSampleTimes.push_back(originBlock->GetSampleTime());
+                }
+            }
+            if (inputSampleTimes.size() == 0)
+            {
+                return false;
+            }
 
-                        spdlog::get("default_pysyslink")->debug("Checking block: {}", originBlock->GetId());
+            spdlog::get("default_pysyslink")->debug("All inputs resolved for block: {}", block->GetId());
+            const std::shared_ptr<SampleTime> blockSampleTime = block->GetSampleTime();
 
-                        if (!hasKnownOutputSampleTime(originBlock->GetSampleTime())) 
-                        {
-                            allInputsResolved = false;
-                            break;
-                        }
-                        if (originBlock->GetSampleTime()->GetSampleTimeType() == SampleTimeType::multirate) {
-                            inputSampleTimes.push_back(originBlock->GetSampleTime()->GetMultirateSampleTimes()[originBlock->GetSampleTime()->GetOutputMultirateSampleTimeIndex()]);
-                        } 
-                        else {
-                            inputSampleTimes.push_back(originBlock->GetSampleTime());
-                        }
-                    }
+            std::shared_ptr<SampleTime> resolvedSampleTime = inputSampleTimes.front();
+            for (const auto& inputSampleTime : inputSampleTimes) {
+                resolvedSampleTime = resolveSampleTime(resolvedSampleTime, inputSampleTime);
+            }
 
-                    if (allInputsResolved and (inputSampleTimes.size() != 0)) {
-                        spdlog::get("default_pysyslink")->debug("All inputs resolved for block: {}", block->GetId());
-                        const std::shared_ptr<SampleTime> blockSampleTime = block->GetSampleTime();
+            if (blockSampleTime->GetSampleTimeType() == SampleTimeType::inherited) {
+                if (!isInheritanceSupported(blockSampleTime, resolvedSampleTime))
+                {
+                    throw std::runtime_error("Sample time propagation failed: Incompatible sample time types.");
+                }
+                spdlog::get("default_pysyslink")->debug("Block {} gets sample time {}", block->GetId(), SampleTime::SampleTimeTypeString(resolvedSampleTime->GetSampleTimeType()));
+                block->SetSampleTime(resolvedSampleTime);
+                this->inheritanceOfEachBlock[block.get()] = {blockSampleTime, resolvedSampleTime};
+                return true;
+            }
+            if (blockSampleTime->GetSampleTimeType() == SampleTimeType::multirate && blockSampleTime->GetInputMultirateSampleTimeIndex() != -1 && blockSampleTime->IsInputMultirateInherited())
+            {
+                spdlog::get("default_pysyslink")->debug("Input sample time not resolved for multirate block: {}", block->GetId());
+                if (!isInheritanceSupported(blockSampleTime->GetMultirateSampleTimes()[blockSampleTime->GetInputMultirateSampleTimeIndex()], resolvedSampleTime))
+                {
+                    throw std::runtime_error("Sample time propagation failed: Incompatible sample time types.");
+                }
+                spdlog::get("default_pysyslink")->debug("Block {} gets sample time at input {}", block->GetId(), SampleTime::SampleTimeTypeString(resolvedSampleTime->GetSampleTimeType()));
+                blockSampleTime->SetMultirateSampleTimeInIndex(resolvedSampleTime, blockSampleTime->GetInputMultirateSampleTimeIndex());
+                return true;
+            }
+            return false;
+        };
 
-                        std::shared_ptr<SampleTime> resolvedSampleTime = inputSampleTimes.front();
-                        for (const auto& inputSampleTime : inputSampleTimes) {
-                            resolvedSampleTime = resolveSampleTime(resolvedSampleTime, inputSampleTime);
-                        }
+        // Backward rule: a block gets the sample time of the blocks its outputs reach, those known so far
+        auto propagateFromOutputs = [&](const std::shared_ptr<ISimulationBlock>& block) -> bool {
+            std::vector<std::shared_ptr<SampleTime>> outputSampleTimes;
 
-                        if (blockSampleTime->GetSampleTimeType() == SampleTimeType::inherited) {
-                            spdlog::get("default_pysyslink")->debug("Inherited sample time");
-
-                            std::vector<SampleTimeType> supportedSampleTimeTypesForInheritance = block->GetSampleTime()->GetSupportedSampleTimeTypesForInheritance();
-                            if (std::find(supportedSampleTimeTypesForInheritance.begin(), supportedSampleTimeTypesForInheritance.end(), resolvedSampleTime->GetSampleTimeType()) != supportedSampleTimeTypesForInheritance.end())
-                            {
-                                spdlog::get("default_pysyslink")->debug("Block {} gets sample time {}", block->GetId(), SampleTime::SampleTimeTypeString(resolvedSampleTime->GetSampleTimeType()));
-                                block->SetSampleTime(resolvedSampleTime);
-                                progressMade = true;
-                            }
-                            else
-                            {
-                                throw std::runtime_error("Sample time propagation failed: Incompatible sample time types.");
-                            }
-                        }
-                        else if (blockSampleTime->GetSampleTimeType() == SampleTimeType::multirate)
-                        {
-                            spdlog::get("default_pysyslink")->debug("Multirate sample time");
-                            if (blockSampleTime->GetInputMultirateSampleTimeIndex() != -1)
-                            {
-                                if (blockSampleTime->IsInputMultirateInherited())
-                                {
-                                    spdlog::get("default_pysyslink")->debug("Input sample time not resolved for multirate block: {}", block->GetId());
-                                    std::vector<SampleTimeType> supportedSampleTimeTypesForInheritance = block->GetSampleTime()->GetMultirateSampleTimes()[block->GetSampleTime()->GetInputMultirateSampleTimeIndex()]->GetSupportedSampleTimeTypesForInheritance();
-                                    if (std::find(supportedSampleTimeTypesForInheritance.begin(), supportedSampleTimeTypesForInheritance.end(), resolvedSampleTime->GetSampleTimeType()) != supportedSampleTimeTypesForInheritance.end())
-                                    {
-                                        spdlog::get("default_pysyslink")->debug("Block {} gets sample time at input {}", block->GetId(), SampleTime::SampleTimeTypeString(resolvedSampleTime->GetSampleTimeType()));
-                                        block->GetSampleTime()->SetMultirateSampleTimeInIndex(resolvedSampleTime, blockSampleTime->GetInputMultirateSampleTimeIndex());
-                                        progressMade = true;
-                                    }
-                                    else
-                                    {
-                                        throw std::runtime_error("Sample time propagation failed: Incompatible sample time types.");
-                                    }
-                                }
-                            }
-                        }
+            spdlog::get("default_pysyslink")->debug("Start working with block: {}", block->GetId());
+            for (int i = 0; i < block->GetOutputPorts().size(); i++) {
+                const std::pair<std::vector<std::shared_ptr<ISimulationBlock>>, std::vector<int>> connectedBlocksInfoPair = this->GetConnectedBlocks(block, i);
+                const std::vector<std::shared_ptr<ISimulationBlock>> connectedBlocks = connectedBlocksInfoPair.first;
+                for (int j = 0; j < connectedBlocks.size(); j++) {
+                    if (!connectedBlocks[j] || !hasKnownInputSampleTime(connectedBlocks[j]->GetSampleTime())) {
+                        spdlog::get("default_pysyslink")->debug("Output not resolved for block: {}, connected block {} has unknown sample time", block->GetId(), connectedBlocks[j] ? connectedBlocks[j]->GetId() : "nullptr");
+                        break;
+                    }
+                    if (connectedBlocks[j]->GetSampleTime()->GetSampleTimeType() == SampleTimeType::multirate) {
+                        outputSampleTimes.push_back(connectedBlocks[j]->GetSampleTime()->GetMultirateSampleTimes()[connectedBlocks[j]->GetSampleTime()->GetInputMultirateSampleTimeIndex()]);
+                    }
+                    else
+                    {
+                        outputSampleTimes.push_back(connectedBlocks[j]->GetSampleTime());
                     }
                 }
             }
-            spdlog::get("default_pysyslink")->debug("Start backward propagation of sample time");
+            if (outputSampleTimes.size() == 0)
+            {
+                return false;
+            }
 
-            // Backward propagation
-            progressMade = true;
-            while (progressMade) {
-                progressMade = false;
-
-                for (const auto& block : simulationBlocks) {
-                    bool allOutputsResolved = true;
-                    std::vector<std::shared_ptr<SampleTime>> outputSampleTimes;
-
-                    spdlog::get("default_pysyslink")->debug("Start working with block: {}", block->GetId());
-                    for (int i = 0; i < block->GetOutputPorts().size(); i++) {
-                        const std::pair<std::vector<std::shared_ptr<ISimulationBlock>>, std::vector<int>> connectedBlocksInfoPair = this->GetConnectedBlocks(block, i);
-                        const std::vector<std::shared_ptr<ISimulationBlock>> connectedBlocks = connectedBlocksInfoPair.first;
-                        const std::vector<int> connectedPortIndexes = connectedBlocksInfoPair.second;
-                        for (int j = 0; j < connectedBlocks.size(); j++) {
-                            if (!connectedBlocks[j] || !hasKnownInputSampleTime(connectedBlocks[j]->GetSampleTime())) {
-                                allOutputsResolved = false;
-                                spdlog::get("default_pysyslink")->debug("Output not resolved for block: {}, connected block {} has unknown sample time", block->GetId(), connectedBlocks[j] ? connectedBlocks[j]->GetId() : "nullptr");
-                                break;
-                            }
-                            if (connectedBlocks[j]->GetSampleTime()->GetSampleTimeType() == SampleTimeType::multirate) {
-                                outputSampleTimes.push_back(connectedBlocks[j]->GetSampleTime()->GetMultirateSampleTimes()[connectedBlocks[j]->GetSampleTime()->GetInputMultirateSampleTimeIndex()]);
-                            }
-                            else
-                            {
-                                outputSampleTimes.push_back(connectedBlocks[j]->GetSampleTime());
-                            }
-                        }
-                    }
+            spdlog::get("default_pysyslink")->debug("Start propagating with block: {}", block->GetId());
+            const std::shared_ptr<SampleTime> blockSampleTime = block->GetSampleTime();
+            spdlog::get("default_pysyslink")->debug("Sample time type: {}", SampleTime::SampleTimeTypeString(blockSampleTime->GetSampleTimeType()));
 
-                    if (!allOutputsResolved) {
-                        spdlog::get("default_pysyslink")->debug("Not all outputs resolved for block: {}, new forward propagation scheduled", block->GetId());
-                        performForwardPropagation = true; // Schedule another forward propagation after this backward pass
-                    }
+            std::shared_ptr<SampleTime> resolvedSampleTime = outputSampleTimes.front();
+            for (const auto& outputSampleTime : outputSampleTimes) {
+                resolvedSampleTime = resolveSampleTime(resolvedSampleTime, outputSampleTime);
+            }
 
-                    if (outputSampleTimes.size() != 0) {
-                        spdlog::get("default_pysyslink")->debug("Start propagating with block: {}", block->GetId());
+            if (blockSampleTime->GetSampleTimeType() == SampleTimeType::inherited) {
+                if (!isInheritanceSupported(blockSampleTime, resolvedSampleTime))
+                {
+                    throw std::runtime_error("Sample time propagation failed: Incompatible sample time types.");
+                }
+                spdlog::get("default_pysyslink")->debug("Block {} gets sample time {}", block->GetId(), SampleTime::SampleTimeTypeString(resolvedSampleTime->GetSampleTimeType()));
+                block->SetSampleTime(resolvedSampleTime);
+                this->inheritanceOfEachBlock[block.get()] = {blockSampleTime, resolvedSampleTime};
+                return true;
+            }
+            if (blockSampleTime->GetSampleTimeType() == SampleTimeType::multirate && blockSampleTime->GetOutputMultirateSampleTimeIndex() != -1 && blockSampleTime->IsOutputMultirateInherited())
+            {
+                spdlog::get("default_pysyslink")->debug("Output sample time not resolved for multirate block: {}", block->GetId());
+                if (!isInheritanceSupported(blockSampleTime->GetMultirateSampleTimes()[blockSampleTime->GetOutputMultirateSampleTimeIndex()], resolvedSampleTime))
+                {
+                    throw std::runtime_error("Sample time propagation failed: Incompatible sample time types.");
+                }
+                spdlog::get("default_pysyslink")->debug("Block {} gets sample time at output {}", block->GetId(), SampleTime::SampleTimeTypeString(resolvedSampleTime->GetSampleTimeType()));
+                blockSampleTime->SetMultirateSampleTimeInIndex(resolvedSampleTime, blockSampleTime->GetOutputMultirateSampleTimeIndex());
+                return true;
+            }
+            return false;
+        };
 
-                        const std::shared_ptr<SampleTime> blockSampleTime = block->GetSampleTime();
-                        spdlog::get("default_pysyslink")->debug("Sample time type: {}", SampleTime::SampleTimeTypeString(blockSampleTime->GetSampleTimeType()));
+        std::unordered_map<const ISimulationBlock*, int> indexOfBlock = {};
+        for (int i = 0; i < this->simulationBlocks.size(); i++)
+        {
+            indexOfBlock.insert({this->simulationBlocks[i].get(), i});
+        }
+        std::vector<std::vector<int>> originsOfEachBlock(this->simulationBlocks.size());
+        std::vector<std::vector<int>> sinksOfEachBlock(this->simulationBlocks.size());
+        for (int i = 0; i < this->simulationBlocks.size(); i++)
+        {
+            for (int j = 0; j < this->simulationBlocks[i]->GetInputPorts().size(); j++)
+            {
+                const auto originBlock = this->GetOriginBlock(this->simulationBlocks[i], j);
+                auto originIndex = originBlock ? indexOfBlock.find(originBlock.get()) : indexOfBlock.end();
+                if (originIndex != indexOfBlock.end())
+                {
+                    originsOfEachBlock[i].push_back(originIndex->second);
+                    sinksOfEachBlock[originIndex->second].push_back(i);
+                }
+            }
+        }
 
-                        std::shared_ptr<SampleTime> resolvedSampleTime = outputSampleTimes.front();
-                        for (const auto& outputSampleTime : outputSampleTimes) {
-                            resolvedSampleTime = resolveSampleTime(resolvedSampleTime, outputSampleTime);
-                        }
+        // A block is examined again only when a neighbour it reads changed: its sinks in the forward direction, its origins in the backward one
+        SampleTimePropagationWorklist forwardWorklist(this->simulationBlocks.size());
+        SampleTimePropagationWorklist backwardWorklist(this->simulationBlocks.size());
+        for (int blockIndex : blockIndexes)
+        {
+            forwardWorklist.Push(blockIndex);
+            backwardWorklist.Push(blockIndex);
+        }
+        auto pushNeighboursOfChangedBlock = [&](int blockIndex) {
+            for (int sinkIndex : sinksOfEachBlock[blockIndex])
+            {
+                forwardWorklist.Push(sinkIndex);
+            }
+            for (int originIndex : originsOfEachBlock[blockIndex])
+            {
+                backwardWorklist.Push(originIndex);
+            }
+        };
 
-                        if (blockSampleTime->GetSampleTimeType() == SampleTimeType::inherited) {
-                            std::vector<SampleTimeType> supportedSampleTimeTypesForInheritance = block->GetSampleTime()->GetSupportedSampleTimeTypesForInheritance();
-                            if (std::find(supportedSampleTimeTypesForInheritance.begin(), supportedSampleTimeTypesForInheritance.end(), resolvedSampleTime->GetSampleTimeType()) != supportedSampleTimeTypesForInheritance.end())
-                            {
-                                spdlog::get("default_pysyslink")->debug("Block {} gets sample time {}", block->GetId(), SampleTime::SampleTimeTypeString(resolvedSampleTime->GetSampleTimeType()));
-                                block->SetSampleTime(resolvedSampleTime);
-                                progressMade = true;
-                            }
-                            else
-                            {
-                                throw std::runtime_error("Sample time propagation failed: Incompatible sample time types.");
-                            }
-                        }
-                        else if (blockSampleTime->GetSampleTimeType() == SampleTimeType::multirate)
-                        {
-                            spdlog::get("default_pysyslink")->debug("Multirate sample time");
-                            if (blockSampleTime->GetOutputMultirateSampleTimeIndex() != -1)
-                            {
-                                if (blockSampleTime->IsOutputMultirateInherited())
-                                {
-                                    spdlog::get("default_pysyslink")->debug("Output sample time not resolved for multirate block: {}", block->GetId());
-                                    std::vector<SampleTimeType> supportedSampleTimeTypesForInheritance = block->GetSampleTime()->GetMultirateSampleTimes()[block->GetSampleTime()->GetOutputMultirateSampleTimeIndex()]->GetSupportedSampleTimeTypesForInheritance();
-                                    if (std::find(supportedSampleTimeTypesForInheritance.begin(), supportedSampleTimeTypesForInheritance.end(), resolvedSampleTime->GetSampleTimeType()) != supportedSampleTimeTypesForInheritance.end())
-                                    {
-                                        spdlog::get("default_pysyslink")->debug("Block {} gets sample time at output {}", block->GetId(), SampleTime::SampleTimeTypeString(resolvedSampleTime->GetSampleTimeType()));
-                                        block->GetSampleTime()->SetMultirateSampleTimeInIndex(resolvedSampleTime, blockSampleTime->GetOutputMultirateSampleTimeIndex());
-                                        progressMade = true;
-                                    }
-                                    else
-                                    {
-                                        throw std::runtime_error("Sample time propagation failed: Incompatible sample time types.");
-                                    }
-                                }
-                            }
-                        }
-                    }
+        // A block only changes from inherited to resolved, so the passes alternate until neither direction has a block left to examine
+        while (!forwardWorklist.IsEmpty() || !backwardWorklist.IsEmpty())
+        {
+            int blockIndex;
+            spdlog::get("default_pysyslink")->debug("Forward sample time propagation start");
+            while (forwardWorklist.TryPop(blockIndex))
+            {
+                if (propagateFromInputs(this->simulationBlocks[blockIndex]))
+                {
+                    pushNeighboursOfChangedBlock(blockIndex);
+                }
+            }
+
+            spdlog::get("default_pysyslink")->debug("Start backward propagation of sample time");
+            while (backwardWorklist.TryPop(blockIndex))
+            {
+                if (propagateFromOutputs(this->simulationBlocks[blockIndex]))
+                {
+                    pushNeighboursOfChangedBlock(blockIndex);
                 }
             }
         }
@@ -549,7 +1040,8 @@ namespace PySysLinkBase
             return oss.str();
         };
 
-        for (const auto& block : simulationBlocks) {
+        for (int blockIndex : blockIndexes) {
+            const std::shared_ptr<ISimulationBlock>& block = this->simulationBlocks[blockIndex];
             if (!hasKnownSampleTime(block->GetSampleTime())) {
                 // Log detailed info before throwing
                 spdlog::get("default_pysyslink")->error("Sample time unresolved for block '{}' (id). Details: {}", block->GetId(), sampleTimeDetails(block->GetSampleTime()));
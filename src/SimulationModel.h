@@ -7,6 +7,7 @@
 #include "PortsAndSignalValues/InputPort.h"
 #include "PortsAndSignalValues/OutputPort.h"
 #include <optional>
+#include <unordered_map>
 #include "IBlockEventsHandler.h"
 
 namespace PySysLinkBase
@@ -24,15 +25,56 @@ namespace PySysLinkBase
         const std::pair<std::vector<std::shared_ptr<ISimulationBlock>>, std::vector<int>> GetConnectedBlocks(const std::shared_ptr<ISimulationBlock> originBlock, int outputPortIndex) const;
         const std::shared_ptr<ISimulationBlock> GetOriginBlock(const std::shared_ptr<ISimulationBlock> sinkBlock, int inputPortIndex) const;
 
+        // Appends a link and indexes it, throws std::out_of_range if either of its ports does not exist
+        void AddPortLink(std::shared_ptr<PortLink> portLink);
+        // Port links are indexed when the model is built and by AddPortLink; call after editing portLinks directly
+        void RebuildPortLinksIndex();
+
+        // Blocks reached from the free source blocks, each one after the origin blocks of its direct feedthrough inputs.
+        // The blocks of an algebraic loop are kept together, in the order given by OrderAlgebraicLoop
+        const std::vector<std::shared_ptr<ISimulationBlock>> GetBlocksInExecutionOrder();
+
+        // Strongly connected components of the direct feedthrough links, blocks in model order: groups of blocks whose
+        // outputs depend on each other within a time hit, and blocks fed through by their own output
+        const std::vector<std::vector<std::shared_ptr<ISimulationBlock>>> GetAlgebraicLoops() const;
+
         const std::vector<std::vector<std::shared_ptr<ISimulationBlock>>> GetDirectBlockChains();
 
         const std::vector<std::shared_ptr<ISimulationBlock>> OrderBlockChainsOntoFreeOrder(const std::vector<std::vector<std::shared_ptr<ISimulationBlock>>> directBlockChains);
         
         void PropagateSampleTimes();
+        // After a local edit, such as new links or a new sample time on the edited blocks: sample times inherited around
+        // them are inherited again, the rest of the model is left as it is
+        void PropagateSampleTimes(const std::vector<std::shared_ptr<ISimulationBlock>>& editedBlocks);
 
     private:
+        struct IndexedPortLink
+        {
+            std::shared_ptr<PortLink> portLink;
+            std::shared_ptr<InputPort> sinkPort;
+        };
+
+        std::unordered_map<const ISimulationBlock*, std::vector<std::vector<IndexedPortLink>>> linksOfEachOutputPort;
+        std::unordered_map<const ISimulationBlock*, std::vector<std::shared_ptr<PortLink>>> linkOfEachInputPort;
+
+        // Sample time each block had before it inherited one, and the one it inherited
+        struct SampleTimeInheritance
+        {
+            std::shared_ptr<SampleTime> inheritedSampleTime;
+            std::shared_ptr<SampleTime> resolvedSampleTime;
+        };
+        std::unordered_map<const ISimulationBlock*, SampleTimeInheritance> inheritanceOfEachBlock;
+
+        void PropagateSampleTimesOfBlocks(const std::vector<int>& blockIndexes);
+
+        void BuildPortLinksIndex();
+        void IndexPortLink(const std::shared_ptr<PortLink>& portLink);
+
         const std::vector<std::shared_ptr<ISimulationBlock>> GetFreeSourceBlocks();
 
+        bool IsDirectFeedthroughLink(const std::shared_ptr<ISimulationBlock>& originBlock, const std::shared_ptr<ISimulationBlock>& sinkBlock, int sinkBlockPortIndex) const;
+        std::vector<std::shared_ptr<ISimulationBlock>> OrderAlgebraicLoop(const std::vector<std::shared_ptr<ISimulationBlock>>& algebraicLoop) const;
+
         std::vector<std::vector<std::shared_ptr<ISimulationBlock>>> GetDirectBlockChainsOfSourceBlock(std::shared_ptr<ISimulationBlock> freeSourceBlock);
         
         void FindChains(std::shared_ptr<ISimulationBlock> currentBlock, std::vector<std::shared_ptr<ISimulationBlock>> currentChain, std::vector<std::vector<std::shared_ptr<ISimulationBlock>>>& resultChains);
@@ -9,6 +9,13 @@
 
 namespace PySysLinkBase
 {
+    // What the simulation thread does when the HDF5 writer falls behind
+    enum class WriteQueueFullPolicy
+    {
+        block,
+        drop
+    };
+
     class SimulationOptions
     {
         public:
@@ -26,8 +33,23 @@ namespace PySysLinkBase
 
         std::string hdf5FileName = "";
         bool saveToFileContinuously = false;
+        int hdf5ChunkSize = 1024; // Samples per write and per HDF5 chunk
+        int hdf5FlushInterval = 1; // Written chunks between file flushes, 0 to flush only when the output closes
+        int hdf5DeflateLevel = 0; // 0 disables compression
+        bool hdf5UseShuffleFilter = false;
+        int hdf5WriteQueueCapacity = 64; // Chunks that can wait for the writer thread
+        WriteQueueFullPolicy hdf5WriteQueueFullPolicy = WriteQueueFullPolicy::block;
 
         bool saveToVectors = true;
+
+        int numberOfThreads = 1; // Threads evaluating the blocks of each time hit, 1 evaluates them sequentially
+        bool runContinuousGroupsConcurrently = false; // Steps clusters of continuous groups with no links or blocks in common on their own workers between discrete time hits, numberOfThreads of them when above 1, else one per hardware thread
+
+        double algebraicLoopTolerance = 1e-10; // Largest mismatch of a cut signal, relative to the largest one plus one
+        int algebraicLoopMaximumIterations = 50;
+
+        bool activateProfiling = false; // Times the outputs of each block and the simulation phases, see SimulationManager::GetProfiler
+        int profilerMaximumTraceEvents = 1000000; // Spans kept for the Chrome trace, totals of the report keep counting after it
     };
 } // namespace PySysLinkBase
 
@@ -1,191 +1,274 @@
 #include "SimulationOutput.h"
-#include <highfive/H5Easy.hpp>
-#include <highfive/eigen.hpp>
 #include <highfive/H5File.hpp>
 #include <fstream>
 #include <variant>
 #include <complex>
+#include <chrono>
+#include "spdlog/spdlog.h"
 
 namespace PySysLinkBase
 {
-    SimulationOutput::SimulationOutput(bool saveToVectors, bool saveToFileContinuously, std::string hdf5FileName)
-        : saveToVectors(saveToVectors),
+    SimulationOutput::SimulationOutput(bool saveToVectors, bool saveToFileContinuously, std::string hdf5FileName,
+                                       int hdf5ChunkSize, int hdf5FlushInterval, int hdf5DeflateLevel, bool hdf5UseShuffleFilter,
+                                       int hdf5WriteQueueCapacity, WriteQueueFullPolicy hdf5WriteQueueFullPolicy)
+        : hdf5WriteQueueFullPolicy(hdf5WriteQueueFullPolicy),
+        saveToVectors(saveToVectors),
         saveToFileContinuously(saveToFileContinuously),
         hdf5FileName(std::move(hdf5FileName)),
-        hdf5File(nullptr),         
-        dumpOptions(nullptr)
+        hdf5File(nullptr),
+        hdf5ChunkSize(hdf5ChunkSize),
+        hdf5FlushInterval(hdf5FlushInterval),
+        hdf5DeflateLevel(hdf5DeflateLevel),
+        hdf5UseShuffleFilter(hdf5UseShuffleFilter)
     {
+        if (this->hdf5ChunkSize < 1)
+        {
+            throw std::invalid_argument("HDF5 chunk size must be at least 1, got " + std::to_string(this->hdf5ChunkSize));
+        }
+        if (hdf5WriteQueueCapacity < 1)
+        {
+            throw std::invalid_argument("HDF5 write queue capacity must be at least 1, got " + std::to_string(hdf5WriteQueueCapacity));
+        }
+        this->hdf5WriteQueueCapacity = hdf5WriteQueueCapacity;
+
         if (this->saveToFileContinuously)
         {
-            // Use actual types here
-            this->dumpOptions = new H5Easy::DumpOptions();
-            static_cast<H5Easy::DumpOptions*>(this->dumpOptions)->setChunkSize({1024});
-            this->hdf5File = std::make_shared<H5Easy::File>(this->hdf5FileName, H5Easy::File::Overwrite);
+            this->hdf5File = std::make_shared<HighFive::File>(this->hdf5FileName, HighFive::File::Overwrite);
             this->writeTasks.clear();
+            this->taskRing = std::make_unique<TaskRing<WriteTask>>(this->hdf5WriteQueueCapacity, WriteTask(this->hdf5ChunkSize));
 
             this->ioThread = std::thread([this]{
-                WriteTask task;
-                while (this->taskQueue.pop(task))
+                int tasksSinceFlush = 0;
+                int idleRounds = 0;
+                while (true)
                 {
-                    std::visit([&](auto&& arg) {
-                        using T = std::decay_t<decltype(arg)>;
-                        if constexpr (std::is_same_v<T, bool>)
-                        {
-                            for (const auto& value : task.values)
-                            {
-                                H5Easy::dump(*static_cast<H5Easy::File*>(this->hdf5File.get()),
-                                    task.datasetPath + "/values",
-                                    static_cast<int>(std::get<T>(*value)),
-                                    {lastFlushedIndex[task.datasetPath]},
-                                    *static_cast<H5Easy::DumpOptions*>(this->dumpOptions));
-                                lastFlushedIndex[task.datasetPath] += 1;
-                            }
-                        }
-                        else if constexpr (std::is_same_v<T, IntMatrix> || std::is_same_v<T, DoubleMatrix> || std::is_same_v<T, BoolMatrix> || std::is_same_v<T, ComplexMatrix>) {
-                            auto& file = *static_cast<H5Easy::File*>(this->hdf5File.get());
-
-                            const std::string path = task.datasetPath + "/values";
-
-                            for (const auto& value : task.values)
-                            {
-                                const auto& mat = std::get<T>(*value);
-
-                                //----------------------------------------------------------
-                                // First sample: create dataset
-                                //----------------------------------------------------------
-
-                                if (matrixDatasets.find(path) == matrixDatasets.end())
-                                {
-                                    matrixSizes[path] = {
-                                        static_cast<size_t>(mat.rows()),
-                                        static_cast<size_t>(mat.cols())
-                                    };
-
-                                    HighFive::DataSpace dataspace(
-                                        {
-                                            0,
-                                            static_cast<size_t>(mat.rows()),
-                                            static_cast<size_t>(mat.cols())
-                                        },
-                                        {
-                                            HighFive::DataSpace::UNLIMITED,
-                                            static_cast<size_t>(mat.rows()),
-                                            static_cast<size_t>(mat.cols())
-                                        }
-                                    );
-
-                                    HighFive::DataSetCreateProps props;
-
-                                    props.add(HighFive::Chunking({
-                                        1,
-                                        static_cast<size_t>(mat.rows()),
-                                        static_cast<size_t>(mat.cols())
-                                    }));
-
-                                    matrixDatasets[path] =
-                                        file.createDataSet<typename T::Scalar>(
-                                            path,
-                                            dataspace,
-                                            props);
-                                }
-
-                                //----------------------------------------------------------
-                                // Check dimensions
-                                //----------------------------------------------------------
-
-                                auto [rows, cols] = matrixSizes[path];
-
-                                if (rows != static_cast<size_t>(mat.rows()) ||
-                                    cols != static_cast<size_t>(mat.cols()))
-                                {
-                                    throw std::runtime_error(
-                                        "Matrix dimensions changed for signal '" + path + "'");
-                                }
-
-                                //----------------------------------------------------------
-                                // Append sample
-                                //----------------------------------------------------------
-
-                                auto& dataset = matrixDatasets[path];
-
-                                std::size_t sample = lastFlushedIndex[path];
-
-                                dataset.resize({
-                                    sample + 1,
-                                    rows,
-                                    cols
-                                });
-
-                                dataset.select(
-                                    {sample,0,0},
-                                    {1,rows,cols}
-                                ).write(mat);
-
-                                lastFlushedIndex[path]++;
-                            }
-                        }
-                        else
+                    // Read the flag first, every task pushed before the shutdown is then visible below
+                    const bool isShutDown = this->taskRing->IsShutDown();
+                    WriteTask* task = this->taskRing->Front();
+                    if (!task)
+                    {
+                        if (isShutDown)
                         {
-                            for (const auto& value : task.values)
-                            {
-                                H5Easy::dump(*static_cast<H5Easy::File*>(this->hdf5File.get()),
-                                    task.datasetPath + "/values",
-                                    std::get<T>(*value),
-                                    {lastFlushedIndex[task.datasetPath]},
-                                    *static_cast<H5Easy::DumpOptions*>(this->dumpOptions));
-                                lastFlushedIndex[task.datasetPath] += 1;
-                            }
+                            break;
                         }
-                    }, *task.values[0]);
+                        SimulationOutput::WaitForTaskRing(idleRounds);
+                        continue;
+                    }
+                    idleRounds = 0;
 
-                    lastFlushedIndex[task.datasetPath] -= task.times.size();
+                    this->WriteTaskToFile(*task);
+                    this->taskRing->Pop();
 
-                    for (const auto& time : task.times)
+                    tasksSinceFlush += 1;
+                    if (this->hdf5FlushInterval > 0 && tasksSinceFlush >= this->hdf5FlushInterval)
                     {
-                        H5Easy::dump(*static_cast<H5Easy::File*>(this->hdf5File.get()),
-                            task.datasetPath + "/times",
-                            time,
-                            {lastFlushedIndex[task.datasetPath]},
-                            *static_cast<H5Easy::DumpOptions*>(this->dumpOptions));
-                        lastFlushedIndex[task.datasetPath] += 1;
+                        static_cast<HighFive::File*>(this->hdf5File.get())->flush();
+                        tasksSinceFlush = 0;
                     }
                 }
-                static_cast<H5Easy::File*>(this->hdf5File.get())->flush();
+                static_cast<HighFive::File*>(this->hdf5File.get())->flush();
             });
         }
-        this->lastFlushedIndex.clear();
+        this->writtenSamples.clear();
     }
 
     SimulationOutput::~SimulationOutput() {
         if (saveToFileContinuously) {
             for (auto& [path, task] : writeTasks) {
                 if (task.currentIndex > 0) {
-                    WriteTask finalTask;
-                    finalTask.datasetPath = task.datasetPath;
-                    finalTask.times.assign(
-                        task.times.begin(),
-                        task.times.begin() + task.currentIndex
-                    );
-                    finalTask.values.assign(
-                        task.values.begin(),
-                        task.values.begin() + task.currentIndex
-                    );
-                    finalTask.currentIndex = finalTask.times.size();
-                    taskQueue.push(finalTask);
+                    // Pending samples are never dropped when the output closes
+                    this->EnqueueWriteTask(task, WriteQueueFullPolicy::block);
                 }
             }
-            taskQueue.shutdown();
+            taskRing->Shutdown();
             if (ioThread.joinable()) {
                 ioThread.join();
             }
         }
         signals.clear();
-        
-        // Fix 2: Properly delete dumpOptions
-        if (dumpOptions) {
-            delete static_cast<H5Easy::DumpOptions*>(dumpOptions);
-            dumpOptions = nullptr;
+    }
+
+    void SimulationOutput::WaitForTaskRing(int& idleRounds)
+    {
+        // Spin briefly, then back off to short sleeps so an idle thread does not keep a core busy
+        if (idleRounds < 64)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(idleRounds < 128 ? 50 : 500));
+        }
+        idleRounds += 1;
+    }
+
+    void SimulationOutput::EnqueueWriteTask(WriteTask& writeTask, WriteQueueFullPolicy policy)
+    {
+        int idleRounds = 0;
+        while (!this->taskRing->TryPush(writeTask))
+        {
+            if (policy == WriteQueueFullPolicy::drop)
+            {
+                if (this->droppedSamples.fetch_add(writeTask.currentIndex) == 0)
+                {
+                    spdlog::get("default_pysyslink")->warn("HDF5 write queue is full, samples of {} and later chunks are being dropped", writeTask.datasetPath);
+                }
+                writeTask.currentIndex = 0;
+                return;
+            }
+            SimulationOutput::WaitForTaskRing(idleRounds);
+        }
+    }
+
+    std::size_t SimulationOutput::GetDroppedSampleCount() const
+    {
+        return this->droppedSamples.load();
+    }
+
+    WriteTask& SimulationOutput::GetWriteTask(const std::string& signalType, const std::string& signalId)
+    {
+        const std::string datasetPath = signalType + "/" + signalId;
+        auto it = this->writeTasks.find(datasetPath);
+        if (it == this->writeTasks.end())
+        {
+            it = this->writeTasks.emplace(datasetPath, WriteTask(this->hdf5ChunkSize)).first;
+            it->second.datasetPath = datasetPath;
+        }
+        return it->second;
+    }
+
+    HighFive::DataSet& SimulationOutput::GetOrCreateDataset(const std::string& path, const std::vector<std::size_t>& sampleDimensions, bool isMatrix,
+                                                            std::function<HighFive::DataSet (const HighFive::DataSpace&, const HighFive::DataSetCreateProps&)> createDataset)
+    {
+        auto it = this->datasets.find(path);
+        if (it != this->datasets.end())
+        {
+            if (isMatrix && this->matrixSizes[path] != std::pair<size_t, size_t>(sampleDimensions[0], sampleDimensions[1]))
+            {
+                throw std::runtime_error("Matrix dimensions changed for signal '" + path + "'");
+            }
+            return it->second;
+        }
+
+        std::vector<std::size_t> dimensions = {0};
+        std::vector<std::size_t> maxDimensions = {HighFive::DataSpace::UNLIMITED};
+        std::size_t samplesPerChunk = this->hdf5ChunkSize;
+        std::size_t elementsPerSample = 1;
+        for (std::size_t sampleDimension : sampleDimensions)
+        {
+            dimensions.push_back(sampleDimension);
+            maxDimensions.push_back(sampleDimension);
+            elementsPerSample *= std::max<std::size_t>(sampleDimension, 1);
+        }
+        // Keep chunks of large matrices around the configured number of elements
+        samplesPerChunk = std::max<std::size_t>(1, samplesPerChunk / elementsPerSample);
+
+        std::vector<unsigned long long> chunkDimensions = {samplesPerChunk};
+        for (std::size_t sampleDimension : sampleDimensions)
+        {
+            chunkDimensions.push_back(std::max<std::size_t>(sampleDimension, 1));
+        }
+
+        HighFive::DataSetCreateProps props;
+        props.add(HighFive::Chunking(chunkDimensions));
+        if (this->hdf5UseShuffleFilter)
+        {
+            props.add(HighFive::Shuffle());
+        }
+        if (this->hdf5DeflateLevel > 0)
+        {
+            props.add(HighFive::Deflate(this->hdf5DeflateLevel));
+        }
+
+        if (isMatrix)
+        {
+            this->matrixSizes[path] = {sampleDimensions[0], sampleDimensions[1]};
+        }
+        return this->datasets.emplace(path, createDataset(HighFive::DataSpace(dimensions, maxDimensions), props)).first->second;
+    }
+
+    template<typename T>
+    void SimulationOutput::WriteValuesToFile(const std::string& path, const WriteTask& task, const std::vector<T>& values)
+    {
+        auto& file = *static_cast<HighFive::File*>(this->hdf5File.get());
+        const std::size_t samples = task.currentIndex;
+        const std::size_t offset = this->writtenSamples[path];
+
+        if constexpr (std::is_same_v<T, IntMatrix> || std::is_same_v<T, DoubleMatrix> || std::is_same_v<T, BoolMatrix> || std::is_same_v<T, ComplexMatrix>)
+        {
+            using Scalar = typename T::Scalar;
+            const T& firstMatrix = values[0];
+            const std::size_t rows = firstMatrix.rows();
+            const std::size_t cols = firstMatrix.cols();
+
+            HighFive::DataSet& dataset = this->GetOrCreateDataset(path, {rows, cols}, true,
+                [&](const HighFive::DataSpace& dataSpace, const HighFive::DataSetCreateProps& props) { return file.createDataSet<Scalar>(path, dataSpace, props); });
+
+            // Row-major block with every sample of the task, written in one hyperslab
+            std::unique_ptr<Scalar[]> buffer(new Scalar[samples * rows * cols]);
+            for (std::size_t k = 0; k < samples; k++)
+            {
+                const T& matrix = values[k];
+                if (matrix.rows() != rows || matrix.cols() != cols)
+                {
+                    throw std::runtime_error("Matrix dimensions changed for signal '" + path + "'");
+                }
+                for (std::size_t r = 0; r < rows; r++)
+                {
+                    for (std::size_t c = 0; c < cols; c++)
+                    {
+                        buffer[(k * rows + r) * cols + c] = matrix(r, c);
+                    }
+                }
+            }
+
+            dataset.resize({offset + samples, rows, cols});
+            dataset.select({offset, 0, 0}, {samples, rows, cols}).write_raw(buffer.get());
         }
+        else
+        {
+            // Booleans are stored as integers, as they were when dumped one by one
+            using StoredType = std::conditional_t<std::is_same_v<T, bool>, int, T>;
+
+            HighFive::DataSet& dataset = this->GetOrCreateDataset(path, {}, false,
+                [&](const HighFive::DataSpace& dataSpace, const HighFive::DataSetCreateProps& props) { return file.createDataSet<StoredType>(path, dataSpace, props); });
+
+            std::vector<StoredType> column(samples);
+            for (std::size_t k = 0; k < samples; k++)
+            {
+                column[k] = static_cast<StoredType>(values[k]);
+            }
+
+            dataset.resize({offset + samples});
+            dataset.select({offset}, {samples}).write(column);
+        }
+
+        this->writtenSamples[path] = offset + samples;
+    }
+
+    void SimulationOutput::WriteTaskToFile(const WriteTask& task)
+    {
+        if (task.currentIndex == 0)
+        {
+            return;
+        }
+
+        std::visit([&](const auto& values) {
+            using T = typename std::decay_t<decltype(values)>::value_type;
+            this->WriteValuesToFile<T>(task.datasetPath + "/values", task, values);
+        }, task.values);
+
+        auto& file = *static_cast<HighFive::File*>(this->hdf5File.get());
+        const std::string timesPath = task.datasetPath + "/times";
+        const std::size_t samples = task.currentIndex;
+        const std::size_t offset = this->writtenSamples[timesPath];
+
+        HighFive::DataSet& timesDataset = this->GetOrCreateDataset(timesPath, {}, false,
+            [&](const HighFive::DataSpace& dataSpace, const HighFive::DataSetCreateProps& props) { return file.createDataSet<double>(timesPath, dataSpace, props); });
+
+        timesDataset.resize({offset + samples});
+        timesDataset.select({offset}, {samples}).write(std::vector<double>(task.times.begin(), task.times.begin() + samples));
+        this->writtenSamples[timesPath] = offset + samples;
     }
 
     void SimulationOutput::InsertUnknownValue(
@@ -212,10 +295,101 @@ namespace PySysLinkBase
             value);
     }
 
+    template<typename T>
+    void SimulationOutput::AppendRegisteredSignalValue(SimulationOutput& output, RegisteredSignal& registeredSignal, const UnknownTypeSignalValue& value, double currentTime)
+    {
+        const T& payload = static_cast<const SignalValue<T>&>(value).GetPayloadReference();
+        if (registeredSignal.writeTask)
+        {
+            output.PushToWriteTask(*registeredSignal.writeTask, payload, currentTime);
+        }
+        if (registeredSignal.signal)
+        {
+            registeredSignal.signal->times.push_back(currentTime);
+            static_cast<Signal<T>&>(*registeredSignal.signal).values.push_back(payload);
+        }
+    }
+
+    template<typename T>
+    bool SimulationOutput::TryResolveRegisteredSignalType(SimulationOutput& output, RegisteredSignal& registeredSignal, SignalTypeId signalTypeId)
+    {
+        if (signalTypeId != GetSignalTypeId<T>())
+        {
+            return false;
+        }
+
+        registeredSignal.signalTypeId = signalTypeId;
+        registeredSignal.appendValue = &SimulationOutput::AppendRegisteredSignalValue<T>;
+
+        if (output.saveToVectors)
+        {
+            std::shared_ptr<UnknownTypeSignal>& signalPtr = output.signals[registeredSignal.signalType][registeredSignal.signalId];
+            if (!signalPtr)
+            {
+                signalPtr = std::make_shared<Signal<T>>();
+                signalPtr->id = registeredSignal.signalId;
+            }
+            else if (signalPtr->GetSignalTypeId() != signalTypeId)
+            {
+                throw std::invalid_argument("Signal " + registeredSignal.signalId + " of type " + signalPtr->GetTypeId() + " can not store values of type " + GetSignalTypeName<T>());
+            }
+            registeredSignal.signal = signalPtr;
+        }
+
+        if (output.saveToFileContinuously)
+        {
+            registeredSignal.writeTask = &output.GetWriteTask(registeredSignal.signalType, registeredSignal.signalId);
+        }
+        return true;
+    }
+
+    template<typename... Ts>
+    bool SimulationOutput::TryResolveRegisteredSignalAlternatives(SimulationOutput& output, RegisteredSignal& registeredSignal, SignalTypeId signalTypeId, std::variant<Ts...>*)
+    {
+        return (TryResolveRegisteredSignalType<Ts>(output, registeredSignal, signalTypeId) || ...);
+    }
+
+    int SimulationOutput::RegisterSignal(const std::string& signalType, const std::string& signalId)
+    {
+        RegisteredSignal registeredSignal;
+        registeredSignal.signalType = signalType;
+        registeredSignal.signalId = signalId;
+        this->registeredSignals.push_back(registeredSignal);
+        return this->registeredSignals.size() - 1;
+    }
+
+    void SimulationOutput::ResolveRegisteredSignal(RegisteredSignal& registeredSignal, const UnknownTypeSignalValue& value)
+    {
+        if (!TryResolveRegisteredSignalAlternatives(*this, registeredSignal, value.GetSignalTypeId(), static_cast<FullySupportedSignalValue*>(nullptr)))
+        {
+            throw std::runtime_error("UnknownTypeSignalValue cannot be converted to FullySupportedSignalValue");
+        }
+    }
+
+    void SimulationOutput::InsertUnknownValue(int signalHandle, const UnknownTypeSignalValue& value, double currentTime)
+    {
+        RegisteredSignal& registeredSignal = this->registeredSignals[signalHandle];
+        if (!registeredSignal.appendValue)
+        {
+            this->ResolveRegisteredSignal(registeredSignal, value);
+        }
+        else if (registeredSignal.signalTypeId != value.GetSignalTypeId())
+        {
+            throw std::invalid_argument("Signal " + registeredSignal.signalId + " can not store values of type " + value.GetTypeId() + " after values of another type");
+        }
+
+        registeredSignal.appendValue(*this, registeredSignal, value, currentTime);
+    }
+
     void SimulationOutput::WriteJson(const std::string& filename) const
     {
         std::ofstream out(filename);
+        this->WriteJson(out, "");
+        out << "\n";
+    }
 
+    void SimulationOutput::WriteJson(std::ostream& out, const std::string& indent) const
+    {
         out << "{";
 
         bool firstType = true;
@@ -227,7 +401,7 @@ namespace PySysLinkBase
 
             firstType = false;
 
-            out << "\n  \"" << escapeJson(signalType) << "\": {";
+            out << "\n" << indent << "  \"" << escapeJson(signalType) << "\": {";
 
             bool firstSignal = true;
 
@@ -238,13 +412,13 @@ namespace PySysLinkBase
 
                 firstSignal = false;
 
-                out << "\n    \"" << escapeJson(signalId) << "\": {";
+                out << "\n" << indent << "    \"" << escapeJson(signalId) << "\": {";
 
                 //------------------------------------------------------
                 // Times
                 //------------------------------------------------------
 
-                out << "\n      \"times\": [";
+                out << "\n" << indent << "      \"times\": [";
 
                 for (size_t i = 0; i < signal->times.size(); ++i)
                 {
@@ -260,16 +434,16 @@ namespace PySysLinkBase
                 // Values
                 //------------------------------------------------------
 
-                out << "\n      \"values\": ";
+                out << "\n" << indent << "      \"values\": ";
 
                 signal->WriteValuesJson(out);
 
-                out << "\n    }";
+                out << "\n" << indent << "    }";
             }
 
-            out << "\n  }";
+            out << "\n" << indent << "  }";
         }
 
-        out << "\n}\n";
+        out << "\n" << indent << "}";
     }
 }
\ No newline at end of file
@@ -6,47 +6,24 @@
 #include <map>
 #include <string>
 #include <unordered_map>
-#include <queue>
-#include <mutex>
+#include <atomic>
 #include <thread>
-#include <condition_variable>
 #include <iomanip>  
 #include <sstream>
 #include <fstream>
 #include <typeinfo>  
 #include <typeindex> 
+#include <functional>
 #include <highfive/H5DataSet.hpp>
 
 #include "PortsAndSignalValues/UnknownTypeSignalValue.h"
+#include "PortsAndSignalValues/SignalTypeId.h"
 #include "FullySupportedSignalValue.h"
+#include "SimulationOptions.h"
+#include "JsonUtilities.h"
 
 namespace PySysLinkBase
 {
-    static std::string escapeJson(const std::string& s) {
-        std::ostringstream o;
-        for (char c : s) {
-            switch (c) {
-                case '\"': o << "\\\""; break;
-                case '\\': o << "\\\\"; break;
-                case '\b': o << "\\b";  break;
-                case '\f': o << "\\f";  break;
-                case '\n': o << "\\n";  break;
-                case '\r': o << "\\r";  break;
-                case '\t': o << "\\t";  break;
-                default:
-                    if (static_cast<unsigned char>(c) < 0x20) {
-                        // control characters → \u00XX
-                        o << "\\u"
-                          << std::hex << std::setw(4) << std::setfill('0')
-                          << (int)(unsigned char)c;
-                    } else {
-                        o << c;
-                    }
-            }
-        }
-        return o.str();
-    }
-
     template<typename T>
     inline void WriteJsonValue(std::ostream& out, const T& value)
     {
@@ -150,6 +127,7 @@ namespace PySysLinkBase
         }
 
         virtual const std::string GetTypeId() const = 0;
+        virtual SignalTypeId GetSignalTypeId() const = 0;
         virtual void WriteValuesJson(std::ostream& out) const = 0;
 
         template <typename T>
@@ -181,11 +159,12 @@ namespace PySysLinkBase
             values.reserve(4096); // Pre-allocate memory
         }
 
-        // Cache type ID to avoid repeated allocations
         const std::string GetTypeId() const override {
-            const std::string typeId = 
-                std::to_string(typeid(T).hash_code()) + typeid(T).name();
-            return typeId;
+            return PySysLinkBase::GetSignalTypeName<T>();
+        }
+
+        SignalTypeId GetSignalTypeId() const override {
+            return PySysLinkBase::GetSignalTypeId<T>();
         }
 
         void WriteValuesJson(std::ostream& out) const override
@@ -208,44 +187,76 @@ namespace PySysLinkBase
         }
     };
 
+    template<typename Variant>
+    struct VariantOfColumns;
+
+    template<typename... Ts>
+    struct VariantOfColumns<std::variant<Ts...>>
+    {
+        using type = std::variant<std::vector<Ts>...>;
+        template<typename T>
+        static constexpr bool holds = (std::is_same_v<T, Ts> || ...);
+    };
+
+    // One typed vector per column, so values are stored without any per-sample allocation
+    using FullySupportedSignalValueColumn = VariantOfColumns<FullySupportedSignalValue>::type;
+
     struct WriteTask {
         std::string datasetPath;
-        int currentIndex = 0;
+        int currentIndex = 0; // Number of samples filled, written as a single block
         std::vector<double> times;
-        std::vector<std::shared_ptr<FullySupportedSignalValue>> values;
+        FullySupportedSignalValueColumn values;
+
+        WriteTask(std::size_t chunkSize=1024) : times(chunkSize, 0.0) {}
 
-        WriteTask() : times(1024, 0.0), values(1024, nullptr) {}
+        // Hands the filled buffers over and keeps the previous ones of this task to be refilled
+        void TakeBuffersFrom(WriteTask& other)
+        {
+            this->datasetPath = other.datasetPath;
+            std::swap(this->times, other.times);
+            std::swap(this->values, other.values);
+            this->currentIndex = other.currentIndex;
+            other.currentIndex = 0;
+        }
     };
 
+    // Bounded single producer, single consumer ring. Slots are allocated once and their buffers are recycled.
     template<typename Task>
-    class TaskQueue {
-    std::queue<Task> queue_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
-    bool done_ = false;
+    class TaskRing {
+    std::vector<Task> slots;
+    alignas(64) std::atomic<std::size_t> head{0}; // Next slot to read, only advanced by the consumer
+    alignas(64) std::atomic<std::size_t> tail{0}; // Next slot to fill, only advanced by the producer
+    std::atomic<bool> done{false};
     public:
-    void push(Task const& t) {
+    TaskRing(std::size_t capacity, const Task& prototype) : slots(capacity, prototype)
+    {
+        if (capacity == 0)
         {
-        std::lock_guard<std::mutex> lk(mutex_);
-        queue_.push(t);
+            throw std::invalid_argument("Task ring capacity must be at least 1");
         }
-        cv_.notify_one();
     }
-    // Consumer pop; returns false if shutting down and queue empty
-    bool pop(Task& out) {
-        std::unique_lock<std::mutex> lk(mutex_);
-        cv_.wait(lk, [&]{ return done_ || !queue_.empty(); });
-        if (queue_.empty()) return false;
-        out = std::move(queue_.front());
-        queue_.pop();
+    // Producer side; returns false if every slot is still waiting to be consumed
+    bool TryPush(Task& task) {
+        const std::size_t currentTail = this->tail.load(std::memory_order_relaxed);
+        if (currentTail - this->head.load(std::memory_order_acquire) == this->slots.size()) return false;
+        this->slots[currentTail % this->slots.size()].TakeBuffersFrom(task);
+        this->tail.store(currentTail + 1, std::memory_order_release);
         return true;
     }
-    void shutdown() {
-        {
-        std::lock_guard<std::mutex> lk(mutex_);
-        done_ = true;
-        }
-        cv_.notify_all();
+    // Consumer side; returns nullptr if the ring is empty
+    Task* Front() {
+        const std::size_t currentHead = this->head.load(std::memory_order_relaxed);
+        if (currentHead == this->tail.load(std::memory_order_acquire)) return nullptr;
+        return &this->slots[currentHead % this->slots.size()];
+    }
+    void Pop() {
+        this->head.store(this->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    void Shutdown() {
+        this->done.store(true, std::memory_order_release);
+    }
+    bool IsShutDown() const {
+        return this->done.load(std::memory_order_acquire);
     }
     };
 
@@ -253,22 +264,64 @@ namespace PySysLinkBase
     {
     private:
         std::thread ioThread;
-        TaskQueue<WriteTask> taskQueue;
+        std::unique_ptr<TaskRing<WriteTask>> taskRing;
+        std::size_t hdf5WriteQueueCapacity;
+        WriteQueueFullPolicy hdf5WriteQueueFullPolicy;
+        std::atomic<std::size_t> droppedSamples{0};
         bool saveToVectors;
         bool saveToFileContinuously;
         std::string hdf5FileName;
         std::shared_ptr<void> hdf5File; // opaque pointer, actual type in .cpp
-        void* dumpOptions; // opaque pointer, actual type in .cpp
+        int hdf5ChunkSize;
+        int hdf5FlushInterval;
+        int hdf5DeflateLevel;
+        bool hdf5UseShuffleFilter;
 
-        std::unordered_map<std::string, std::size_t> lastFlushedIndex;
+        std::unordered_map<std::string, std::size_t> writtenSamples;
         std::unordered_map<std::string, WriteTask> writeTasks;
 
-        std::unordered_map<std::string, HighFive::DataSet> matrixDatasets;
+        std::unordered_map<std::string, HighFive::DataSet> datasets;
         std::unordered_map<std::string, std::pair<size_t,size_t>> matrixSizes;
+
+        void EnqueueWriteTask(WriteTask& writeTask, WriteQueueFullPolicy policy);
+        static void WaitForTaskRing(int& idleRounds);
+        WriteTask& GetWriteTask(const std::string& signalType, const std::string& signalId);
+        template<typename T>
+        void PushToWriteTask(WriteTask& writeTask, const T& value, double currentTime);
+
+        void WriteTaskToFile(const WriteTask& task);
+        template<typename T>
+        void WriteValuesToFile(const std::string& path, const WriteTask& task, const std::vector<T>& values);
+        HighFive::DataSet& GetOrCreateDataset(const std::string& path, const std::vector<std::size_t>& sampleDimensions, bool isMatrix, std::function<HighFive::DataSet (const HighFive::DataSpace&, const HighFive::DataSetCreateProps&)> createDataset);
+
+        struct RegisteredSignal
+        {
+            std::string signalType;
+            std::string signalId;
+            // Resolved with the type of the first value appended
+            SignalTypeId signalTypeId = 0;
+            void (*appendValue)(SimulationOutput& output, RegisteredSignal& registeredSignal, const UnknownTypeSignalValue& value, double currentTime) = nullptr;
+            std::shared_ptr<UnknownTypeSignal> signal;
+            WriteTask* writeTask = nullptr;
+        };
+        std::vector<RegisteredSignal> registeredSignals;
+
+        void ResolveRegisteredSignal(RegisteredSignal& registeredSignal, const UnknownTypeSignalValue& value);
+        template<typename T>
+        static void AppendRegisteredSignalValue(SimulationOutput& output, RegisteredSignal& registeredSignal, const UnknownTypeSignalValue& value, double currentTime);
+        template<typename T>
+        static bool TryResolveRegisteredSignalType(SimulationOutput& output, RegisteredSignal& registeredSignal, SignalTypeId signalTypeId);
+        template<typename... Ts>
+        static bool TryResolveRegisteredSignalAlternatives(SimulationOutput& output, RegisteredSignal& registeredSignal, SignalTypeId signalTypeId, std::variant<Ts...>*);
     public:
-        SimulationOutput(bool saveToVectors=true, bool saveToFileContinuously=false, std::string hdf5FileName="");
+        SimulationOutput(bool saveToVectors=true, bool saveToFileContinuously=false, std::string hdf5FileName="",
+                         int hdf5ChunkSize=1024, int hdf5FlushInterval=1, int hdf5DeflateLevel=0, bool hdf5UseShuffleFilter=false,
+                         int hdf5WriteQueueCapacity=64, WriteQueueFullPolicy hdf5WriteQueueFullPolicy=WriteQueueFullPolicy::block);
         ~SimulationOutput();
 
+        // Samples discarded because the write queue was full under the drop policy
+        std::size_t GetDroppedSampleCount() const;
+
         std::map<std::string, std::map<std::string, std::shared_ptr<UnknownTypeSignal>>> signals;
 
         template<typename T>
@@ -286,12 +339,59 @@ namespace PySysLinkBase
             const FullySupportedSignalValue& value,
             double currentTime);
 
+        // Registering a signal up front returns a handle that appends straight into its typed column
+        int RegisterSignal(const std::string& signalType, const std::string& signalId);
+        void InsertUnknownValue(int signalHandle, const UnknownTypeSignalValue& value, double currentTime);
+
         void WriteJson(const std::string& filename) const;
+        // Writes the signals as one JSON object, every line after the first prefixed with indent
+        void WriteJson(std::ostream& out, const std::string& indent) const;
     }; 
     
+    template<typename T>
+    void SimulationOutput::PushToWriteTask(WriteTask& writeTask, const T& value, double currentTime)
+    {
+        if constexpr (VariantOfColumns<FullySupportedSignalValue>::holds<T>)
+        {
+            std::vector<T>* column = std::get_if<std::vector<T>>(&writeTask.values);
+            if (!column || column->size() != writeTask.times.size())
+            {
+                if (writeTask.currentIndex != 0)
+                {
+                    throw std::invalid_argument("Signal " + writeTask.datasetPath + " can not store values of type " + PySysLinkBase::GetSignalTypeName<T>() + " after values of another type");
+                }
+                // Recycled buffers keep their column unless it was filled by a signal of another type
+                column = &writeTask.values.emplace<std::vector<T>>(writeTask.times.size());
+            }
+
+            writeTask.times[writeTask.currentIndex] = currentTime;
+            (*column)[writeTask.currentIndex] = value;
+            writeTask.currentIndex += 1;
+
+            if (writeTask.currentIndex == writeTask.times.size())
+            {
+                this->EnqueueWriteTask(writeTask, this->hdf5WriteQueueFullPolicy);
+            }
+        }
+        else
+        {
+            throw std::invalid_argument("Values of type " + PySysLinkBase::GetSignalTypeName<T>() + " can not be saved to file");
+        }
+    }
+
     template<typename T>
     void SimulationOutput::InsertValueTyped(const std::string& signalType, const std::string& signalId, T value, double currentTime)
     {
+        if (this->saveToFileContinuously)
+        {
+            this->PushToWriteTask(this->GetWriteTask(signalType, signalId), value, currentTime);
+        }
+
+        if (!this->saveToVectors)
+        {
+            return;
+        }
+
         auto& signalMap = signals[signalType];
         auto& signalPtr = signalMap[signalId];
         
@@ -300,6 +400,10 @@ namespace PySysLinkBase
             signalPtr = std::make_shared<Signal<T>>();
             signalPtr->id = signalId;
         }
+        else if (signalPtr->GetSignalTypeId() != PySysLinkBase::GetSignalTypeId<T>())
+        {
+            throw std::invalid_argument("Signal " + signalId + " of type " + signalPtr->GetTypeId() + " can not store values of type " + PySysLinkBase::GetSignalTypeName<T>());
+        }
         
         // Add the value
         signalPtr->times.push_back(currentTime);
@@ -0,0 +1,212 @@
+#include "SimulationProfiler.h"
+#include "JsonUtilities.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace PySysLinkBase
+{
+    namespace
+    {
+        std::atomic<std::uint64_t> lastProfilerId{0};
+    } // namespace
+
+    SimulationProfiler::SimulationProfiler(std::size_t maximumTraceEventCount)
+        : profilerId(++lastProfilerId), maximumTraceEventCount(maximumTraceEventCount)
+    {
+        this->creationTime = Clock::now();
+    }
+
+    std::string SimulationProfiler::PhaseName(ProfiledPhase phase)
+    {
+        switch (phase)
+        {
+            case ProfiledPhase::linkPropagation:
+                return "LinkPropagation";
+            case ProfiledPhase::odeRightHandSide:
+                return "OdeRightHandSide";
+            case ProfiledPhase::loggingAndOutput:
+                return "LoggingAndOutput";
+        }
+        throw std::invalid_argument("Unknown profiled phase");
+    }
+
+    SimulationProfiler::ThreadBuffer& SimulationProfiler::GetThreadBuffer()
+    {
+        // The buffer of the last profiler used by this thread is found without taking the lock
+        thread_local std::uint64_t cachedProfilerId = 0;
+        thread_local ThreadBuffer* cachedThreadBuffer = nullptr;
+        if (cachedProfilerId == this->profilerId)
+        {
+            return *cachedThreadBuffer;
+        }
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        std::unique_ptr<ThreadBuffer>& threadBuffer = this->threadBuffers[std::this_thread::get_id()];
+        if (!threadBuffer)
+        {
+            threadBuffer = std::make_unique<ThreadBuffer>();
+            threadBuffer->threadIndex = static_cast<int>(this->threadBuffers.size()) - 1;
+        }
+        cachedProfilerId = this->profilerId;
+        cachedThreadBuffer = threadBuffer.get();
+        return *threadBuffer;
+    }
+
+    void SimulationProfiler::RecordBlockOutputs(const ISimulationBlock& block, Clock::time_point start, Clock::time_point end)
+    {
+        ThreadBuffer& threadBuffer = this->GetThreadBuffer();
+        auto it = threadBuffer.indexOfEachBlock.find(&block);
+        if (it == threadBuffer.indexOfEachBlock.end())
+        {
+            it = threadBuffer.indexOfEachBlock.insert({&block, static_cast<int>(threadBuffer.blockProfiles.size())}).first;
+            threadBuffer.blockProfiles.push_back({block.GetId()});
+        }
+        BlockProfile& blockProfile = threadBuffer.blockProfiles[it->second];
+        blockProfile.callCount += 1;
+        blockProfile.totalSeconds += std::chrono::duration<double>(end - start).count();
+        this->AddTraceEvent(threadBuffer, it->second, true, start, end);
+    }
+
+    void SimulationProfiler::RecordPhase(ProfiledPhase phase, Clock::time_point start, Clock::time_point end)
+    {
+        ThreadBuffer& threadBuffer = this->GetThreadBuffer();
+        PhaseProfile& phaseProfile = threadBuffer.phaseProfiles[phase];
+        phaseProfile.callCount += 1;
+        phaseProfile.totalSeconds += std::chrono::duration<double>(end - start).count();
+        this->AddTraceEvent(threadBuffer, static_cast<int>(phase), false, start, end);
+    }
+
+    void SimulationProfiler::CountRejectedStep()
+    {
+        this->GetThreadBuffer().rejectedStepCount += 1;
+    }
+
+    void SimulationProfiler::CountEventBisectionIterations(int iterationCount)
+    {
+        this->GetThreadBuffer().eventBisectionIterationCount += iterationCount;
+    }
+
+    void SimulationProfiler::AddTraceEvent(ThreadBuffer& threadBuffer, int nameIndex, bool isBlock, Clock::time_point start, Clock::time_point end)
+    {
+        if (this->traceEventCount.fetch_add(1, std::memory_order_relaxed) >= this->maximumTraceEventCount)
+        {
+            this->droppedTraceEventCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        threadBuffer.traceEvents.push_back({nameIndex, isBlock, start, end});
+    }
+
+    std::vector<const SimulationProfiler::ThreadBuffer*> SimulationProfiler::GetThreadBuffersInCreationOrder() const
+    {
+        std::vector<const ThreadBuffer*> threadBuffers(this->threadBuffers.size());
+        for (const auto& [threadId, threadBuffer] : this->threadBuffers)
+        {
+            threadBuffers[threadBuffer->threadIndex] = threadBuffer.get();
+        }
+        return threadBuffers;
+    }
+
+    SimulationProfileReport SimulationProfiler::GetReport() const
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        SimulationProfileReport report;
+        std::unordered_map<const ISimulationBlock*, int> indexOfEachBlock;
+        std::map<ProfiledPhase, PhaseProfile> phaseProfiles;
+        for (const ThreadBuffer* threadBuffer : this->GetThreadBuffersInCreationOrder())
+        {
+            // A block run by several threads has a profile in each of their buffers
+            std::vector<const ISimulationBlock*> blocks(threadBuffer->blockProfiles.size());
+            for (const auto& [block, index] : threadBuffer->indexOfEachBlock)
+            {
+                blocks[index] = block;
+            }
+            for (int i = 0; i < blocks.size(); i++)
+            {
+                auto it = indexOfEachBlock.find(blocks[i]);
+                if (it == indexOfEachBlock.end())
+                {
+                    it = indexOfEachBlock.insert({blocks[i], static_cast<int>(report.blocks.size())}).first;
+                    report.blocks.push_back({threadBuffer->blockProfiles[i].blockId});
+                }
+                report.blocks[it->second].callCount += threadBuffer->blockProfiles[i].callCount;
+                report.blocks[it->second].totalSeconds += threadBuffer->blockProfiles[i].totalSeconds;
+            }
+            for (const auto& [phase, phaseProfile] : threadBuffer->phaseProfiles)
+            {
+                phaseProfiles[phase].callCount += phaseProfile.callCount;
+                phaseProfiles[phase].totalSeconds += phaseProfile.totalSeconds;
+            }
+            report.rejectedStepCount += threadBuffer->rejectedStepCount;
+            report.eventBisectionIterationCount += threadBuffer->eventBisectionIterationCount;
+        }
+        std::stable_sort(report.blocks.begin(), report.blocks.end(), [](const BlockProfile& a, const BlockProfile& b) {
+            return a.totalSeconds > b.totalSeconds;
+        });
+        for (const auto& [phase, phaseProfile] : phaseProfiles)
+        {
+            report.phases.insert({SimulationProfiler::PhaseName(phase), phaseProfile});
+        }
+        report.droppedTraceEventCount = this->droppedTraceEventCount.load();
+        return report;
+    }
+
+    void SimulationProfiler::WriteChromeTrace(std::ostream& out) const
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto microsecondsSinceCreation = [this](Clock::time_point time) -> double {
+            return std::chrono::duration<double, std::micro>(time - this->creationTime).count();
+        };
+        std::vector<const ThreadBuffer*> threadBuffers = this->GetThreadBuffersInCreationOrder();
+
+        // Microseconds with a fixed nanosecond resolution, the default precision would round long runs
+        std::ios_base::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << std::fixed << std::setprecision(3);
+
+        out << "{\"traceEvents\": [";
+        bool isFirstEvent = true;
+        std::uint64_t rejectedStepCount = 0;
+        std::uint64_t eventBisectionIterationCount = 0;
+        for (const ThreadBuffer* threadBuffer : threadBuffers)
+        {
+            out << (isFirstEvent ? "\n" : ",\n");
+            isFirstEvent = false;
+            out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << threadBuffer->threadIndex
+                << ", \"args\": {\"name\": \"thread " << threadBuffer->threadIndex << "\"}}";
+            rejectedStepCount += threadBuffer->rejectedStepCount;
+            eventBisectionIterationCount += threadBuffer->eventBisectionIterationCount;
+        }
+        for (const ThreadBuffer* threadBuffer : threadBuffers)
+        {
+            for (const auto& traceEvent : threadBuffer->traceEvents)
+            {
+                out << (isFirstEvent ? "\n" : ",\n");
+                isFirstEvent = false;
+                std::string name = traceEvent.isBlock ? threadBuffer->blockProfiles[traceEvent.nameIndex].blockId : SimulationProfiler::PhaseName(static_cast<ProfiledPhase>(traceEvent.nameIndex));
+                out << "{\"name\": \"" << escapeJson(name) << "\", \"cat\": \"" << (traceEvent.isBlock ? "block" : "phase")
+                    << "\", \"ph\": \"X\", \"ts\": " << microsecondsSinceCreation(traceEvent.start)
+                    << ", \"dur\": " << microsecondsSinceCreation(traceEvent.end) - microsecondsSinceCreation(traceEvent.start)
+                    << ", \"pid\": 1, \"tid\": " << threadBuffer->threadIndex << "}";
+            }
+        }
+        out << "\n], \"displayTimeUnit\": \"ms\", \"otherData\": {\"rejectedSteps\": " << rejectedStepCount
+            << ", \"eventBisectionIterations\": " << eventBisectionIterationCount
+            << ", \"droppedTraceEvents\": " << this->droppedTraceEventCount.load() << "}}";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    void SimulationProfiler::WriteChromeTrace(const std::string& filename) const
+    {
+        std::ofstream out(filename);
+        if (!out)
+        {
+            throw std::runtime_error("Could not open profiler trace file: " + filename);
+        }
+        this->WriteChromeTrace(out);
+        out << "\n";
+    }
+} // namespace PySysLinkBase
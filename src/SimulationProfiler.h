@@ -0,0 +1,156 @@
+#ifndef SRC_SIMULATION_PROFILER
+#define SRC_SIMULATION_PROFILER
+
+#include "ISimulationBlock.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace PySysLinkBase
+{
+    enum class ProfiledPhase
+    {
+        linkPropagation,
+        odeRightHandSide,
+        loggingAndOutput
+    };
+
+    struct BlockProfile
+    {
+        std::string blockId;
+        std::uint64_t callCount = 0;
+        double totalSeconds = 0.0;
+    };
+
+    struct PhaseProfile
+    {
+        std::uint64_t callCount = 0;
+        double totalSeconds = 0.0;
+    };
+
+    struct SimulationProfileReport
+    {
+        std::vector<BlockProfile> blocks; // Largest total time first
+        std::map<std::string, PhaseProfile> phases; // Phases are timed around the blocks they run, so their times overlap block times
+        std::uint64_t rejectedStepCount = 0;
+        std::uint64_t eventBisectionIterationCount = 0;
+        std::uint64_t droppedTraceEventCount = 0;
+    };
+
+    // Wall time of the outputs of each block and of the simulation phases, with the spans of each call kept for a Chrome trace.
+    // Only created when profiling is activated; code being profiled holds a null pointer otherwise and skips reading the clock.
+    // Each recording thread fills a buffer of its own, the buffers are merged when the report or the trace is written,
+    // which has to happen once the threads being profiled stopped recording.
+    class SimulationProfiler
+    {
+        public:
+        using Clock = std::chrono::steady_clock;
+
+        // Totals keep counting once maximumTraceEventCount spans are recorded, later spans are left out of the trace
+        SimulationProfiler(std::size_t maximumTraceEventCount);
+
+        void RecordBlockOutputs(const ISimulationBlock& block, Clock::time_point start, Clock::time_point end);
+        void RecordPhase(ProfiledPhase phase, Clock::time_point start, Clock::time_point end);
+        void CountRejectedStep();
+        void CountEventBisectionIterations(int iterationCount);
+
+        SimulationProfileReport GetReport() const;
+        // Trace Event Format, loaded by chrome://tracing and Perfetto
+        void WriteChromeTrace(std::ostream& out) const;
+        void WriteChromeTrace(const std::string& filename) const;
+
+        static std::string PhaseName(ProfiledPhase phase);
+
+        private:
+        struct TraceEvent
+        {
+            int nameIndex; // Into the block profiles of the buffer for blocks, the phase otherwise
+            bool isBlock;
+            Clock::time_point start;
+            Clock::time_point end;
+        };
+
+        // Only written by the thread it belongs to
+        struct ThreadBuffer
+        {
+            int threadIndex;
+            std::unordered_map<const ISimulationBlock*, int> indexOfEachBlock;
+            std::vector<BlockProfile> blockProfiles;
+            std::map<ProfiledPhase, PhaseProfile> phaseProfiles;
+            std::uint64_t rejectedStepCount = 0;
+            std::uint64_t eventBisectionIterationCount = 0;
+            std::vector<TraceEvent> traceEvents;
+        };
+
+        std::uint64_t profilerId; // Tells the buffers cached by each thread apart from those of other profilers
+        Clock::time_point creationTime;
+        std::size_t maximumTraceEventCount;
+
+        mutable std::mutex mutex; // Guards the list of buffers, taken once per thread
+        std::unordered_map<std::thread::id, std::unique_ptr<ThreadBuffer>> threadBuffers;
+
+        std::atomic<std::size_t> traceEventCount{0};
+        std::atomic<std::uint64_t> droppedTraceEventCount{0};
+
+        ThreadBuffer& GetThreadBuffer();
+        void AddTraceEvent(ThreadBuffer& threadBuffer, int nameIndex, bool isBlock, Clock::time_point start, Clock::time_point end);
+        std::vector<const ThreadBuffer*> GetThreadBuffersInCreationOrder() const;
+    };
+
+    // Times the scope it lives in; does nothing when the profiler is null
+    class ProfiledScope
+    {
+        public:
+        ProfiledScope(SimulationProfiler* profiler, const ISimulationBlock& block) : profiler(profiler), block(&block)
+        {
+            if (this->profiler)
+            {
+                this->start = SimulationProfiler::Clock::now();
+            }
+        }
+
+        ProfiledScope(SimulationProfiler* profiler, ProfiledPhase phase) : profiler(profiler), phase(phase)
+        {
+            if (this->profiler)
+            {
+                this->start = SimulationProfiler::Clock::now();
+            }
+        }
+
+        ~ProfiledScope()
+        {
+            if (!this->profiler)
+            {
+                return;
+            }
+            if (this->block)
+            {
+                this->profiler->RecordBlockOutputs(*this->block, this->start, SimulationProfiler::Clock::now());
+            }
+            else
+            {
+                this->profiler->RecordPhase(this->phase, this->start, SimulationProfiler::Clock::now());
+            }
+        }
+
+        ProfiledScope(const ProfiledScope&) = delete;
+        ProfiledScope& operator=(const ProfiledScope&) = delete;
+
+        private:
+        SimulationProfiler* profiler;
+        const ISimulationBlock* block = nullptr;
+        ProfiledPhase phase = ProfiledPhase::linkPropagation;
+        SimulationProfiler::Clock::time_point start;
+    };
+} // namespace PySysLinkBase
+
+#endif /* SRC_SIMULATION_PROFILER */
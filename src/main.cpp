@@ -17,6 +17,7 @@
 #include "BlockEventsHandler.h"
 #include "SimulationOptions.h"
 #include "SimulationOutput.h"
+#include "SimulationBatchRunner.h"
 
 struct SimulationOptionsYaml {
     double startTime;
@@ -35,7 +36,19 @@ struct SimulationOptionsYaml {
 
     std::string hdf5FileName = "";
     bool saveToFileContinuously = false;
+    int hdf5ChunkSize = 1024;
+    int hdf5FlushInterval = 1;
+    int hdf5DeflateLevel = 0;
+    bool hdf5UseShuffleFilter = false;
+    int hdf5WriteQueueCapacity = 64;
+    std::string hdf5WriteQueueFullPolicy = "Block";
     bool saveToVectors = true;
+    int numberOfThreads = 1;
+    bool runContinuousGroupsConcurrently = false;
+    double algebraicLoopTolerance = 1e-10;
+    int algebraicLoopMaximumIterations = 50;
+    bool activateProfiling = false;
+    std::string profilerTraceFile = "";
 
     bool saveToJson = false;
     std::string outputJsonFile;
@@ -115,9 +128,48 @@ struct convert<SimulationOptionsYaml> {
         rhs.saveToFileContinuously =
             get_optional<bool>(node, "SaveToFileContinuously", false);
 
+        rhs.hdf5ChunkSize =
+            get_optional<int>(node, "HDF5ChunkSize", 1024);
+
+        rhs.hdf5FlushInterval =
+            get_optional<int>(node, "HDF5FlushInterval", 1);
+
+        rhs.hdf5DeflateLevel =
+            get_optional<int>(node, "HDF5DeflateLevel", 0);
+
+        rhs.hdf5UseShuffleFilter =
+            get_optional<bool>(node, "HDF5UseShuffleFilter", false);
+
+        rhs.hdf5WriteQueueCapacity =
+            get_optional<int>(node, "HDF5WriteQueueCapacity", 64);
+
+        rhs.hdf5WriteQueueFullPolicy =
+            get_optional<std::string>(node, "HDF5WriteQueueFullPolicy", "Block");
+        if (rhs.hdf5WriteQueueFullPolicy != "Block" && rhs.hdf5WriteQueueFullPolicy != "Drop") {
+            throw YamlError("HDF5WriteQueueFullPolicy must be Block or Drop, got " + rhs.hdf5WriteQueueFullPolicy);
+        }
+
         rhs.saveToVectors =
             get_optional<bool>(node, "SaveToVectors", true);
 
+        rhs.numberOfThreads =
+            get_optional<int>(node, "NumberOfThreads", 1);
+
+        rhs.runContinuousGroupsConcurrently =
+            get_optional<bool>(node, "RunContinuousGroupsConcurrently", false);
+
+        rhs.algebraicLoopTolerance =
+            get_optional<double>(node, "AlgebraicLoopTolerance", 1e-10);
+
+        rhs.algebraicLoopMaximumIterations =
+            get_optional<int>(node, "AlgebraicLoopMaximumIterations", 50);
+
+        rhs.activateProfiling =
+            get_optional<bool>(node, "ActivateProfiling", false);
+
+        rhs.profilerTraceFile =
+            get_optional<std::string>(node, "ProfilerTraceFile", "");
+
         rhs.saveToJson =
             get_optional<bool>(node, "SaveToJson", false);
 
@@ -214,6 +266,56 @@ struct convert<SimulationOptionsYaml> {
 
 }
 
+// Batch file: a sequence of runs under Runs, each with a Name and the typed configuration keys to override under each block id
+//   Runs:
+//     - Name: gain_2
+//       Overrides:
+//         gain1:
+//           Gain[double]: 2.0
+std::vector<PySysLinkBase::SimulationBatchRun> parse_batch_runs(const YAML::Node& node) {
+    const std::string path = "batch";
+    const auto runsNode = get_required<YAML::Node>(node, "Runs", path);
+    if (!runsNode.IsSequence()) {
+        throw YamlError(path + ".Runs must be a sequence" + loc(runsNode));
+    }
+
+    std::vector<PySysLinkBase::SimulationBatchRun> runs;
+    for (std::size_t i = 0; i < runsNode.size(); ++i) {
+        const auto& runNode = runsNode[i];
+        const std::string runPath = path + ".Runs[" + std::to_string(i) + "]";
+
+        PySysLinkBase::SimulationBatchRun run;
+        run.runName = get_optional<std::string>(runNode, "Name", "run_" + std::to_string(i));
+
+        if (runNode["Overrides"]) {
+            for (const auto& blockNode : runNode["Overrides"]) {
+                const std::string blockId = blockNode.first.as<std::string>();
+                for (const auto& it : blockNode.second) {
+                    const std::string rawKey = it.first.as<std::string>();
+                    try {
+                        auto parsedKey =
+                            PySysLinkBase::ModelParser::ParseConfigurationKey(rawKey);
+
+                        run.blockConfigurationOverrides[blockId][parsedKey.keyName] =
+                            PySysLinkBase::ModelParser::YamlToConfigurationValue(
+                                it.second,
+                                parsedKey.typeName
+                            );
+                    } catch (const std::exception& e) {
+                        throw YamlError(
+                            "Invalid value in " + runPath + ".Overrides." +
+                            blockId + "." + rawKey + loc(it.second) +
+                            "\n  Reason: " + e.what()
+                        );
+                    }
+                }
+            }
+        }
+        runs.push_back(run);
+    }
+    return runs;
+}
+
 int main(int argc, char* argv[]) {
     argparse::ArgumentParser program("PySysLinkBase");
 
@@ -223,6 +325,14 @@ int main(int argc, char* argv[]) {
     program.add_argument("options_yaml")
         .help("Path to the options file (YAML), containing the plugin paths, simulation options and output options");
     
+    program.add_argument("--batch")
+        .help("Path to a batch file (YAML) listing runs of the model with configuration overrides");
+
+    program.add_argument("--batch-threads")
+        .help("Runs of the batch simulated at the same time, each on a single thread when above 1")
+        .default_value(1)
+        .scan<'i', int>();
+
     program.add_argument("--verbose")
         .help("increase output verbosity")
         .default_value(false)
@@ -286,19 +396,6 @@ int main(int argc, char* argv[]) {
         blockFactories.insert(factories.begin(), factories.end());
     }
 
-    // 4) Parse the simulation model
-    auto model = PySysLinkBase::ModelParser::ParseFromYaml(
-        program.get<std::string>("model_yaml"),
-        blockFactories,
-        blockEventsHandler
-    );
-    
-    std::vector<std::vector<std::shared_ptr<PySysLinkBase::ISimulationBlock>>> blockChains = model->GetDirectBlockChains();
-    std::vector<std::shared_ptr<PySysLinkBase::ISimulationBlock>> orderedBlocks = model->OrderBlockChainsOntoFreeOrder(blockChains);
-    model->PropagateSampleTimes();
-
-    
-    
     auto simOpts = std::make_shared<PySysLinkBase::SimulationOptions>();
 
     simOpts->startTime = cfg.startTime;
@@ -311,9 +408,64 @@ int main(int argc, char* argv[]) {
 
     simOpts->hdf5FileName = cfg.hdf5FileName;
     simOpts->saveToFileContinuously = cfg.saveToFileContinuously;
+    simOpts->hdf5ChunkSize = cfg.hdf5ChunkSize;
+    simOpts->hdf5FlushInterval = cfg.hdf5FlushInterval;
+    simOpts->hdf5DeflateLevel = cfg.hdf5DeflateLevel;
+    simOpts->hdf5UseShuffleFilter = cfg.hdf5UseShuffleFilter;
+    simOpts->hdf5WriteQueueCapacity = cfg.hdf5WriteQueueCapacity;
+    simOpts->hdf5WriteQueueFullPolicy = cfg.hdf5WriteQueueFullPolicy == "Drop"
+        ? PySysLinkBase::WriteQueueFullPolicy::drop
+        : PySysLinkBase::WriteQueueFullPolicy::block;
     simOpts->saveToVectors = cfg.saveToVectors;
+    simOpts->numberOfThreads = cfg.numberOfThreads;
+    simOpts->runContinuousGroupsConcurrently = cfg.runContinuousGroupsConcurrently;
+    simOpts->algebraicLoopTolerance = cfg.algebraicLoopTolerance;
+    simOpts->algebraicLoopMaximumIterations = cfg.algebraicLoopMaximumIterations;
+    simOpts->activateProfiling = cfg.activateProfiling;
+
+    if (program.is_used("--batch")) {
+        std::vector<PySysLinkBase::SimulationBatchRun> runs;
+        try {
+            runs = parse_batch_runs(YAML::LoadFile(program.get<std::string>("--batch")));
+        }
+        catch (const YAML::BadFile& e) {
+            std::cerr << "Could not read file: " << program.get<std::string>("--batch") << "\n";
+            return 1;
+        }
+        catch (const YamlError& e) {
+            std::cerr << "Batch YAML error:\n" << e.what() << std::endl;
+            return 1;
+        }
+
+        if (!cfg.saveToJson || cfg.outputJsonFile.empty()) {
+            std::cerr << "Batch outputs are written as JSON, set SaveToJson and OutputJsonFile in the options file\n";
+            return 1;
+        }
+
+        PySysLinkBase::SimulationBatchRunner batchRunner(
+            PySysLinkBase::ModelParser::ParseConfigurationFromYaml(program.get<std::string>("model_yaml")),
+            blockFactories,
+            simOpts,
+            program.get<int>("--batch-threads")
+        );
+        batchRunner.RunBatchToJson(cfg.outputJsonFile, runs);
+        std::cout << "Batch of " << runs.size() << " runs complete, output written to "
+                << cfg.outputJsonFile << "\n";
+
+        return 0;
+    }
+
+    // 4) Parse the simulation model
+    auto model = PySysLinkBase::ModelParser::ParseFromYaml(
+        program.get<std::string>("model_yaml"),
+        blockFactories,
+        blockEventsHandler
+    );
     
+    model->PropagateSampleTimes();
 
+    
+    
     PySysLinkBase::SimulationManager mgr(model, simOpts);
     auto output = mgr.RunSimulation();
 
@@ -323,5 +475,26 @@ int main(int argc, char* argv[]) {
                 << cfg.outputJsonFile << "\n";
     }
 
+    if (auto profiler = mgr.GetProfiler()) {
+        PySysLinkBase::SimulationProfileReport report = profiler->GetReport();
+        std::cout << "Slowest blocks:\n";
+        for (std::size_t i = 0; i < report.blocks.size() && i < 10; ++i) {
+            std::cout << "  " << report.blocks[i].blockId << ": "
+                    << report.blocks[i].totalSeconds << " s in "
+                    << report.blocks[i].callCount << " calls\n";
+        }
+        for (const auto& [phaseName, phase] : report.phases) {
+            std::cout << phaseName << ": " << phase.totalSeconds << " s in "
+                    << phase.callCount << " calls\n";
+        }
+        std::cout << "Rejected steps: " << report.rejectedStepCount
+                << ", event bisection iterations: " << report.eventBisectionIterationCount << "\n";
+
+        if (!cfg.profilerTraceFile.empty()) {
+            profiler->WriteChromeTrace(cfg.profilerTraceFile);
+            std::cout << "Profiler trace written to " << cfg.profilerTraceFile << "\n";
+        }
+    }
+
     return 0;
 }